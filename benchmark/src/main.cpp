@@ -0,0 +1,136 @@
+// SPDX-FileCopyrightText: 2022 Daniel Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <mpbp/mpbp.hpp>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+  constexpr int run_count = 5;
+
+  std::vector<mpbp::Rect> makeRandomRects(std::size_t rect_count, int min_size, int max_size)
+  {
+    std::mt19937 random(1337);
+    std::uniform_int_distribution<int> size(min_size, max_size);
+    std::vector<mpbp::Rect> rects;
+    rects.reserve(rect_count);
+    for (std::size_t rect_i = 0; rect_i < rect_count; rect_i++)
+    {
+      rects.emplace_back(rect_i, size(random), size(random));
+    }
+    return rects;
+  }
+
+  std::vector<mpbp::Box> makeRandomBoxes(std::size_t box_count, int min_size, int max_size)
+  {
+    std::mt19937 random(1337);
+    std::uniform_int_distribution<int> size(min_size, max_size);
+    std::vector<mpbp::Box> boxes;
+    boxes.reserve(box_count);
+    for (std::size_t box_i = 0; box_i < box_count; box_i++)
+    {
+      boxes.emplace_back(box_i, size(random), size(random), size(random));
+    }
+    return boxes;
+  }
+
+  // Run a benchmark several times and print the fastest run, so that the result is not skewed by
+  // a slow first run or by other processes.
+  void runBenchmark(const std::string& name, std::size_t rect_count,
+                    const std::function<void()>& prepare, const std::function<void()>& run)
+  {
+    auto best = std::chrono::duration<double, std::milli>::max();
+    for (int run_i = 0; run_i < run_count; run_i++)
+    {
+      prepare();
+      const auto start = std::chrono::steady_clock::now();
+      run();
+      const auto duration = std::chrono::steady_clock::now() - start;
+      best = std::min(best, std::chrono::duration<double, std::milli>(duration));
+    }
+    std::cout << std::left << std::setw(24) << name << std::right << std::fixed
+              << std::setprecision(2) << std::setw(10) << best.count() << " ms" << std::setw(14)
+              << std::setprecision(0) << rect_count / (best.count() / 1000.0) << " rects/s"
+              << std::endl;
+  }
+}  // namespace
+
+int main()
+{
+  const auto random_source = makeRandomRects(50000, 1, 64);
+  std::vector<mpbp::Rect> rects;
+  runBenchmark(
+      "random rects", random_source.size(), [&]() { rects = random_source; },
+      [&]()
+      {
+        mpbp::Packer packer(1024, 1024);
+        packer.Pack(rects);
+      });
+
+  const auto tile_source = std::vector<mpbp::Rect>(100000, mpbp::Rect(0, 16, 16));
+  runBenchmark(
+      "uniform tiles", tile_source.size(), [&]() { rects = tile_source; },
+      [&]()
+      {
+        mpbp::Packer packer(1024, 1024);
+        packer.Pack(rects);
+      });
+
+  const auto online_source = makeRandomRects(20000, 1, 32);
+  runBenchmark(
+      "online packs", online_source.size(), [&]() { rects = online_source; },
+      [&]()
+      {
+        mpbp::Packer packer(1024, 1024);
+        packer.SetPruneMode(mpbp::PruneMode::SetAside);
+        for (std::size_t first_i = 0; first_i < rects.size(); first_i += 100)
+        {
+          packer.Pack(std::span<mpbp::Rect>(rects).subspan(first_i, 100));
+        }
+      });
+
+  const auto job_source = makeRandomRects(100000, 1, 48);
+  std::vector<mpbp::PackJob> jobs;
+  mpbp::ThreadPool thread_pool;
+  runBenchmark(
+      "many jobs", job_source.size(),
+      [&]()
+      {
+        rects = job_source;
+        jobs.clear();
+        for (std::size_t first_i = 0; first_i < rects.size(); first_i += 50)
+        {
+          jobs.emplace_back(std::span<mpbp::Rect>(rects).subspan(first_i, 50), 256, 256);
+        }
+      },
+      [&]() { mpbp::PackMany(jobs, thread_pool); });
+
+  const auto random_box_source = makeRandomBoxes(50000, 1, 16);
+  std::vector<mpbp::Box> boxes;
+  runBenchmark(
+      "random boxes", random_box_source.size(), [&]() { boxes = random_box_source; },
+      [&]()
+      {
+        mpbp::BoxPacker packer(128, 128, 128);
+        packer.Pack(boxes);
+      });
+
+  const auto brick_source = std::vector<mpbp::Box>(100000, mpbp::Box(0, 8, 8, 8));
+  runBenchmark(
+      "uniform bricks", brick_source.size(), [&]() { boxes = brick_source; },
+      [&]()
+      {
+        mpbp::BoxPacker packer(128, 128, 128);
+        packer.Pack(boxes);
+      });
+  return 0;
+}
@@ -0,0 +1,76 @@
+// SPDX-FileCopyrightText: 2022 Daniel Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+#include <csignal>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <mpbp/PackServer.hpp>
+#include <string>
+
+namespace
+{
+  mpbp::PackServer* running_server = nullptr;
+
+  void stopServer(int) { running_server->Stop(); }
+
+  void printUsage()
+  {
+    std::cerr << "usage: mpbpd <socket path> [--threads <count>] [--cache <directory> <max MiB>]"
+              << std::endl;
+  }
+}  // namespace
+
+int main(int argument_count, char** arguments)
+{
+  if (argument_count < 2)
+  {
+    printUsage();
+    return 1;
+  }
+  std::size_t thread_count = 0;
+  std::string cache_directory;
+  std::uintmax_t cache_max_size = 0;
+  try
+  {
+    for (int argument_i = 2; argument_i < argument_count; argument_i++)
+    {
+      const std::string argument = arguments[argument_i];
+      if (argument == "--threads" && argument_i + 1 < argument_count)
+      {
+        thread_count = std::stoul(arguments[++argument_i]);
+      }
+      else if (argument == "--cache" && argument_i + 2 < argument_count)
+      {
+        cache_directory = arguments[++argument_i];
+        cache_max_size = std::stoull(arguments[++argument_i]) * 1024 * 1024;
+      }
+      else
+      {
+        printUsage();
+        return 1;
+      }
+    }
+    mpbp::PackServer server(arguments[1], thread_count);
+    if (!cache_directory.empty()) server.SetCache(cache_directory, cache_max_size);
+    running_server = &server;
+    std::signal(SIGINT, stopServer);
+    std::signal(SIGTERM, stopServer);
+    std::cout << "mpbpd listening on " << server.GetSocketPath().string() << std::endl;
+    server.Run();
+    std::signal(SIGINT, SIG_DFL);
+    std::signal(SIGTERM, SIG_DFL);
+    running_server = nullptr;
+    std::cout << "mpbpd packed " << server.GetRequestCount() << " requests in "
+              << server.GetBatchCount() << " batches, " << server.GetCacheHitCount()
+              << " from the cache" << std::endl;
+  }
+  catch (const std::exception& exception)
+  {
+    std::cerr << "mpbpd: " << exception.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
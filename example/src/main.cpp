@@ -4,6 +4,7 @@
 
 #include <iostream>
 #include <mpbp/mpbp.hpp>
+#include <vector>
 
 int main()
 {
@@ -15,28 +16,31 @@ int main()
   mpbp::Packer packer(32, 16);
   packer.Pack(input_rects);
 
-  for (int page = 0; page < packer.GetPageCount(); page++)
+  // Give each Rect an image filled with the digit of its identifier, so that the composed pages can
+  // be printed directly.
+  std::vector<std::vector<unsigned char>> pixels(input_rects.size());
+  std::vector<mpbp::Image> images(input_rects.size());
+  for (const auto& rect : input_rects)
+  {
+    auto& rect_pixels = pixels[rect.GetIdentifier()];
+    rect_pixels.assign(rect.GetWidth() * rect.GetHeight(),
+                       static_cast<unsigned char>('0' + rect.GetIdentifier()));
+    images[rect.GetIdentifier()] = mpbp::Image(rect_pixels.data(), rect.GetWidth(), rect.GetHeight(),
+                                               rect.GetWidth(), mpbp::PixelFormat::R8);
+  }
+  mpbp::Compositor compositor(mpbp::PixelFormat::R8);
+  compositor.Compose(packer, input_rects, images);
+
+  for (int page = 0; page < compositor.GetPageCount(); page++)
   {
     std::cout << "page " << page << std::endl;
-    for (int y = 0; y < 16; y++)
+    const auto page_image = compositor.GetPage(page);
+    for (int y = 0; y < page_image.GetHeight(); y++)
     {
-      for (int x = 0; x < 32; x++)
+      const auto row = page_image.GetRow(y);
+      for (int x = 0; x < page_image.GetWidth(); x++)
       {
-        bool rect_found = false;
-        for (const auto& rect : input_rects)
-        {
-          if (rect.GetPage() == page && rect.GetLeftX() <= x && rect.GetTopY() <= y && rect.GetRightX() >= x &&
-              rect.GetBottomY() >= y)
-          {
-            std::cout << rect.GetIdentifier();
-            rect_found = true;
-            break;
-          }
-        }
-        if (!rect_found)
-        {
-          std::cout << ".";
-        }
+        std::cout << (row[x] == 0 ? '.' : static_cast<char>(row[x]));
       }
       std::cout << std::endl;
     }
@@ -0,0 +1,148 @@
+// SPDX-FileCopyrightText: 2022 Daniel Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef MPBP_BOUND_HPP
+#define MPBP_BOUND_HPP
+
+#include <mpbp/Packer.hpp>
+#include <mpbp/Rect.hpp>
+#include <span>
+
+namespace mpbp
+{
+  /**
+   * @brief A theoretical lower bound on the amount of bin pages needed to pack a span of Rect.
+   *
+   * No packing of the Rect can use fewer pages than this bound, so a pack that reaches it is
+   * optimal. Use mpbp::LowerBound() to compute one.
+   *
+   */
+  class Bound
+  {
+   private:
+    int area_bound = 0;
+    int l2_bound = 0;
+
+   public:
+    /**
+     * @brief Construct a new Bound with default values.
+     *
+     * Both bounds are set to 0.
+     */
+    constexpr Bound() noexcept = default;
+    /**
+     * @brief Construct a new Bound object from precomputed bounds.
+     *
+     * @param area_bound The continuous area bound.
+     * @param l2_bound The Martello-Vigo L2 bound.
+     */
+    Bound(int area_bound, int l2_bound) noexcept;
+    /**
+     * @brief Get the continuous area bound.
+     *
+     * This is the total area of all Rect divided by the area of a page, rounded up.
+     *
+     * @return The area bound.
+     */
+    int GetAreaBound() const noexcept;
+    /**
+     * @brief Get the Martello-Vigo L2 bound.
+     *
+     * This bound counts the Rect that are too large to share a page with each other, and then adds
+     * the pages needed for the area of smaller Rect that can not fit beside them. It is often
+     * stronger than the area bound when many Rect are larger than half of a page.
+     *
+     * @return The L2 bound.
+     */
+    int GetL2Bound() const noexcept;
+    /**
+     * @brief Get the strongest lower bound on the amount of pages.
+     *
+     * @return The maximum of all computed bounds.
+     */
+    int GetPageCount() const noexcept;
+  };
+
+  /**
+   * @brief Compute a lower bound on the amount of bin pages needed to pack the given Rect.
+   *
+   * The bound is computed in O(n log n). The L2 bound is evaluated over every candidate split of
+   * one axis while the other axis is held at its smallest split, which keeps the cost low while
+   * still catching the cases where the area bound is weak.
+   *
+   * @param rects The span of Rect to compute the bound of.
+   * @param max_width The maximum width of a bin page.
+   * @param max_height The maximum height of a bin page.
+   *
+   * @return The lower bound.
+   */
+  mpbp::Bound LowerBound(const std::span<const mpbp::Rect> rects, int max_width, int max_height);
+
+  /**
+   * @brief A report comparing the result of a pack against its theoretical lower bound.
+   *
+   */
+  class Efficiency
+  {
+   private:
+    mpbp::Bound bound = mpbp::Bound();
+    int page_count = 0;
+    long long rect_area = 0;
+    long long page_area = 0;
+    long long max_page_area = 0;
+
+   public:
+    /**
+     * @brief Construct a new Efficiency report of a Packer.
+     *
+     * If the Packer uses a catalogue of page sizes, the lower bound is computed for pages as wide as
+     * the widest size and as tall as the tallest size, and the fill ratio uses the actual area of
+     * each page.
+     *
+     * @param packer The Packer that packed the Rect.
+     * @param rects The span of all Rect packed by the Packer, including those of previous packs.
+     */
+    Efficiency(const mpbp::Packer& packer, const std::span<const mpbp::Rect> rects);
+    /**
+     * @brief Get the lower bound of the packed Rect.
+     *
+     * @return An immutable reference to the lower bound.
+     */
+    const mpbp::Bound& GetBound() const noexcept;
+    /**
+     * @brief Get the amount of pages that the Packer used.
+     *
+     * @return The amount of pages.
+     */
+    int GetPageCount() const noexcept;
+    /**
+     * @brief Get the amount of pages used beyond the lower bound.
+     *
+     * @return The difference between the page count and the lower bound.
+     */
+    int GetPageGap() const noexcept;
+    /**
+     * @brief Get the ratio of the area of all Rect to the area of all pages.
+     *
+     * @return The fill ratio from 0 to 1.
+     */
+    double GetFillRatio() const noexcept;
+    /**
+     * @brief Get the fill ratio that a pack reaching the lower bound would have.
+     *
+     * @return The best possible fill ratio from 0 to 1.
+     */
+    double GetBoundFillRatio() const noexcept;
+    /**
+     * @brief Get if the page count is proven optimal.
+     *
+     * If this is true, repacking the Rect with any algorithm can not use fewer pages.
+     *
+     * @return If the page count equals the lower bound.
+     */
+    bool GetIsOptimal() const noexcept;
+  };
+}  // namespace mpbp
+
+#endif
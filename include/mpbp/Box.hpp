@@ -0,0 +1,204 @@
+// SPDX-FileCopyrightText: 2022 Daniel Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef MPBP_BOX_HPP
+#define MPBP_BOX_HPP
+
+#include <algorithm>
+#include <compare>
+
+namespace mpbp
+{
+  /**
+   * @brief A bin packable axis-alligned box.
+   *
+   * This class is the 3D counterpart of Rect, with a depth axis. It is used to define the sizes of boxes to pack with a BoxPacker, such as bricks of volume textures. When packing is complete, the positions that the boxes were packed can be retrieved from the getters of this class.
+   *
+   */
+  class Box
+  {
+   private:
+    unsigned long int identifier = 0;
+    int left_x = -1;
+    int top_y = -1;
+    int front_z = -1;
+    int page = -1;
+    int width = 0;
+    int height = 0;
+    int depth = 0;
+
+   public:
+    /**
+     * @brief Construct a new Box with default values.
+     *
+     * A Box created with this constructor will have a width, height and depth of 0, meaning that it will cause exceptions if it is added to a pack.
+     */
+    constexpr Box() noexcept = default;
+    /**
+     * @brief Construct a new Box object with a specific identifier, width, height, and depth.
+     *
+     * @param identifier A value used to differentiate this Box from all other Box in a pack span of Box.
+     * @param width The width of the Box.
+     * @param height The height of the Box.
+     * @param depth The depth of the Box.
+     */
+    constexpr Box(unsigned long int identifier, int width, int height, int depth) noexcept;
+    /**
+     * @brief Place a Box at the given position.
+     *
+     * Before this function is called, the left_x, top_y, front_z and page values are all -1. This function is used within the packing algorithm, and is usually not useful for end user use.
+     *
+     * @param left_x The x coordinate of the left side of the Box.
+     * @param top_y The y coordinate of the top side of the Box.
+     * @param front_z The z coordinate of the front side of the Box.
+     * @param page The bin page that the Box exists on.
+     */
+    constexpr void Place(int left_x, int top_y, int front_z, int page) noexcept;
+    /**
+     * @brief Get the x coordinate of the left side of the Box.
+     *
+     * @return The x coordinate of the left side of the Box.
+     */
+    constexpr int GetLeftX() const noexcept;
+    /**
+     * @brief Get the y coordinate of the top side of the Box.
+     *
+     * @return The y coordinate of the top side of the Box.
+     */
+    constexpr int GetTopY() const noexcept;
+    /**
+     * @brief Get the z coordinate of the front side of the Box.
+     *
+     * @return The z coordinate of the front side of the Box.
+     */
+    constexpr int GetFrontZ() const noexcept;
+    /**
+     * @brief Get the bin page that the Box exists on.
+     *
+     * @return The index of the bin page this Box exists on.
+     */
+    constexpr int GetPage() const noexcept;
+    /**
+     * @brief Get the x coordinate of the right side of the Box.
+     *
+     * @return The x coordinate of the right side of the Box.
+     */
+    constexpr int GetRightX() const noexcept;
+    /**
+     * @brief Get the y coordinate of the bottom side of the Box.
+     *
+     * @return The y coordinate of the bottom side of the Box.
+     */
+    constexpr int GetBottomY() const noexcept;
+    /**
+     * @brief Get the z coordinate of the back side of the Box.
+     *
+     * @return The z coordinate of the back side of the Box.
+     */
+    constexpr int GetBackZ() const noexcept;
+    /**
+     * @brief Get the width of the Box.
+     *
+     * @return The width of the Box.
+     */
+    constexpr int GetWidth() const noexcept;
+    /**
+     * @brief Get the height of the Box.
+     *
+     * @return The height of the Box.
+     */
+    constexpr int GetHeight() const noexcept;
+    /**
+     * @brief Get the depth of the Box.
+     *
+     * @return The depth of the Box.
+     */
+    constexpr int GetDepth() const noexcept;
+    /**
+     * @brief Get the value used to idenitfy this Box.
+     *
+     * @return The identifier of this Box.
+     */
+    constexpr unsigned long int GetIdentifier() const noexcept;
+    /**
+     * @brief Get the size of the largest dimension of this Box.
+     *
+     * This is the maximum value between the width, the height and the depth of the Box.
+     *
+     * @return The size of the largest dimension.
+     */
+    constexpr int GetMaxDimension() const noexcept;
+    /**
+     * @brief Get if this Box is degenerate.
+     *
+     * A degenerate Box has a width, height or depth that is less than or equal to 0.
+     *
+     * @return If the Box is degenerate.
+     */
+    constexpr bool GetIsDegenerate() const noexcept;
+    /**
+     * @brief Compare this Box with a different Box.
+     *
+     * This comparison compares the max dimensions of each Box. It use used internally by the pack algorithm.
+     *
+     * @return The strong ordering of the Box.
+     */
+    constexpr std::strong_ordering operator<=>(const mpbp::Box& other) const noexcept;
+  };
+}  // namespace mpbp
+
+// The members of Box are defined here rather than in a source file, so that the packing loops of
+// other translation units can inline them.
+
+constexpr mpbp::Box::Box(unsigned long int identifier, int width, int height, int depth) noexcept
+    : identifier(identifier), width(width), height(height), depth(depth)
+{
+}
+
+constexpr void mpbp::Box::Place(int left_x, int top_y, int front_z, int page) noexcept
+{
+  this->left_x = left_x;
+  this->top_y = top_y;
+  this->front_z = front_z;
+  this->page = page;
+}
+
+constexpr int mpbp::Box::GetLeftX() const noexcept { return this->left_x; }
+
+constexpr int mpbp::Box::GetTopY() const noexcept { return this->top_y; }
+
+constexpr int mpbp::Box::GetFrontZ() const noexcept { return this->front_z; }
+
+constexpr int mpbp::Box::GetPage() const noexcept { return this->page; }
+
+constexpr int mpbp::Box::GetRightX() const noexcept { return this->left_x + this->width - 1; }
+
+constexpr int mpbp::Box::GetBottomY() const noexcept { return this->top_y + this->height - 1; }
+
+constexpr int mpbp::Box::GetBackZ() const noexcept { return this->front_z + this->depth - 1; }
+
+constexpr int mpbp::Box::GetWidth() const noexcept { return this->width; }
+
+constexpr int mpbp::Box::GetHeight() const noexcept { return this->height; }
+
+constexpr int mpbp::Box::GetDepth() const noexcept { return this->depth; }
+
+constexpr unsigned long int mpbp::Box::GetIdentifier() const noexcept { return this->identifier; }
+
+constexpr int mpbp::Box::GetMaxDimension() const noexcept
+{
+  return std::max({this->width, this->height, this->depth});
+}
+
+constexpr bool mpbp::Box::GetIsDegenerate() const noexcept
+{
+  return this->width <= 0 || this->height <= 0 || this->depth <= 0;
+}
+
+constexpr std::strong_ordering mpbp::Box::operator<=>(const mpbp::Box& other) const noexcept
+{
+  return this->GetMaxDimension() <=> other.GetMaxDimension();
+}
+
+#endif
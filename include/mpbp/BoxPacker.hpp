@@ -0,0 +1,172 @@
+// SPDX-FileCopyrightText: 2022 Daniel Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef MPBP_BOX_PACKER_HPP
+#define MPBP_BOX_PACKER_HPP
+
+#include <array>
+#include <cstddef>
+#include <mpbp/Box.hpp>
+#include <mpbp/Volume.hpp>
+#include <span>
+#include <vector>
+
+namespace mpbp
+{
+  /**
+   * @brief A bin packing algorithm runner and state machine for Box.
+   *
+   * This class is the 3D counterpart of Packer. It packs Box into a series of bin pages with a depth axis, such as the pages of a volume texture. Each Box is placed in one of the smallest free Volume that fit it, found through buckets of Volume by the power of two size on each axis, and the rest of that Volume is split on all three axes into new Volume. Box that do not fit any Volume grow the top page up to the maximum size, and a new page is added only when the top page can not grow. If doing online packing, this class can be used to maintain packing information between packs.
+   *
+   */
+  class BoxPacker
+  {
+   private:
+    std::vector<mpbp::Volume> volumes = std::vector<mpbp::Volume>();
+    // The indices of the volumes in buckets by the power of two below each of their dimensions,
+    // and the index of each volume within its bucket.
+    std::vector<std::vector<std::size_t>> volume_buckets = std::vector<std::vector<std::size_t>>();
+    std::vector<std::size_t> volume_bucket_slots = std::vector<std::size_t>();
+    std::array<int, 3> bucket_levels = {0, 0, 0};
+    int page_count = 0;
+    int width = 0;
+    int height = 0;
+    int depth = 0;
+    int max_width = 0;
+    int max_height = 0;
+    int max_depth = 0;
+    int top_bin_width = 0;
+    int top_bin_height = 0;
+    int top_bin_depth = 0;
+
+    std::size_t getBucketI(int width, int height, int depth) const noexcept;
+    void addVolume(const std::array<int, 3>& origin, int page, const std::array<int, 3>& size);
+    void eraseVolume(std::size_t volume_i);
+    void splitVolume(const std::array<int, 3>& origin, int page, const std::array<int, 3>& size,
+                     const std::array<int, 3>& box_size);
+    bool tryPlaceVolume(mpbp::Box& box);
+    bool tryPlaceExpandBin(mpbp::Box& box);
+    void volumeLeftoverPage();
+    void placeNewPage(mpbp::Box& box);
+    void updateSize() noexcept;
+    int getTopPageI() const noexcept;
+
+   public:
+    /**
+     * @brief Construct a new BoxPacker object with default values.
+     *
+     * The maximum page size must be set with BoxPacker::SetMaxPageSize() before packing.
+     */
+    constexpr BoxPacker() noexcept = default;
+    /**
+     * @brief Construct a new BoxPacker object with a specified maximum bin size.
+     *
+     * @param max_width The maximum width of a bin page.
+     * @param max_height The maximum height of a bin page.
+     * @param max_depth The maximum depth of a bin page.
+     */
+    BoxPacker(int max_width, int max_height, int max_depth) noexcept;
+    /**
+     * @brief Clear the BoxPacker of data from all previous packs.
+     *
+     */
+    void Clear() noexcept;
+    /**
+     * @brief Change the maximum bin size and clear the BoxPacker state data.
+     *
+     * @param max_width The maximum width of a bin page.
+     * @param max_height The maximum height of a bin page.
+     * @param max_depth The maximum depth of a bin page.
+     */
+    void SetMaxPageSize(int max_width, int max_height, int max_depth);
+    /**
+     * @brief Get the vector of all Volume between Box from all previous packs.
+     *
+     * @return An immutable reference to the Volume vector.
+     */
+    const std::vector<mpbp::Volume>& GetVolumes() const noexcept;
+    /**
+     * @brief Get the amount of bin pages from all previous packs.
+     *
+     * @return The amount of pages.
+     */
+    int GetPageCount() const noexcept;
+    /**
+     * @brief Get the width of all bin pages.
+     *
+     * If all Box have been packed in less than a single bin page, this width will be smaller than the maximum width. Otherwise, it will be equal to the maximum width.
+     *
+     * @return The width of all bin pages.
+     */
+    int GetWidth() const noexcept;
+    /**
+     * @brief Get the height of all bin pages.
+     *
+     * If all Box have been packed in less than a single bin page, this height will be smaller than the maximum height. Otherwise, it will be equal to the maximum height.
+     *
+     * @return The height of all bin pages.
+     */
+    int GetHeight() const noexcept;
+    /**
+     * @brief Get the depth of all bin pages.
+     *
+     * If all Box have been packed in less than a single bin page, this depth will be smaller than the maximum depth. Otherwise, it will be equal to the maximum depth.
+     *
+     * @return The depth of all bin pages.
+     */
+    int GetDepth() const noexcept;
+    /**
+     * @brief Get the total volume of all bin pages.
+     *
+     * @return The sum of the volumes of all pages.
+     */
+    long long GetPageVolume() const noexcept;
+    /**
+     * @brief Get the maximum width of bin pages.
+     *
+     * @return The maximum width of bin pages.
+     */
+    int GetMaxWidth() const noexcept;
+    /**
+     * @brief Get the maximum height of bin pages.
+     *
+     * @return The maximum height of bin pages.
+     */
+    int GetMaxHeight() const noexcept;
+    /**
+     * @brief Get the maximum depth of bin pages.
+     *
+     * @return The maximum depth of bin pages.
+     */
+    int GetMaxDepth() const noexcept;
+    /**
+     * @brief Get the width of the bounding box of all Box on the top page.
+     *
+     * @return The width of the bounding box of all Box on the top page.
+     */
+    int GetTopBinWidth() const noexcept;
+    /**
+     * @brief Get the height of the bounding box of all Box on the top page.
+     *
+     * @return The height of the bounding box of all Box on the top page.
+     */
+    int GetTopBinHeight() const noexcept;
+    /**
+     * @brief Get the depth of the bounding box of all Box on the top page.
+     *
+     * @return The depth of the bounding box of all Box on the top page.
+     */
+    int GetTopBinDepth() const noexcept;
+    /**
+     * @brief Run the pack algorithm with the given span of Box.
+     *
+     * The Box are sorted by their max dimension from largest to smallest, and are then placed one by one. An exception is thrown if the maximum page size is not set, or if a Box is degenerate or does not fit in a page.
+     *
+     * @param boxes The span of Box to pack.
+     */
+    void Pack(const std::span<mpbp::Box> boxes);
+  };
+}  // namespace mpbp
+
+#endif
@@ -0,0 +1,108 @@
+// SPDX-FileCopyrightText: 2022 Daniel Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef MPBP_COMPOSITOR_HPP
+#define MPBP_COMPOSITOR_HPP
+
+#include <memory>
+#include <mpbp/Image.hpp>
+#include <mpbp/Packer.hpp>
+#include <mpbp/Rect.hpp>
+#include <mpbp/ThreadPool.hpp>
+#include <span>
+#include <vector>
+
+namespace mpbp
+{
+  /**
+   * @brief A builder of atlas page images from packed Rect and their source images.
+   *
+   * After a pack, this class copies the pixels of each Rect into the bin page that it was packed
+   * into. Each page is split into horizontal bands of rows, and each band is filled by one task of a
+   * ThreadPool, so threads never write to the same memory. Pixels that are not covered by any Rect
+   * are set to 0.
+   *
+   */
+  class Compositor
+  {
+   private:
+    mpbp::PixelFormat format = mpbp::PixelFormat::RGBA8;
+    int band_height = 64;
+    std::vector<std::unique_ptr<unsigned char[]>> pages =
+        std::vector<std::unique_ptr<unsigned char[]>>();
+    std::vector<int> page_widths = std::vector<int>();
+    std::vector<int> page_heights = std::vector<int>();
+
+   public:
+    /**
+     * @brief Construct a new Compositor object that builds pages of the given pixel format.
+     *
+     * @param format The pixel format of the pages and of every source image.
+     */
+    explicit Compositor(mpbp::PixelFormat format) noexcept;
+    /**
+     * @brief Set the amount of rows of a page that are filled by each task.
+     *
+     * Smaller bands balance the load between threads better, and larger bands have less overhead.
+     *
+     * @param band_height The amount of rows in each band.
+     */
+    void SetBandHeight(int band_height);
+    /**
+     * @brief Get the amount of rows of a page that are filled by each task.
+     *
+     * @return The amount of rows in each band.
+     */
+    int GetBandHeight() const noexcept;
+    /**
+     * @brief Get the pixel format of the pages.
+     *
+     * @return The pixel format.
+     */
+    mpbp::PixelFormat GetFormat() const noexcept;
+    /**
+     * @brief Build the pages of a pack using a temporary ThreadPool.
+     *
+     * @param packer The Packer that packed the Rect.
+     * @param rects The span of packed Rect.
+     * @param images The source image of each Rect, indexed by the identifier of the Rect.
+     */
+    void Compose(const mpbp::Packer& packer, const std::span<const mpbp::Rect> rects,
+                 const std::span<const mpbp::Image> images);
+    /**
+     * @brief Build the pages of a pack using the threads of a ThreadPool.
+     *
+     * Any pages from a previous call are replaced. An exception is thrown if a Rect is not placed
+     * within a page, if it has no source image, or if its source image does not match its size or
+     * the pixel format of the Compositor.
+     *
+     * @param packer The Packer that packed the Rect.
+     * @param rects The span of packed Rect.
+     * @param images The source image of each Rect, indexed by the identifier of the Rect.
+     * @param thread_pool The ThreadPool to run the copies on. It may be shared with other work, and
+     * this may be called from one of its tasks.
+     */
+    void Compose(const mpbp::Packer& packer, const std::span<const mpbp::Rect> rects,
+                 const std::span<const mpbp::Image> images, mpbp::ThreadPool& thread_pool);
+    /**
+     * @brief Get the amount of pages that were built.
+     *
+     * @return The amount of pages.
+     */
+    int GetPageCount() const noexcept;
+    /**
+     * @brief Get a view of the pixels of a built page.
+     *
+     * Rows of the page are tightly packed. The view is valid until the next call to
+     * Compositor::Compose() or until the Compositor is destroyed.
+     *
+     * @param page The index of the page.
+     *
+     * @return An Image viewing the page.
+     */
+    mpbp::Image GetPage(int page) const;
+  };
+}  // namespace mpbp
+
+#endif
@@ -0,0 +1,54 @@
+// SPDX-FileCopyrightText: 2022 Daniel Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef MPBP_FIT_HPP
+#define MPBP_FIT_HPP
+
+namespace mpbp
+{
+  /**
+   * @brief The answer to whether a span of Rect would fit in the pages of a Packer.
+   *
+   * Use mpbp::Packer::QueryFit() to get one. A query does not change the Packer or the Rect.
+   *
+   */
+  class Fit
+  {
+   private:
+    bool fits = false;
+    int new_page_count = -1;
+
+   public:
+    /**
+     * @brief Construct a new Fit with default values.
+     *
+     * A Fit created with this constructor does not fit and has no new page count.
+     */
+    constexpr Fit() noexcept = default;
+    /**
+     * @brief Construct a new Fit object from the result of a query.
+     *
+     * @param fits If the Rect fit without opening a new page.
+     * @param new_page_count The amount of pages that packing the Rect would open, or -1 if it was not
+     * counted.
+     */
+    Fit(bool fits, int new_page_count) noexcept;
+    /**
+     * @brief Get if the Rect fit in the existing pages without opening a new page.
+     *
+     * The top page may still grow up to the maximum page size.
+     *
+     * @return If the Rect fit.
+     */
+    bool GetFits() const noexcept;
+    /**
+     * @brief Get the amount of new pages that packing the Rect would open.
+     *
+     * @return The amount of new pages, or -1 if the Rect do not fit and new pages were not counted.
+     */
+    int GetNewPageCount() const noexcept;
+  };
+}  // namespace mpbp
+
+#endif
@@ -0,0 +1,126 @@
+// SPDX-FileCopyrightText: 2022 Daniel Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef MPBP_IMAGE_HPP
+#define MPBP_IMAGE_HPP
+
+#include <cstddef>
+
+namespace mpbp
+{
+  /**
+   * @brief The layout of a pixel in an Image.
+   *
+   * Each channel is one byte.
+   *
+   */
+  enum class PixelFormat
+  {
+    /**
+     * @brief One channel per pixel.
+     *
+     */
+    R8,
+    /**
+     * @brief Two channels per pixel.
+     *
+     */
+    RG8,
+    /**
+     * @brief Three channels per pixel.
+     *
+     */
+    RGB8,
+    /**
+     * @brief Four channels per pixel.
+     *
+     */
+    RGBA8
+  };
+
+  /**
+   * @brief Get the size of a pixel in bytes.
+   *
+   * @param format The format of the pixel.
+   *
+   * @return The amount of bytes in one pixel.
+   */
+  int GetPixelSize(mpbp::PixelFormat format) noexcept;
+
+  /**
+   * @brief A view of the pixels of an image that is owned elsewhere.
+   *
+   * This class is used to give the source pixels of each Rect to a Compositor. It does not copy or
+   * own the pixels, so they must stay alive for as long as the Image is used.
+   *
+   */
+  class Image
+  {
+   private:
+    const unsigned char* data = nullptr;
+    int width = 0;
+    int height = 0;
+    std::size_t stride = 0;
+    mpbp::PixelFormat format = mpbp::PixelFormat::RGBA8;
+
+   public:
+    /**
+     * @brief Construct a new Image with default values.
+     *
+     * An Image created with this constructor has no pixels.
+     */
+    constexpr Image() noexcept = default;
+    /**
+     * @brief Construct a new Image object that views rows of pixels.
+     *
+     * @param data A pointer to the first byte of the top row of pixels.
+     * @param width The width of the image in pixels.
+     * @param height The height of the image in pixels.
+     * @param stride The distance in bytes from the start of one row to the start of the next.
+     * @param format The layout of each pixel.
+     */
+    Image(const unsigned char* data, int width, int height, std::size_t stride,
+          mpbp::PixelFormat format) noexcept;
+    /**
+     * @brief Get a pointer to the first byte of the top row of pixels.
+     *
+     * @return A pointer to the pixels.
+     */
+    const unsigned char* GetData() const noexcept;
+    /**
+     * @brief Get a pointer to the first byte of a row of pixels.
+     *
+     * @param y The y coordinate of the row.
+     *
+     * @return A pointer to the row.
+     */
+    const unsigned char* GetRow(int y) const noexcept;
+    /**
+     * @brief Get the width of the image in pixels.
+     *
+     * @return The width of the image.
+     */
+    int GetWidth() const noexcept;
+    /**
+     * @brief Get the height of the image in pixels.
+     *
+     * @return The height of the image.
+     */
+    int GetHeight() const noexcept;
+    /**
+     * @brief Get the distance in bytes from the start of one row to the start of the next.
+     *
+     * @return The stride of the image.
+     */
+    std::size_t GetStride() const noexcept;
+    /**
+     * @brief Get the layout of each pixel.
+     *
+     * @return The pixel format of the image.
+     */
+    mpbp::PixelFormat GetFormat() const noexcept;
+  };
+}  // namespace mpbp
+
+#endif
@@ -0,0 +1,136 @@
+// SPDX-FileCopyrightText: 2022 Daniel Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef MPBP_INCREMENTAL_PACKER_HPP
+#define MPBP_INCREMENTAL_PACKER_HPP
+
+#include <cstddef>
+#include <mpbp/Packer.hpp>
+#include <mpbp/Rect.hpp>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace mpbp
+{
+  /**
+   * @brief A packer that keeps the placements of a manifest of Rect and updates them from diffs.
+   *
+   * This class keeps the placement of every Rect of a manifest by its identifier. When Rect are
+   * added, removed or resized, only those Rect are removed from and packed into the existing pages,
+   * so every other Rect keeps its placement and the time taken depends on the size of the diff
+   * rather than on the size of the manifest. Removed Rect leave Space that is not merged with its
+   * neighbours, so the pages slowly fragment. Once the ratio of Rect area to page area falls below
+   * a minimum share of the ratio that the last full pack reached, the whole manifest is packed
+   * again. A manifest that is built by updates only is compared with the ratio of the first update
+   * that placed any Rect instead.
+   *
+   */
+  class IncrementalPacker
+  {
+   private:
+    mpbp::Packer packer = mpbp::Packer();
+    std::unordered_map<unsigned long int, mpbp::Rect> rects =
+        std::unordered_map<unsigned long int, mpbp::Rect>();
+    long long rect_area = 0;
+    double min_fill_ratio = 0.8;
+    double full_pack_fill_ratio = 0.0;
+    std::size_t full_pack_count = 0;
+
+    void packAll();
+
+   public:
+    /**
+     * @brief Construct a new IncrementalPacker object with a specified maximum bin size.
+     *
+     * @param max_width The maximum width of a bin page.
+     * @param max_height The maximum height of a bin page.
+     */
+    IncrementalPacker(int max_width, int max_height) noexcept;
+    /**
+     * @brief Set the smallest share of the fill ratio of the last full pack that an update may leave.
+     *
+     * The fill ratio is the ratio of Rect area to page area. An update that leaves a fill ratio
+     * lower than this share of the fill ratio right after the last full pack packs the whole
+     * manifest again. The share is relative so that a manifest that can not fill its pages well is
+     * not packed again by every update. The default is 0.8, and 0 disables full packs.
+     *
+     * @param min_fill_ratio The minimum share of the fill ratio, from 0 to 1.
+     */
+    void SetMinFillRatio(double min_fill_ratio);
+    /**
+     * @brief Get the smallest share of the fill ratio of the last full pack that an update may leave.
+     *
+     * @return The minimum share of the fill ratio.
+     */
+    double GetMinFillRatio() const noexcept;
+    /**
+     * @brief Replace the manifest with a span of Rect and pack all of them.
+     *
+     * An exception is thrown if two Rect share an identifier. If packing throws an exception, the
+     * manifest is left empty.
+     *
+     * @param rects The span of Rect to pack. They are placed when this returns.
+     */
+    void Pack(const std::span<mpbp::Rect> rects);
+    /**
+     * @brief Remove, add and resize Rect of the manifest while keeping every other Rect in place.
+     *
+     * The removed Rect are freed first. Each changed Rect whose identifier is already in the
+     * manifest is a resized Rect. If its size did not change, it keeps its placement, and otherwise
+     * it is freed and packed again like an added Rect. If an exception is thrown, the manifest is
+     * not changed.
+     *
+     * @param removed_identifiers The identifiers of the Rect to remove from the manifest.
+     * @param changed_rects The span of added and resized Rect. They are placed when this returns.
+     *
+     * @return If the fill ratio fell below the minimum and the whole manifest was packed again, in
+     * which case any Rect may have moved.
+     */
+    bool Update(const std::span<const unsigned long int> removed_identifiers,
+                const std::span<mpbp::Rect> changed_rects);
+    /**
+     * @brief Get the placed Rect of the manifest with an identifier.
+     *
+     * An exception is thrown if no Rect of the manifest has the identifier.
+     *
+     * @param identifier The identifier of the Rect.
+     *
+     * @return An immutable reference to the placed Rect.
+     */
+    const mpbp::Rect& GetRect(unsigned long int identifier) const;
+    /**
+     * @brief Get every placed Rect of the manifest.
+     *
+     * @return The placed Rect, ordered by identifier.
+     */
+    std::vector<mpbp::Rect> GetRects() const;
+    /**
+     * @brief Get the amount of Rect in the manifest.
+     *
+     * @return The amount of Rect.
+     */
+    std::size_t GetRectCount() const noexcept;
+    /**
+     * @brief Get the ratio of the area of the Rect of the manifest to the area of the bin pages.
+     *
+     * @return The fill ratio, or 0 if there are no pages.
+     */
+    double GetFillRatio() const;
+    /**
+     * @brief Get the amount of times the whole manifest was packed, including by Pack().
+     *
+     * @return The amount of full packs.
+     */
+    std::size_t GetFullPackCount() const noexcept;
+    /**
+     * @brief Get the Packer that the Rect are packed with.
+     *
+     * @return An immutable reference to the Packer, which has the page count and sizes.
+     */
+    const mpbp::Packer& GetPacker() const noexcept;
+  };
+}  // namespace mpbp
+
+#endif
@@ -0,0 +1,108 @@
+// SPDX-FileCopyrightText: 2022 Daniel Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef MPBP_MOVE_HPP
+#define MPBP_MOVE_HPP
+
+namespace mpbp
+{
+  /**
+   * @brief The move of a packed Rect from one position to another.
+   *
+   * Use mpbp::Packer::DropTopPages() to get a list of them. Each move can be applied to an atlas by
+   * copying the pixels of the Rect from its old position to its new position.
+   *
+   */
+  class Move
+  {
+   private:
+    unsigned long int identifier = 0;
+    int from_left_x = -1;
+    int from_top_y = -1;
+    int from_page = -1;
+    int to_left_x = -1;
+    int to_top_y = -1;
+    int to_page = -1;
+    int width = 0;
+    int height = 0;
+
+   public:
+    /**
+     * @brief Construct a new Move with default values.
+     *
+     */
+    constexpr Move() noexcept = default;
+    /**
+     * @brief Construct a new Move object of a Rect.
+     *
+     * @param identifier The identifier of the moved Rect.
+     * @param from_left_x The x coordinate of the left side of the Rect before the move.
+     * @param from_top_y The y coordinate of the top side of the Rect before the move.
+     * @param from_page The bin page of the Rect before the move.
+     * @param to_left_x The x coordinate of the left side of the Rect after the move.
+     * @param to_top_y The y coordinate of the top side of the Rect after the move.
+     * @param to_page The bin page of the Rect after the move.
+     * @param width The width of the Rect.
+     * @param height The height of the Rect.
+     */
+    Move(unsigned long int identifier, int from_left_x, int from_top_y, int from_page,
+         int to_left_x, int to_top_y, int to_page, int width, int height) noexcept;
+    /**
+     * @brief Get the identifier of the moved Rect.
+     *
+     * @return The identifier of the Rect.
+     */
+    unsigned long int GetIdentifier() const noexcept;
+    /**
+     * @brief Get the x coordinate of the left side of the Rect before the move.
+     *
+     * @return The old left x coordinate.
+     */
+    int GetFromLeftX() const noexcept;
+    /**
+     * @brief Get the y coordinate of the top side of the Rect before the move.
+     *
+     * @return The old top y coordinate.
+     */
+    int GetFromTopY() const noexcept;
+    /**
+     * @brief Get the bin page of the Rect before the move.
+     *
+     * @return The old page.
+     */
+    int GetFromPage() const noexcept;
+    /**
+     * @brief Get the x coordinate of the left side of the Rect after the move.
+     *
+     * @return The new left x coordinate.
+     */
+    int GetToLeftX() const noexcept;
+    /**
+     * @brief Get the y coordinate of the top side of the Rect after the move.
+     *
+     * @return The new top y coordinate.
+     */
+    int GetToTopY() const noexcept;
+    /**
+     * @brief Get the bin page of the Rect after the move.
+     *
+     * @return The new page.
+     */
+    int GetToPage() const noexcept;
+    /**
+     * @brief Get the width of the moved Rect.
+     *
+     * @return The width of the Rect.
+     */
+    int GetWidth() const noexcept;
+    /**
+     * @brief Get the height of the moved Rect.
+     *
+     * @return The height of the Rect.
+     */
+    int GetHeight() const noexcept;
+  };
+}  // namespace mpbp
+
+#endif
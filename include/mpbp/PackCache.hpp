@@ -0,0 +1,115 @@
+// SPDX-FileCopyrightText: 2022 Daniel Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef MPBP_PACK_CACHE_HPP
+#define MPBP_PACK_CACHE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <mpbp/Packer.hpp>
+#include <mpbp/Rect.hpp>
+#include <span>
+#include <vector>
+
+namespace mpbp
+{
+  /**
+   * @brief A cache of pack results that is kept in files of a directory.
+   *
+   * Each result is keyed by a hash of the multiset of Rect sizes and groups, the page sizes, the
+   * options of the Packer and the version of mpbp. The result is stored as a compact binary file
+   * with the placements and the state of the Packer, so a pack that hits the cache loads the file
+   * with a single memory map rather than running Packer::Pack(). Rect of the same size and group
+   * are interchangeable, so a hit gives the placements of the first pack of the same multiset even
+   * if the Rect are in a different order or have different identifiers.
+   *
+   * The files are kept under a size cap by evicting the least recently used files. The last write
+   * time of a file is updated when it is hit, so the cache can be shared by several processes.
+   *
+   */
+  class PackCache
+  {
+   private:
+    std::filesystem::path directory = std::filesystem::path();
+    std::uintmax_t max_size = 0;
+    std::size_t hit_count = 0;
+    std::size_t miss_count = 0;
+    std::size_t eviction_count = 0;
+
+    bool tryLoad(const std::filesystem::path& path, std::span<const std::int32_t> settings,
+                 mpbp::Packer& packer, std::span<mpbp::Rect> rects) const;
+    void store(const std::filesystem::path& path, std::span<const std::int32_t> settings,
+               const mpbp::Packer& packer, std::span<const mpbp::Rect> rects);
+    void evict(const std::filesystem::path& kept_path);
+
+   public:
+    /**
+     * @brief Construct a new PackCache object that keeps its files in a directory.
+     *
+     * The directory is created if it does not exist.
+     *
+     * @param directory The directory to keep the cache files in.
+     * @param max_size The most bytes that the cache files may take up.
+     */
+    PackCache(std::filesystem::path directory, std::uintmax_t max_size);
+    /**
+     * @brief Pack a span of Rect with a Packer, or load their placements from the cache.
+     *
+     * The Packer must not have any pages or an active checkpoint, because a cached result replaces
+     * the whole state of the Packer. On a miss, the Rect are packed with Packer::Pack() and the
+     * result is stored. A result that can not be written to the directory is not stored, without
+     * an exception. On a hit, the order of the span is not changed.
+     *
+     * @param packer The Packer to pack with.
+     * @param rects The span of Rect to pack.
+     *
+     * @return If the placements were loaded from the cache.
+     */
+    bool Pack(mpbp::Packer& packer, const std::span<mpbp::Rect> rects);
+    /**
+     * @brief Remove every file of the cache.
+     *
+     */
+    void Clear();
+    /**
+     * @brief Get the directory that the cache files are kept in.
+     *
+     * @return An immutable reference to the path of the directory.
+     */
+    const std::filesystem::path& GetDirectory() const noexcept;
+    /**
+     * @brief Get the most bytes that the cache files may take up.
+     *
+     * @return The size cap in bytes.
+     */
+    std::uintmax_t GetMaxSize() const noexcept;
+    /**
+     * @brief Get the amount of bytes that the cache files take up.
+     *
+     * @return The size of the cache files in bytes.
+     */
+    std::uintmax_t GetSize() const;
+    /**
+     * @brief Get the amount of packs that were loaded from the cache.
+     *
+     * @return The hit count.
+     */
+    std::size_t GetHitCount() const noexcept;
+    /**
+     * @brief Get the amount of packs that were not found in the cache.
+     *
+     * @return The miss count.
+     */
+    std::size_t GetMissCount() const noexcept;
+    /**
+     * @brief Get the amount of files that were evicted to keep the cache under its size cap.
+     *
+     * @return The eviction count.
+     */
+    std::size_t GetEvictionCount() const noexcept;
+  };
+}  // namespace mpbp
+
+#endif
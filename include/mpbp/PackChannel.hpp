@@ -0,0 +1,286 @@
+// SPDX-FileCopyrightText: 2022 Daniel Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef MPBP_PACK_CHANNEL_HPP
+#define MPBP_PACK_CHANNEL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <mpbp/Rect.hpp>
+#include <span>
+#include <string>
+
+namespace mpbp
+{
+  /**
+   * @brief The state of a slot of a PackChannel.
+   *
+   */
+  enum class PackSlotState : std::uint32_t
+  {
+    /**
+     * @brief The slot has no request, or its response was already read.
+     *
+     */
+    Free = 0,
+    /**
+     * @brief The slot has a request that a PackServer has not started to pack yet.
+     *
+     */
+    Submitted = 1,
+    /**
+     * @brief The slot has a request that a PackServer is packing.
+     *
+     */
+    Packing = 2,
+    /**
+     * @brief The slot has a response that was not read yet.
+     *
+     */
+    Done = 3
+  };
+
+  /**
+   * @brief The result of a pack request that was run by a PackServer.
+   *
+   */
+  class PackResponse
+  {
+   private:
+    int page_count = 0;
+    int width = 0;
+    int height = 0;
+    bool cache_hit = false;
+
+   public:
+    /**
+     * @brief Construct a new PackResponse with default values.
+     *
+     * The page count, width and height are set to 0.
+     */
+    constexpr PackResponse() noexcept = default;
+    /**
+     * @brief Construct a new PackResponse object.
+     *
+     * @param page_count The amount of bin pages that the Rect were packed into.
+     * @param width The width of the bin pages.
+     * @param height The height of the bin pages.
+     * @param cache_hit If the placements were loaded from the cache of the server.
+     */
+    constexpr PackResponse(int page_count, int width, int height, bool cache_hit) noexcept;
+    /**
+     * @brief Get the amount of bin pages that the Rect were packed into.
+     *
+     * @return The amount of pages.
+     */
+    constexpr int GetPageCount() const noexcept;
+    /**
+     * @brief Get the width of the bin pages, like mpbp::Packer::GetWidth().
+     *
+     * @return The width of the bin pages.
+     */
+    constexpr int GetWidth() const noexcept;
+    /**
+     * @brief Get the height of the bin pages, like mpbp::Packer::GetHeight().
+     *
+     * @return The height of the bin pages.
+     */
+    constexpr int GetHeight() const noexcept;
+    /**
+     * @brief Get if the placements were loaded from the PackCache of the server.
+     *
+     * @return If the request hit the cache.
+     */
+    constexpr bool GetCacheHit() const noexcept;
+  };
+
+  /**
+   * @brief A ring of request slots in a POSIX shared memory object, shared by a PackClient and a
+   * PackServer.
+   *
+   * Each slot has a header with the state, request and response of the slot, followed by room for
+   * a fixed amount of Rect. A client writes its Rect straight into a slot and the server packs them
+   * where they are, so Rect are never copied or serialized between the processes. Both processes
+   * must use the same version of mpbp, which is checked when the channel is opened. This class is
+   * used internally by PackClient and PackServer. It has little use to end users in most
+   * situations.
+   *
+   */
+  class PackChannel
+  {
+   private:
+    std::string name = std::string();
+    void* data = nullptr;
+    std::size_t size = 0;
+    int slot_count = 0;
+    std::size_t slot_capacity = 0;
+    bool owned = false;
+
+    void map(int descriptor, std::size_t size);
+
+   public:
+    /**
+     * @brief Construct a new PackChannel object that is not open.
+     *
+     */
+    PackChannel() noexcept = default;
+    /**
+     * @brief Create a new shared memory object with a unique name and map it as a PackChannel.
+     *
+     * The shared memory object is removed when this PackChannel is destroyed, or earlier with
+     * PackChannel::Unlink().
+     *
+     * @param slot_count The amount of request slots, from 1 to 255.
+     * @param slot_capacity The most Rect that a request of a slot can have.
+     */
+    PackChannel(int slot_count, std::size_t slot_capacity);
+    /**
+     * @brief Map an existing PackChannel that was created by another process.
+     *
+     * An exception is thrown if the shared memory object does not exist or was not created by the
+     * same version of mpbp.
+     *
+     * @param name The name of the shared memory object.
+     */
+    explicit PackChannel(const std::string& name);
+    PackChannel(const mpbp::PackChannel&) = delete;
+    mpbp::PackChannel& operator=(const mpbp::PackChannel&) = delete;
+    PackChannel(mpbp::PackChannel&& other) noexcept;
+    mpbp::PackChannel& operator=(mpbp::PackChannel&& other) noexcept;
+    /**
+     * @brief Unmap the PackChannel, and remove its shared memory object if it was created by this
+     * PackChannel.
+     *
+     */
+    ~PackChannel();
+    /**
+     * @brief Remove the name of the shared memory object, so that no other process can open it.
+     *
+     * The memory stays mapped by every process that already opened it.
+     */
+    void Unlink() noexcept;
+    /**
+     * @brief Get the name of the shared memory object.
+     *
+     * @return An immutable reference to the name.
+     */
+    const std::string& GetName() const noexcept;
+    /**
+     * @brief Get the amount of request slots.
+     *
+     * @return The amount of slots.
+     */
+    int GetSlotCount() const noexcept;
+    /**
+     * @brief Get the most Rect that a request of a slot can have.
+     *
+     * @return The capacity of each slot.
+     */
+    std::size_t GetSlotCapacity() const noexcept;
+    /**
+     * @brief Get the state of a slot.
+     *
+     * Reading the state acquires the request or response that was written before it was set.
+     *
+     * @param slot_i The index of the slot.
+     *
+     * @return The state of the slot.
+     */
+    mpbp::PackSlotState GetState(int slot_i) const noexcept;
+    /**
+     * @brief Set the state of a slot.
+     *
+     * Setting the state releases the request or response that was written before it.
+     *
+     * @param slot_i The index of the slot.
+     * @param state The new state of the slot.
+     */
+    void SetState(int slot_i, mpbp::PackSlotState state) noexcept;
+    /**
+     * @brief Change the state of a slot from PackSlotState::Submitted to PackSlotState::Packing.
+     *
+     * @param slot_i The index of the slot.
+     *
+     * @return If the slot had a submitted request.
+     */
+    bool TryClaim(int slot_i) noexcept;
+    /**
+     * @brief Write the request of a slot.
+     *
+     * @param slot_i The index of the slot.
+     * @param rect_count The amount of Rect of the request.
+     * @param max_width The maximum width of a bin page.
+     * @param max_height The maximum height of a bin page.
+     */
+    void SetRequest(int slot_i, std::size_t rect_count, int max_width, int max_height) noexcept;
+    /**
+     * @brief Get the maximum page width of the request of a slot.
+     *
+     * @param slot_i The index of the slot.
+     *
+     * @return The maximum width of a bin page.
+     */
+    int GetMaxWidth(int slot_i) const noexcept;
+    /**
+     * @brief Get the maximum page height of the request of a slot.
+     *
+     * @param slot_i The index of the slot.
+     *
+     * @return The maximum height of a bin page.
+     */
+    int GetMaxHeight(int slot_i) const noexcept;
+    /**
+     * @brief Get the Rect of the request of a slot.
+     *
+     * An exception is thrown if the request has more Rect than the capacity of a slot.
+     *
+     * @param slot_i The index of the slot.
+     *
+     * @return The span of Rect in the shared memory.
+     */
+    std::span<mpbp::Rect> GetRects(int slot_i);
+    /**
+     * @brief Write the response of a slot.
+     *
+     * @param slot_i The index of the slot.
+     * @param response The response to the request of the slot.
+     */
+    void SetResponse(int slot_i, const mpbp::PackResponse& response) noexcept;
+    /**
+     * @brief Write the message of an exception that was thrown while packing the request of a slot.
+     *
+     * The message is cut short if it does not fit in the slot.
+     *
+     * @param slot_i The index of the slot.
+     * @param message The message of the exception.
+     */
+    void SetError(int slot_i, const std::string& message) noexcept;
+    /**
+     * @brief Get the response of a slot.
+     *
+     * An exception with the message of the server is thrown if the pack of the request failed.
+     *
+     * @param slot_i The index of the slot.
+     *
+     * @return The response to the request of the slot.
+     */
+    mpbp::PackResponse GetResponse(int slot_i) const;
+  };
+}  // namespace mpbp
+
+constexpr mpbp::PackResponse::PackResponse(int page_count, int width, int height,
+                                           bool cache_hit) noexcept
+    : page_count(page_count), width(width), height(height), cache_hit(cache_hit)
+{
+}
+
+constexpr int mpbp::PackResponse::GetPageCount() const noexcept { return this->page_count; }
+
+constexpr int mpbp::PackResponse::GetWidth() const noexcept { return this->width; }
+
+constexpr int mpbp::PackResponse::GetHeight() const noexcept { return this->height; }
+
+constexpr bool mpbp::PackResponse::GetCacheHit() const noexcept { return this->cache_hit; }
+
+#endif
@@ -0,0 +1,120 @@
+// SPDX-FileCopyrightText: 2022 Daniel Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef MPBP_PACK_CLIENT_HPP
+#define MPBP_PACK_CLIENT_HPP
+
+#include <cstddef>
+#include <filesystem>
+#include <mpbp/PackChannel.hpp>
+#include <mpbp/Rect.hpp>
+#include <span>
+
+namespace mpbp
+{
+  /**
+   * @brief A connection to a PackServer that packs Rect in the server process.
+   *
+   * The client creates a PackChannel and hands its name to the server over a Unix socket. Requests
+   * are written into the slots of the channel in ring order, and each slot can have one request in
+   * flight, so up to the slot count of requests can be packed at once. The server packs the Rect in
+   * place, so the placements can be read from the span that was returned by PackClient::Reserve()
+   * once PackClient::Wait() returns. A PackClient may only be used by one thread at a time.
+   *
+   */
+  class PackClient
+  {
+   private:
+    mpbp::PackChannel channel = mpbp::PackChannel();
+    int socket = -1;
+    int next_slot_i = 0;
+    int reserved_slot_i = -1;
+
+    void waitDone(int slot_i);
+
+   public:
+    /**
+     * @brief Construct a new PackClient object and connect it to a PackServer.
+     *
+     * An exception is thrown if no PackServer is listening on the socket, or if it refuses the
+     * channel.
+     *
+     * @param socket_path The path of the Unix socket that the PackServer listens on.
+     * @param slot_count The amount of requests that can be in flight at once, from 1 to 255.
+     * @param slot_capacity The most Rect that a single request can have.
+     */
+    PackClient(const std::filesystem::path& socket_path, int slot_count,
+               std::size_t slot_capacity);
+    PackClient(const mpbp::PackClient&) = delete;
+    mpbp::PackClient& operator=(const mpbp::PackClient&) = delete;
+    /**
+     * @brief Disconnect from the PackServer.
+     *
+     * Requests that are still in flight are finished by the server, but their responses are lost.
+     */
+    ~PackClient();
+    /**
+     * @brief Get the amount of requests that can be in flight at once.
+     *
+     * @return The slot count.
+     */
+    int GetSlotCount() const noexcept;
+    /**
+     * @brief Get the most Rect that a single request can have.
+     *
+     * @return The slot capacity.
+     */
+    std::size_t GetSlotCapacity() const noexcept;
+    /**
+     * @brief Reserve the next slot of the ring for a request, and get its Rect to be filled.
+     *
+     * At most the slot count of tickets may be waiting for PackClient::Wait(), so an exception is
+     * thrown if the ticket of the next slot has not been waited for yet. The span stays valid until
+     * the same slot is reserved again, and after PackClient::Wait() it holds the packed Rect. An
+     * exception is also thrown if the amount of Rect is more than the slot capacity.
+     *
+     * @param rect_count The amount of Rect of the request.
+     *
+     * @return The span of Rect in the shared memory of the slot.
+     */
+    std::span<mpbp::Rect> Reserve(std::size_t rect_count);
+    /**
+     * @brief Send the request of the reserved slot to the PackServer.
+     *
+     * An exception is thrown if no slot is reserved.
+     *
+     * @param max_width The maximum width of a bin page.
+     * @param max_height The maximum height of a bin page.
+     *
+     * @return The ticket of the request, to pass to PackClient::Wait().
+     */
+    int Submit(int max_width, int max_height);
+    /**
+     * @brief Wait for the response to a submitted request.
+     *
+     * The Rect of the request are packed like by mpbp::Packer::Pack(). If the pack failed on the
+     * server, an exception with the same message is thrown here.
+     *
+     * @param ticket The ticket that was returned by PackClient::Submit().
+     *
+     * @return The response of the server.
+     */
+    mpbp::PackResponse Wait(int ticket);
+    /**
+     * @brief Pack a span of Rect on the PackServer and wait for the response.
+     *
+     * The Rect are copied into the next slot and back out of it, so this is simpler but slower than
+     * filling the span of PackClient::Reserve() directly.
+     *
+     * @param rects The span of Rect to pack.
+     * @param max_width The maximum width of a bin page.
+     * @param max_height The maximum height of a bin page.
+     *
+     * @return The response of the server.
+     */
+    mpbp::PackResponse Pack(const std::span<mpbp::Rect> rects, int max_width, int max_height);
+  };
+}  // namespace mpbp
+
+#endif
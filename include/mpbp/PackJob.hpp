@@ -0,0 +1,130 @@
+// SPDX-FileCopyrightText: 2022 Daniel Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef MPBP_PACK_JOB_HPP
+#define MPBP_PACK_JOB_HPP
+
+#include <functional>
+#include <mpbp/Packer.hpp>
+#include <mpbp/Rect.hpp>
+#include <mpbp/ThreadPool.hpp>
+#include <span>
+
+namespace mpbp
+{
+  /**
+   * @brief An independent pack of a span of Rect into pages of its own maximum size.
+   *
+   * Use mpbp::PackMany() to run many jobs at once. The job does not own its Rect, so the span must
+   * stay valid until the job is packed.
+   *
+   */
+  class PackJob
+  {
+   private:
+    std::span<mpbp::Rect> rects = std::span<mpbp::Rect>();
+    int max_width = 0;
+    int max_height = 0;
+    int page_count = 0;
+    int width = 0;
+    int height = 0;
+
+   public:
+    /**
+     * @brief Construct a new PackJob with default values.
+     *
+     */
+    constexpr PackJob() noexcept = default;
+    /**
+     * @brief Construct a new PackJob object for a span of Rect.
+     *
+     * @param rects The span of Rect to pack.
+     * @param max_width The maximum width of a bin page.
+     * @param max_height The maximum height of a bin page.
+     */
+    PackJob(std::span<mpbp::Rect> rects, int max_width, int max_height) noexcept;
+    /**
+     * @brief Pack the Rect of the job with a Packer and save the resulting page count and size.
+     *
+     * The Packer is cleared and set to the maximum page size of the job first with
+     * Packer::SetMaxPageSize(), so the same Packer can be used for many jobs. This also removes any
+     * page sizes set with Packer::SetPageSizes(). The other settings of the Packer, such as its
+     * padding, alignment and prune mode, are kept.
+     *
+     * @param packer The Packer to pack with.
+     */
+    void Pack(mpbp::Packer& packer);
+    /**
+     * @brief Get the span of Rect to pack.
+     *
+     * @return The span of Rect.
+     */
+    std::span<mpbp::Rect> GetRects() const noexcept;
+    /**
+     * @brief Get the maximum width of a bin page.
+     *
+     * @return The maximum width of a bin page.
+     */
+    int GetMaxWidth() const noexcept;
+    /**
+     * @brief Get the maximum height of a bin page.
+     *
+     * @return The maximum height of a bin page.
+     */
+    int GetMaxHeight() const noexcept;
+    /**
+     * @brief Get the amount of bin pages that the Rect were packed into.
+     *
+     * @return The amount of pages, or 0 if the job was not packed yet.
+     */
+    int GetPageCount() const noexcept;
+    /**
+     * @brief Get the width of the bin pages, like mpbp::Packer::GetWidth().
+     *
+     * @return The width of the bin pages.
+     */
+    int GetWidth() const noexcept;
+    /**
+     * @brief Get the height of the bin pages, like mpbp::Packer::GetHeight().
+     *
+     * @return The height of the bin pages.
+     */
+    int GetHeight() const noexcept;
+  };
+
+  /**
+   * @brief Pack a span of independent PackJob using a temporary ThreadPool.
+   *
+   * @param jobs The span of PackJob.
+   */
+  void PackMany(const std::span<mpbp::PackJob> jobs);
+
+  /**
+   * @brief Pack a span of independent PackJob using the threads of a ThreadPool.
+   *
+   * Each job is a separate task, and each thread packs its jobs with a Packer of its own that keeps
+   * its memory between jobs, so many small jobs do not allocate again for each pack. If any job
+   * throws an exception, the first exception is rethrown after all jobs have finished.
+   *
+   * @param jobs The span of PackJob.
+   * @param thread_pool The ThreadPool to run the jobs on. It may be shared with other work, and
+   * this may be called from one of its tasks.
+   */
+  void PackMany(const std::span<mpbp::PackJob> jobs, mpbp::ThreadPool& thread_pool);
+
+  /**
+   * @brief Pack a span of independent PackJob using an executor of the caller.
+   *
+   * The executor is called once for each job with a task that packs it, and may run the task on any
+   * thread. This returns once every task has run. If any job throws an exception, the first
+   * exception is rethrown after all jobs have finished.
+   *
+   * @param jobs The span of PackJob.
+   * @param executor The function that runs each task.
+   */
+  void PackMany(const std::span<mpbp::PackJob> jobs,
+                const std::function<void(std::function<void()>)>& executor);
+}  // namespace mpbp
+
+#endif
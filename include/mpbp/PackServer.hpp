@@ -0,0 +1,134 @@
+// SPDX-FileCopyrightText: 2022 Daniel Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef MPBP_PACK_SERVER_HPP
+#define MPBP_PACK_SERVER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mpbp/ThreadPool.hpp>
+#include <mutex>
+#include <vector>
+
+namespace mpbp
+{
+  /**
+   * @brief A local server that packs the requests of PackClient in other processes.
+   *
+   * The server listens on a Unix socket. Each PackClient that connects hands over the name of a
+   * PackChannel, and then wakes the server with a byte on the socket for each request that it
+   * writes into the channel. The server gathers every submitted request of every client into a
+   * batch and packs the batch on a ThreadPool. Each thread packs with a Packer that keeps its
+   * memory between requests, and with a PackCache when one is set, so tools that pack the same
+   * Rect again get the result of an earlier pack. This class is used by the mpbpd executable, and
+   * can also be run on a thread of any process.
+   *
+   */
+  class PackServer
+  {
+   private:
+    struct Connection;
+    struct PendingConnection;
+    struct Worker;
+
+    std::filesystem::path socket_path = std::filesystem::path();
+    int listen_socket = -1;
+    int stop_pipe[2] = {-1, -1};
+    mpbp::ThreadPool thread_pool;
+    std::filesystem::path cache_directory = std::filesystem::path();
+    std::uintmax_t cache_max_size = 0;
+    // Connection, PendingConnection and Worker are only complete in the source file, so these
+    // vectors are not initialized from temporaries here.
+    std::vector<std::unique_ptr<Connection>> connections;
+    std::vector<std::unique_ptr<PendingConnection>> pending_connections;
+    std::mutex worker_mutex = std::mutex();
+    std::vector<std::unique_ptr<Worker>> idle_workers;
+    std::atomic<std::size_t> request_count = 0;
+    std::atomic<std::size_t> batch_count = 0;
+    std::atomic<std::size_t> cache_hit_count = 0;
+
+    void accept();
+    void receiveName(PendingConnection& pending_connection);
+    void packBatch();
+    std::unique_ptr<Worker> takeWorker();
+    void returnWorker(std::unique_ptr<Worker> worker);
+
+   public:
+    /**
+     * @brief Construct a new PackServer object that listens on a Unix socket, with a thread for
+     * each hardware thread.
+     *
+     * An exception is thrown if another PackServer is already listening on the socket. A socket
+     * file that is left over from a server that did not exit cleanly is replaced.
+     *
+     * @param socket_path The path of the Unix socket to listen on.
+     */
+    explicit PackServer(std::filesystem::path socket_path);
+    /**
+     * @brief Construct a new PackServer object that listens on a Unix socket, with a specific
+     * amount of threads.
+     *
+     * @param socket_path The path of the Unix socket to listen on.
+     * @param thread_count The amount of threads that pack requests, or 0 for one thread for each
+     * hardware thread.
+     */
+    PackServer(std::filesystem::path socket_path, std::size_t thread_count);
+    PackServer(const mpbp::PackServer&) = delete;
+    mpbp::PackServer& operator=(const mpbp::PackServer&) = delete;
+    /**
+     * @brief Close every connection and remove the socket file.
+     *
+     */
+    ~PackServer();
+    /**
+     * @brief Keep the results of packs in a PackCache.
+     *
+     * This must be called before PackServer::Run().
+     *
+     * @param directory The directory to keep the cache files in.
+     * @param max_size The most bytes that the cache files may take up.
+     */
+    void SetCache(std::filesystem::path directory, std::uintmax_t max_size);
+    /**
+     * @brief Accept clients and pack their requests until PackServer::Stop() is called.
+     *
+     */
+    void Run();
+    /**
+     * @brief Make PackServer::Run() return after the batch it is packing.
+     *
+     * This may be called from any thread, and from a signal handler.
+     */
+    void Stop() noexcept;
+    /**
+     * @brief Get the path of the Unix socket that the server listens on.
+     *
+     * @return An immutable reference to the path.
+     */
+    const std::filesystem::path& GetSocketPath() const noexcept;
+    /**
+     * @brief Get the amount of requests that were packed.
+     *
+     * @return The request count.
+     */
+    std::size_t GetRequestCount() const noexcept;
+    /**
+     * @brief Get the amount of batches of requests that were packed.
+     *
+     * @return The batch count.
+     */
+    std::size_t GetBatchCount() const noexcept;
+    /**
+     * @brief Get the amount of requests that were loaded from the PackCache.
+     *
+     * @return The cache hit count.
+     */
+    std::size_t GetCacheHitCount() const noexcept;
+  };
+}  // namespace mpbp
+
+#endif
@@ -5,13 +5,55 @@
 #ifndef MPBP_PACKER_HPP
 #define MPBP_PACKER_HPP
 
+#include <mpbp/Fit.hpp>
+#include <mpbp/Move.hpp>
+#include <mpbp/PageSize.hpp>
 #include <mpbp/Rect.hpp>
 #include <mpbp/Space.hpp>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <ranges>
 #include <span>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace mpbp
 {
+  class PackCache;
+
+  /**
+   * @brief The ways a Packer can handle Space that no remaining Rect of a pack can fit in.
+   *
+   * Rect are packed from largest to smallest, so once every remaining Rect of a pack is wider or
+   * taller than a Space, that Space can not be used again during the pack. Pruning it keeps it
+   * from being sorted and scanned for the rest of the pack.
+   *
+   */
+  enum class PruneMode
+  {
+    /**
+     * @brief Keep unreachable Space with all other Space.
+     *
+     */
+    Keep,
+    /**
+     * @brief Move unreachable Space aside during a pack and restore it when the pack finishes.
+     *
+     * This is useful for online packing, because smaller Rect in later packs may still fit in it.
+     */
+    SetAside,
+    /**
+     * @brief Permanently discard unreachable Space.
+     *
+     * This uses the least memory, but later packs will not be able to fill the discarded Space.
+     */
+    Drop
+  };
+
   /**
    * @brief A bin packing algorithm runner and state machine.
    * 
@@ -20,7 +62,41 @@ namespace mpbp
    */
   class Packer
   {
+    // A PackCache saves and restores the whole state of a Packer.
+    friend class mpbp::PackCache;
+
    private:
+    // The shortest run of identically sized rects that is placed as a grid instead of one by one.
+    static constexpr std::size_t grid_run_length = 16;
+
+    // A space that was inserted at or erased from an index of the space vector.
+    struct SpaceEdit
+    {
+      std::size_t space_i;
+      mpbp::Space space;
+      bool inserted;
+    };
+
+    // The sizes of the undo logs and the values of the counters when a checkpoint was made.
+    struct CheckpointState
+    {
+      std::size_t space_edit_count;
+      std::size_t closed_page_edit_count;
+      std::size_t group_page_edit_count;
+      std::size_t placement_count_edit_count;
+      std::size_t page_size_index_count;
+      int page_count;
+      int width;
+      int height;
+      int max_width;
+      int max_height;
+      int top_bin_width;
+      int top_bin_height;
+      int closed_page_count;
+      std::size_t pruned_space_count;
+      std::size_t duplicate_count;
+    };
+
     std::vector<mpbp::Space> spaces = std::vector<mpbp::Space>();
     int page_count = 0;
     int width = 0;
@@ -29,13 +105,61 @@ namespace mpbp
     int max_height = 0;
     int top_bin_width = 0;
     int top_bin_height = 0;
+    mpbp::PruneMode prune_mode = mpbp::PruneMode::Keep;
+    std::vector<mpbp::Space> pruned_spaces = std::vector<mpbp::Space>();
+    std::size_t pruned_space_count = 0;
+    std::size_t duplicate_count = 0;
+    int prune_width = 0;
+    int prune_height = 0;
+    std::vector<mpbp::PageSize> page_sizes = std::vector<mpbp::PageSize>();
+    std::vector<int> page_size_uses = std::vector<int>();
+    std::vector<int> page_size_indices = std::vector<int>();
+    std::vector<bool> closed_pages = std::vector<bool>();
+    // The amount of Rect placed on each page and not removed. Duplicates of a content hash pack
+    // share one placement.
+    std::vector<int> placement_counts = std::vector<int>();
+    int closed_page_count = 0;
+    int close_width = 0;
+    int close_height = 0;
+    int padding = 0;
+    int alignment_x = 1;
+    int alignment_y = 1;
+    bool shrink_to_fit = true;
+    std::unordered_map<int, std::vector<int>> group_pages =
+        std::unordered_map<int, std::vector<int>>();
+    std::vector<CheckpointState> checkpoints = std::vector<CheckpointState>();
+    std::vector<SpaceEdit> space_edits = std::vector<SpaceEdit>();
+    std::vector<int> closed_page_edits = std::vector<int>();
+    std::vector<std::pair<int, int>> group_page_edits = std::vector<std::pair<int, int>>();
+    std::vector<std::pair<int, int>> placement_count_edits = std::vector<std::pair<int, int>>();
 
+    int findPageSize(int width, int height, bool largest) const noexcept;
+    void closePage(int page);
+    void closeFullPages();
+    void releaseClosedSpaces();
+    void addSpace(int left_x, int top_y, int page, int width, int height);
+    void insertSpace(const mpbp::Space& space);
+    void eraseSpace(std::size_t space_i);
+    void pruneSpaces();
+    void restorePrunedSpaces();
     void reserveSpaces(const std::span<mpbp::Rect>& rects);
-    bool tryPlaceSpace(mpbp::Rect& rect);
+    bool tryPlaceSpace(mpbp::Rect& rect, const std::span<const int> pages);
     bool tryPlaceExpandBin(mpbp::Rect& rect);
+    void placeGrid(const std::span<mpbp::Rect> rects);
+    std::size_t fillSpaceGrid(std::size_t space_i, const std::span<mpbp::Rect> rects);
+    std::size_t placeGridPage(const std::span<mpbp::Rect> rects);
     void spaceLeftoverPage();
     void placeNewPage(mpbp::Rect& rect);
+    void recordGroupPage(const mpbp::Rect& rect);
+    void countPlacement(int page, int count);
+    void dropTopPage();
     int getTopPageI() const noexcept;
+    int getPaddedMaxWidth() const noexcept;
+    int getPaddedMaxHeight() const noexcept;
+    int getUnpaddedWidth(int padded_width) const noexcept;
+    int getUnpaddedHeight(int padded_height) const noexcept;
+    bool canRejectFit(const std::span<const mpbp::Rect> rects) const;
+    mpbp::Packer copyForQuery() const;
 
    public:
     /**
@@ -53,6 +177,14 @@ namespace mpbp
      * @param max_height The maximum height of a bin page.
      */
     Packer(int max_width, int max_height) noexcept;
+    /**
+     * @brief Construct a new Packer object with a catalogue of allowed page sizes.
+     *
+     * This constructor allows creating a Packer object and setting its page sizes in one statement.
+     *
+     * @param page_sizes The allowed sizes of bin pages.
+     */
+    Packer(const std::span<const mpbp::PageSize> page_sizes);
     /**
      * @brief Clear the Packer of data from all previous packs.
      * 
@@ -65,6 +197,25 @@ namespace mpbp
      * @param max_height The maximum height of a bin page.
      */
     void SetMaxPageSize(int max_width, int max_height);
+    /**
+     * @brief Change the bin size to a catalogue of allowed page sizes and clear the Packer state data.
+     *
+     * Each page grows up to the largest allowed size that is still available while it is being
+     * filled. When a new page is opened, or when the page size is retrieved, the page is given the
+     * smallest available size that contains all of its Rect, so that the total area of all pages
+     * stays small. If a page can not be opened because every size that fits a Rect has reached its
+     * count limit, Packer::Pack() throws an exception.
+     *
+     * @param page_sizes The allowed sizes of bin pages.
+     */
+    void SetPageSizes(const std::span<const mpbp::PageSize> page_sizes);
+    /**
+     * @brief Get the catalogue of allowed page sizes.
+     *
+     * @return An immutable reference to the page sizes, ordered from smallest to largest area. This
+     * is empty if the Packer uses a single maximum page size.
+     */
+    const std::vector<mpbp::PageSize>& GetPageSizes() const noexcept;
     /**
      * @brief Get the vector of all Space  between Rect from all previous packs.
      * 
@@ -82,6 +233,8 @@ namespace mpbp
      * 
      * If all Rect have been packed in less than a single bin page, this width will be smaller than the maximum width. Otherwise, it will be equal to the maximum width.
      * 
+     * If the Packer uses a catalogue of page sizes, use Packer::GetPageWidth() instead.
+     * 
      * @return The width of all bin pages. 
      */
     int GetWidth() const noexcept;
@@ -90,39 +243,393 @@ namespace mpbp
      * 
      * If all Rect have been packed in less than a single bin page, this height will be smaller than the maximum height. Otherwise, it will be equal to the maximum height.
      * 
+     * If the Packer uses a catalogue of page sizes, use Packer::GetPageHeight() instead.
+     * 
      * @return The height of all bin pages. 
      */
     int GetHeight() const noexcept;
+    /**
+     * @brief Get the width of a bin page.
+     *
+     * @param page The index of the bin page.
+     *
+     * @return The width of the bin page.
+     */
+    int GetPageWidth(int page) const;
+    /**
+     * @brief Get the height of a bin page.
+     *
+     * @param page The index of the bin page.
+     *
+     * @return The height of the bin page.
+     */
+    int GetPageHeight(int page) const;
+    /**
+     * @brief Get the total area of all bin pages.
+     *
+     * @return The sum of the areas of all pages.
+     */
+    long long GetPageArea() const;
     /**
      * @brief Get the maximum width of bin pages.
      * 
+     * If the Packer uses a catalogue of page sizes, this is the width that the top page may grow to.
+     * 
      * @return The maximum width of bin pages.
      */
     int GetMaxWidth() const noexcept;
     /**
      * @brief Get the maximum height of bin pages.
      * 
+     * If the Packer uses a catalogue of page sizes, this is the height that the top page may grow to.
+     * 
      * @return The maximum height of bin pages.
      */
     int GetMaxHeight() const noexcept;
     /**
      * @brief Get the width of the bounding rectangle of all Rect on the top page.
      * 
+     * This includes the padding of the Rect.
+     * 
      * @return The width of the bounding rectangle of all Rect on the top page.
      */
     int GetTopBinWidth() const noexcept;
     /**
      * @brief Get the height of the bounding rectangle of all Rect on the top page.
      * 
+     * This includes the padding of the Rect.
+     * 
      * @return The height of the bounding rectangle of all Rect on the top page.
      */
     int GetTopBinHeight() const noexcept;
+    /**
+     * @brief Set how Space that can not fit any remaining Rect of a pack is handled.
+     *
+     * @param prune_mode The new prune mode.
+     */
+    void SetPruneMode(mpbp::PruneMode prune_mode) noexcept;
+    /**
+     * @brief Get how Space that can not fit any remaining Rect of a pack is handled.
+     *
+     * @return The prune mode.
+     */
+    mpbp::PruneMode GetPruneMode() const noexcept;
+    /**
+     * @brief Get the amount of Space pruned from all previous packs.
+     *
+     * @return The amount of pruned Space.
+     */
+    std::size_t GetPrunedSpaceCount() const noexcept;
+    /**
+     * @brief Get the amount of duplicate Rect that shared a placement in all previous packs.
+     *
+     * @return The amount of duplicate Rect.
+     */
+    std::size_t GetDuplicateCount() const noexcept;
+    /**
+     * @brief Close a bin page so that no more Rect are packed into it.
+     *
+     * All Space of a closed page is released, so memory use and the cost of searching for Space
+     * only grow with the pages that are still open. This is useful for long running online packing.
+     * If the top page is closed, the next Rect that is packed opens a new page.
+     *
+     * @param page The index of the bin page to close.
+     */
+    void ClosePage(int page);
+    /**
+     * @brief Get if a bin page is closed.
+     *
+     * @param page The index of the bin page.
+     *
+     * @return If the bin page is closed.
+     */
+    bool GetIsPageClosed(int page) const;
+    /**
+     * @brief Get the amount of closed bin pages.
+     *
+     * @return The amount of closed pages.
+     */
+    int GetClosedPageCount() const noexcept;
+    /**
+     * @brief Get the bin pages that the Rect of a group were packed into.
+     *
+     * @param group The group of Rect.
+     *
+     * @return An immutable reference to the indices of the pages in ascending order. This is empty if no Rect of the group has been packed.
+     */
+    const std::vector<int>& GetGroupPages(int group) const noexcept;
+    /**
+     * @brief Set the size of Rect that a page must still be able to fit to stay open.
+     *
+     * At the end of every pack, each page other than the top page is closed if none of its Space
+     * can fit a Rect of this size. A width and height of 0 disables closing pages automatically,
+     * which is the default.
+     *
+     * @param close_width The width of Rect that an open page must fit.
+     * @param close_height The height of Rect that an open page must fit.
+     */
+    void SetCloseThreshold(int close_width, int close_height) noexcept;
+    /**
+     * @brief Get the width of Rect that a page must still be able to fit to stay open.
+     *
+     * @return The close threshold width.
+     */
+    int GetCloseWidth() const noexcept;
+    /**
+     * @brief Get the height of Rect that a page must still be able to fit to stay open.
+     *
+     * @return The close threshold height.
+     */
+    int GetCloseHeight() const noexcept;
+    /**
+     * @brief Set the gutter that is kept free around each Rect.
+     *
+     * Each Rect is packed as if it were 2 * padding wider and taller, so there are at least 2 *
+     * padding free pixels between any two Rect for bleeding their edges outwards. The placed
+     * coordinates of a Rect are those of the Rect itself and not of its padding. A Rect may touch
+     * the edges of its page, because the gutter only has to reach the neighbouring Rect. This can
+     * not be changed while the Packer has pages.
+     *
+     * @param padding The width of the gutter on each side of a Rect.
+     */
+    void SetPadding(int padding);
+    /**
+     * @brief Get the gutter that is kept free around each Rect.
+     *
+     * @return The width of the gutter on each side of a Rect.
+     */
+    int GetPadding() const noexcept;
+    /**
+     * @brief Set the multiples that the coordinates of every placed Rect are aligned to.
+     *
+     * This is useful for block compressed texture formats, which need each Rect to start at a block
+     * boundary. The size of a page that grows to fit its Rect is rounded up to the alignment too,
+     * unless that would make it larger than the maximum size. This can not be changed while the
+     * Packer has pages.
+     *
+     * @param alignment_x The multiple that left x coordinates are aligned to.
+     * @param alignment_y The multiple that top y coordinates are aligned to.
+     */
+    void SetAlignment(int alignment_x, int alignment_y);
+    /**
+     * @brief Get the multiple that the left x coordinate of every placed Rect is aligned to.
+     *
+     * @return The x alignment.
+     */
+    int GetAlignmentX() const noexcept;
+    /**
+     * @brief Get the multiple that the top y coordinate of every placed Rect is aligned to.
+     *
+     * @return The y alignment.
+     */
+    int GetAlignmentY() const noexcept;
+    /**
+     * @brief Set if the Space vector releases its unused memory at the end of each pack.
+     *
+     * This is on by default. Turning it off lets a Packer that is cleared and reused for many packs
+     * keep its memory instead of allocating it again for every pack.
+     *
+     * @param shrink_to_fit If unused memory is released.
+     */
+    void SetShrinkToFit(bool shrink_to_fit) noexcept;
+    /**
+     * @brief Get if the Space vector releases its unused memory at the end of each pack.
+     *
+     * @return If unused memory is released.
+     */
+    bool GetShrinkToFit() const noexcept;
+    /**
+     * @brief Save the current state of the Packer so that later packs can be undone.
+     *
+     * While a checkpoint is active, every change that a pack makes is recorded in an undo log
+     * instead of copying the Packer, so a checkpoint takes constant time and the log grows with the
+     * work done since it. This is useful for speculative packing, such as trying a batch of Rect
+     * and undoing it if it spills onto a new page. Checkpoints can be nested. Clearing the Packer
+     * or changing its page size discards all checkpoints.
+     */
+    void Checkpoint();
+    /**
+     * @brief Undo every change since the newest checkpoint and discard it.
+     *
+     * The placements of Rect packed since the checkpoint are not changed, so those Rect should be
+     * packed again or discarded. This can also be used to restore the Packer after a pack has
+     * thrown an exception. An exception is thrown if there is no checkpoint.
+     *
+     * Each Space that was added or used since the checkpoint is taken out of or put back into the
+     * sorted Space vector at its index, which moves the Space after it like the pack did. Undoing k
+     * Space edits of a Packer with n Space therefore takes O(k * n) time in the worst case, the
+     * same as the pack that made them, rather than time that only depends on k.
+     */
+    void Rollback();
+    /**
+     * @brief Keep every change since the newest checkpoint and discard it.
+     *
+     * The changes can still be undone by rolling back an older checkpoint. An exception is thrown if
+     * there is no checkpoint.
+     */
+    void Commit();
+    /**
+     * @brief Get the amount of active checkpoints.
+     *
+     * @return The amount of checkpoints that have not been rolled back or committed.
+     */
+    std::size_t GetCheckpointCount() const noexcept;
+    /**
+     * @brief Check if a span of Rect would fit in the existing bin pages without packing them.
+     *
+     * Neither the Packer nor the Rect are changed, so this can be called from several threads at
+     * once as long as no thread packs with the Packer at the same time. The free area and the
+     * largest Space of each page are checked first, which rejects most Rect that do not fit without
+     * running the pack algorithm. Otherwise, the pack is run on a copy of the Packer.
+     *
+     * @param rects The span of Rect to check.
+     *
+     * @return If the Rect fit. The new page count is only set if they fit, in which case it is 0.
+     */
+    mpbp::Fit QueryFit(const std::span<const mpbp::Rect> rects) const;
+    /**
+     * @brief Check if a span of Rect would fit in the existing bin pages, and count the new pages
+     * they would need if they do not.
+     *
+     * This is the same as the other query function, except that it always runs the pack algorithm
+     * on a copy of the Packer when count_new_pages is true, so that the new page count is known.
+     *
+     * @param rects The span of Rect to check.
+     * @param count_new_pages If the amount of new pages should be counted.
+     *
+     * @return If the Rect fit, and the amount of new pages they would open if it was counted.
+     */
+    mpbp::Fit QueryFit(const std::span<const mpbp::Rect> rects, bool count_new_pages) const;
+    /**
+     * @brief Give the area of a packed Rect back to its page so that later packs can fill it.
+     *
+     * The area becomes a new Space, so it is not merged with the free Space around it. Nothing is
+     * given back if the page of the Rect is closed. Each placed Rect may only be removed once. An
+     * exception is thrown if the Rect is not placed on a page of the Packer, if every Rect of its
+     * page was already removed, or if its area overlaps free Space, as it does when the Rect was
+     * already removed. Duplicates that a content hash pack placed at one position share its area,
+     * so they must not be removed one by one. Remove only one of them, once none of them is used.
+     *
+     * @param rect The packed Rect to remove.
+     */
+    void Remove(const mpbp::Rect& rect);
+    /**
+     * @brief Move the Rect of the top pages into the free Space of earlier pages and drop the
+     * emptied pages, so that fewer pages are used.
+     *
+     * This is the same as the other drop function, without a move budget.
+     *
+     * @param rects The span of every packed Rect that is still in use.
+     *
+     * @return The moves of the Rect in the order they were first moved.
+     */
+    std::vector<mpbp::Move> DropTopPages(const std::span<mpbp::Rect> rects);
+    /**
+     * @brief Move the Rect of the top pages into the free Space of earlier pages and drop the
+     * emptied pages, so that fewer pages are used, without moving more pixels than a budget.
+     *
+     * The Rect of the top page are moved into the free Space of the other open pages, largest
+     * first. If all of them fit and their area is within the remaining budget, the moves are kept
+     * and the empty top page is dropped, and the next top page is tried. Otherwise the Packer is
+     * left as it was before that page. Only the Rect of dropped pages move, so this does not
+     * compact the free Space of the pages that are kept, and it does not look for the moves with
+     * the fewest pixels. Pack every Rect again to do that. A Rect that is moved onto a page that is
+     * dropped later is moved again, but it still has a single move from its old position to its
+     * final position and its pixels are only counted once. The moved Rect are placed at their new
+     * positions.
+     *
+     * The span must hold each placement of the Packer that was not removed exactly once, so Rect
+     * that were removed with Packer::Remove() and all but one of the duplicates that a content
+     * hash pack placed at one position must not be in it. An exception is thrown before anything
+     * is moved if the amount of Rect on any page of the span does not match the Packer, if a Rect
+     * is not placed on a page of the Packer, if the budget is negative, or if a checkpoint is
+     * active.
+     *
+     * @param rects The span of every packed Rect that is still in use.
+     * @param move_budget The most pixels of Rect that may be moved.
+     *
+     * @return The moves of the Rect in the order they were first moved.
+     */
+    std::vector<mpbp::Move> DropTopPages(const std::span<mpbp::Rect> rects, long long move_budget);
     /**
      * @brief Run the pack algorithm with the given span of Rect.
      * 
+     * Runs of Rect with identical sizes are placed as grids, filling a whole Space or new page in one step, which makes packing tile and glyph sets much faster.
+     * 
+     * If any Rect has a group, Rect are packed group by group in order of their total area, and the Rect of each group prefer the pages that the group already touches. Rect without a group are ordered by their own area among the groups.
+     * 
      * @param rects The span of Rect to pack. 
      */
     void Pack(const std::span<mpbp::Rect> rects);
+    /**
+     * @brief Run the pack algorithm with the given span of Rect, packing duplicate content only once.
+     * 
+     * Rect with the same content hash and size are duplicates of each other. Only the first Rect with each content hash and size is packed, and every duplicate is then placed at the same position and page, and counts as on that page for its own group. This saves both packing time and page area when many Rect have identical images. Unlike the other pack function, the order of the Rect in the span is not changed.
+     * 
+     * @param rects The span of Rect to pack.
+     * @param content_hashes The hash of the content of each Rect, in the same order as the Rect.
+     */
+    void Pack(const std::span<mpbp::Rect> rects, const std::span<const std::uint64_t> content_hashes);
+    /**
+     * @brief Run the pack algorithm with the given span of Rect, reporting each page as soon as its placements are final.
+     * 
+     * A page is final once it is not the top page and none of its Space can fit the smallest remaining Rect, so no later Rect of the pack can be placed on it. Pages are checked whenever a new page is started or the size of the smallest remaining Rect changes, and the pages that are not final before then are reported in order when the pack ends. Each page that a Rect of the span is placed on is reported exactly once. Unless an open page limit is given, the Rect are placed exactly as by the pack function without a callback.
+     * 
+     * If there are more pages that are not final than the open page limit, the oldest of them except the top page are closed early so that they can be reported. This lowers the latency of the first pages at the cost of page area.
+     * 
+     * @param rects The span of Rect to pack.
+     * @param open_page_limit The most pages that may be left open while packing, or 0 for no limit.
+     * @param page_finished Called on the thread of the pack with the index of each final page and the front of the sorted span that has been placed so far.
+     */
+    void Pack(const std::span<mpbp::Rect> rects, int open_page_limit,
+              const std::function<void(int page, std::span<const mpbp::Rect> placed_rects)>&
+                  page_finished);
+    /**
+     * @brief Run the pack algorithm on a range of objects of any type, reading their sizes with
+     * projections.
+     *
+     * This allows packing objects that are not Rect without keeping a span of Rect next to them and
+     * copying the placements back by hand. The width and height of each object are read with the
+     * projections, which can be callables or pointers to members, and the placement of each object
+     * is written back by calling place_fn with the object, the x coordinate of its left side, the y
+     * coordinate of its top side and its page. The objects are placed in no particular order, and
+     * the order of the range is not changed.
+     *
+     * This is not free of copies. The pack algorithm sorts and places Rect, so the size of each
+     * object is copied into a temporary vector with one Rect per object, which lives only for this
+     * call. The peak memory of the pack is the same as copying the objects into Rect first.
+     *
+     * @param range The range of objects to pack.
+     * @param width_proj The projection that gets the width of an object.
+     * @param height_proj The projection that gets the height of an object.
+     * @param place_fn The function that is called with each object and its placement.
+     */
+    template <std::ranges::random_access_range Range, typename WidthProj, typename HeightProj,
+              typename PlaceFn>
+      requires std::ranges::sized_range<Range> &&
+               std::invocable<PlaceFn&, std::ranges::range_reference_t<Range>, int, int, int>
+    void Pack(Range&& range, WidthProj width_proj, HeightProj height_proj, PlaceFn place_fn)
+    {
+      const auto count = static_cast<std::size_t>(std::ranges::size(range));
+      // The Rect are local to this call, so copies of the Packer and packs that run one after
+      // another never share them. The identifier of each Rect is the index of its object.
+      std::vector<mpbp::Rect> projected_rects;
+      projected_rects.reserve(count);
+      auto it = std::ranges::begin(range);
+      for (std::size_t object_i = 0; object_i < count; object_i++, it++)
+      {
+        projected_rects.emplace_back(object_i, static_cast<int>(std::invoke(width_proj, *it)),
+                                     static_cast<int>(std::invoke(height_proj, *it)));
+      }
+      this->Pack(std::span<mpbp::Rect>(projected_rects));
+      const auto first = std::ranges::begin(range);
+      for (const auto& rect : projected_rects)
+      {
+        std::invoke(place_fn,
+                    first[static_cast<std::ranges::range_difference_t<Range>>(rect.GetIdentifier())],
+                    rect.GetLeftX(), rect.GetTopY(), rect.GetPage());
+      }
+    }
   };
 }  // namespace mpbp
 
@@ -0,0 +1,92 @@
+// SPDX-FileCopyrightText: 2022 Daniel Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef MPBP_PAGE_SIZE_HPP
+#define MPBP_PAGE_SIZE_HPP
+
+namespace mpbp
+{
+  /**
+   * @brief An allowed size of bin page in a page size catalogue.
+   *
+   * This class is used to give a Packer a list of page sizes to choose from, such as the texture
+   * sizes that a renderer supports. Each size can optionally be limited to a maximum amount of
+   * pages.
+   *
+   */
+  class PageSize
+  {
+   private:
+    int width = 0;
+    int height = 0;
+    int count_limit = -1;
+
+   public:
+    /**
+     * @brief Construct a new PageSize with default values.
+     *
+     * A PageSize created with this constructor will have a width and height of 0, meaning that it
+     * will cause exceptions if it is given to a Packer.
+     */
+    constexpr PageSize() noexcept = default;
+    /**
+     * @brief Construct a new PageSize object that may be used for any amount of pages.
+     *
+     * @param width The width of the page.
+     * @param height The height of the page.
+     */
+    PageSize(int width, int height) noexcept;
+    /**
+     * @brief Construct a new PageSize object that may be used for a limited amount of pages.
+     *
+     * @param width The width of the page.
+     * @param height The height of the page.
+     * @param count_limit The maximum amount of pages of this size, or -1 for no limit.
+     */
+    PageSize(int width, int height, int count_limit) noexcept;
+    /**
+     * @brief Get the width of the page.
+     *
+     * @return The width of the page.
+     */
+    int GetWidth() const noexcept;
+    /**
+     * @brief Get the height of the page.
+     *
+     * @return The height of the page.
+     */
+    int GetHeight() const noexcept;
+    /**
+     * @brief Get the area of the page.
+     *
+     * @return The width multiplied by the height.
+     */
+    long long GetArea() const noexcept;
+    /**
+     * @brief Get the maximum amount of pages of this size.
+     *
+     * @return The count limit, or -1 if there is no limit.
+     */
+    int GetCountLimit() const noexcept;
+    /**
+     * @brief Get if this PageSize is degenerate.
+     *
+     * A degenerate PageSize has a width or height that is less than or equal to 0.
+     *
+     * @return If the PageSize is degenerate.
+     */
+    bool GetIsDegenerate() const noexcept;
+    /**
+     * @brief Get if an area of the given size fits within the page.
+     *
+     * @param width The width of the area.
+     * @param height The height of the area.
+     *
+     * @return If the area fits within the page.
+     */
+    bool Fits(int width, int height) const noexcept;
+  };
+}  // namespace mpbp
+
+#endif
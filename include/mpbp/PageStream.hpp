@@ -0,0 +1,135 @@
+// SPDX-FileCopyrightText: 2022 Daniel Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef MPBP_PAGE_STREAM_HPP
+#define MPBP_PAGE_STREAM_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mpbp/Packer.hpp>
+#include <mpbp/Rect.hpp>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+
+namespace mpbp
+{
+  /**
+   * @brief A page whose placements are final, with copies of the Rect placed on it.
+   *
+   */
+  class PackedPage
+  {
+   private:
+    int page = 0;
+    int width = 0;
+    int height = 0;
+    std::vector<mpbp::Rect> rects = std::vector<mpbp::Rect>();
+
+   public:
+    /**
+     * @brief Construct a new PackedPage with default values.
+     *
+     * The page, width and height are set to 0, and there are no Rect.
+     */
+    PackedPage() noexcept = default;
+    /**
+     * @brief Construct a new PackedPage object.
+     *
+     * @param page The index of the page.
+     * @param width The width of the page.
+     * @param height The height of the page.
+     * @param rects The Rect placed on the page.
+     */
+    PackedPage(int page, int width, int height, std::vector<mpbp::Rect> rects) noexcept;
+    /**
+     * @brief Get the index of the page.
+     *
+     * @return The index of the page.
+     */
+    int GetPage() const noexcept;
+    /**
+     * @brief Get the width of the page.
+     *
+     * @return The width of the page.
+     */
+    int GetWidth() const noexcept;
+    /**
+     * @brief Get the height of the page.
+     *
+     * @return The height of the page.
+     */
+    int GetHeight() const noexcept;
+    /**
+     * @brief Get the Rect placed on the page by the pack.
+     *
+     * @return An immutable reference to the placed Rect.
+     */
+    const std::vector<mpbp::Rect>& GetRects() const noexcept;
+  };
+
+  /**
+   * @brief A pack that runs on a background thread and hands out each page as soon as it is final.
+   *
+   * This class packs a span of Rect with Packer::Pack() on its own thread, and queues each page
+   * that the pack reports as final. The pages are taken from the queue in the order they become
+   * final with PageStream::Next(), like values of a generator, so the pixels of the first pages can
+   * be copied or uploaded while later pages are still being packed. The Packer and the span must
+   * not be used by any other thread until PageStream::Next() returns false or the PageStream is
+   * destroyed.
+   *
+   */
+  class PageStream
+  {
+   private:
+    std::mutex mutex = std::mutex();
+    std::condition_variable page_condition = std::condition_variable();
+    std::deque<mpbp::PackedPage> pages = std::deque<mpbp::PackedPage>();
+    std::exception_ptr exception = nullptr;
+    bool finished = false;
+    std::thread thread = std::thread();
+
+    void run(mpbp::Packer& packer, std::span<mpbp::Rect> rects, int open_page_limit);
+
+   public:
+    /**
+     * @brief Construct a new PageStream object and start packing.
+     *
+     * @param packer The Packer to pack with.
+     * @param rects The span of Rect to pack.
+     */
+    PageStream(mpbp::Packer& packer, const std::span<mpbp::Rect> rects);
+    /**
+     * @brief Construct a new PageStream object with an open page limit and start packing.
+     *
+     * See Packer::Pack() for how the open page limit trades page area for latency.
+     *
+     * @param packer The Packer to pack with.
+     * @param rects The span of Rect to pack.
+     * @param open_page_limit The most pages that may be left open while packing, or 0 for no limit.
+     */
+    PageStream(mpbp::Packer& packer, const std::span<mpbp::Rect> rects, int open_page_limit);
+    PageStream(const mpbp::PageStream&) = delete;
+    mpbp::PageStream& operator=(const mpbp::PageStream&) = delete;
+    /**
+     * @brief Destroy the PageStream object after waiting for the pack to finish.
+     *
+     */
+    ~PageStream();
+    /**
+     * @brief Wait for the next final page.
+     *
+     * If the pack threw an exception, it is rethrown here once the pages before it are taken.
+     *
+     * @param page The PackedPage to move the next page into.
+     *
+     * @return If a page was taken, or false if every page has been taken.
+     */
+    bool Next(mpbp::PackedPage& page);
+  };
+}  // namespace mpbp
+
+#endif
@@ -5,7 +5,7 @@
 #ifndef MPBP_PACK_RECT_HPP
 #define MPBP_PACK_RECT_HPP
 
-#include <cmath>
+#include <algorithm>
 #include <compare>
 
 namespace mpbp
@@ -25,6 +25,7 @@ namespace mpbp
     int page = -1;
     int width = 0;
     int height = 0;
+    int group = -1;
 
    public:
     /**
@@ -40,7 +41,18 @@ namespace mpbp
      * @param width The width of the Rect.
      * @param height The height of the Rect.
      */
-    Rect(unsigned long int identifier, int width, int height) noexcept;
+    constexpr Rect(unsigned long int identifier, int width, int height) noexcept;
+    /**
+     * @brief Construct a new Rect object with a specific identifier, width, height, and group.
+     * 
+     * Rect that share a group are packed onto as few bin pages as possible, which is useful when each page switch costs a texture bind at render time.
+     * 
+     * @param identifier A value used to differentiate this Rect from all other Rect in a pack span of Rect.
+     * @param width The width of the Rect.
+     * @param height The height of the Rect.
+     * @param group The group of the Rect, or -1 if it has no group.
+     */
+    constexpr Rect(unsigned long int identifier, int width, int height, int group) noexcept;
     /**
      * @brief Place a Rect at the given position.
      * 
@@ -50,49 +62,49 @@ namespace mpbp
      * @param top_y The y coordinate of the top side of the Rect.
      * @param page The bin page that the Rect exists on.
      */
-    void Place(int left_x, int top_y, int page) noexcept;
+    constexpr void Place(int left_x, int top_y, int page) noexcept;
     /**
      * @brief Get the x coordinate of the left side of the Rect.
      * 
      * @return The x coordinate of the left side of the Rect.
      */
-    int GetLeftX() const noexcept;
+    constexpr int GetLeftX() const noexcept;
     /**
      * @brief Get the y coordinate of the top side of the Rect.
      * 
      * @return The y coordinate of the top side of the Rect.
      */
-    int GetTopY() const noexcept;
+    constexpr int GetTopY() const noexcept;
     /**
      * @brief Get the bin page that the Rect exists on.
      * 
      * @return The index of the bin page this Rect eixts on.
      */
-    int GetPage() const noexcept;
+    constexpr int GetPage() const noexcept;
     /**
      * @brief Get the x coordinate of the right side of the Rect.
      * 
      * @return The x coordinate of the right side of the Rect.
      */
-    int GetRightX() const noexcept;
+    constexpr int GetRightX() const noexcept;
     /**
      * @brief Get the y coordinate of the bottom side of the Rect.
      * 
      * @return The y coordinate of the bottom side of the Rect.
      */
-    int GetBottomY() const noexcept;
+    constexpr int GetBottomY() const noexcept;
     /**
      * @brief Get the width of the Rect.
      * 
      * @return The width of the Rect.
      */
-    int GetWidth() const noexcept;
+    constexpr int GetWidth() const noexcept;
     /**
      * @brief Get the height of the Rect.
      * 
      * @return The height of the Rect.
      */
-    int GetHeight() const noexcept;
+    constexpr int GetHeight() const noexcept;
     /**
      * @brief Get the value used to idenitfy this Rect.
      * 
@@ -100,7 +112,13 @@ namespace mpbp
      * 
      * @return The identifier of this Rect.
      */
-    unsigned long int GetIdentifier() const noexcept;
+    constexpr unsigned long int GetIdentifier() const noexcept;
+    /**
+     * @brief Get the group of this Rect.
+     * 
+     * @return The group of this Rect, or -1 if it has no group.
+     */
+    constexpr int GetGroup() const noexcept;
     /**
      * @brief Get the size of the largest dimension of this Rect.
      * 
@@ -108,7 +126,7 @@ namespace mpbp
      * 
      * @return The size of the largest dimension.
      */
-    int GetMaxDimension() const noexcept;
+    constexpr int GetMaxDimension() const noexcept;
     /**
      * @brief Get if this Rect is degenerate.
      * 
@@ -116,7 +134,7 @@ namespace mpbp
      * 
      * @return If the Rect is degenerate.
      */
-    bool GetIsDegenerate() const noexcept;
+    constexpr bool GetIsDegenerate() const noexcept;
     /**
      * @brief Compare this Rect with a different Rect.
      * 
@@ -124,8 +142,61 @@ namespace mpbp
      * 
      * @return The strong ordering of the Rect.
      */
-    std::strong_ordering operator<=>(const mpbp::Rect& other) const noexcept;
+    constexpr std::strong_ordering operator<=>(const mpbp::Rect& other) const noexcept;
   };
 }  // namespace mpbp
 
+// The members of Rect are defined here rather than in a source file, so that the packing loops of
+// other translation units can inline them.
+
+constexpr mpbp::Rect::Rect(unsigned long int identifier, int width, int height) noexcept
+    : identifier(identifier), width(width), height(height)
+{
+}
+
+constexpr mpbp::Rect::Rect(unsigned long int identifier, int width, int height, int group) noexcept
+    : identifier(identifier), width(width), height(height), group(group)
+{
+}
+
+constexpr void mpbp::Rect::Place(int left_x, int top_y, int page) noexcept
+{
+  this->left_x = left_x;
+  this->top_y = top_y;
+  this->page = page;
+}
+
+constexpr int mpbp::Rect::GetLeftX() const noexcept { return this->left_x; }
+
+constexpr int mpbp::Rect::GetTopY() const noexcept { return this->top_y; }
+
+constexpr int mpbp::Rect::GetPage() const noexcept { return this->page; }
+
+constexpr int mpbp::Rect::GetRightX() const noexcept { return this->left_x + this->width - 1; }
+
+constexpr int mpbp::Rect::GetBottomY() const noexcept { return this->top_y + this->height - 1; }
+
+constexpr int mpbp::Rect::GetWidth() const noexcept { return this->width; }
+
+constexpr int mpbp::Rect::GetHeight() const noexcept { return this->height; }
+
+constexpr unsigned long int mpbp::Rect::GetIdentifier() const noexcept { return this->identifier; }
+
+constexpr int mpbp::Rect::GetGroup() const noexcept { return this->group; }
+
+constexpr int mpbp::Rect::GetMaxDimension() const noexcept
+{
+  return std::max(this->width, this->height);
+}
+
+constexpr bool mpbp::Rect::GetIsDegenerate() const noexcept
+{
+  return this->width <= 0 || this->height <= 0;
+}
+
+constexpr std::strong_ordering mpbp::Rect::operator<=>(const mpbp::Rect& other) const noexcept
+{
+  return this->GetMaxDimension() <=> other.GetMaxDimension();
+}
+
 #endif
\ No newline at end of file
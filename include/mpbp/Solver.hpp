@@ -0,0 +1,129 @@
+// SPDX-FileCopyrightText: 2022 Daniel Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef MPBP_SOLVER_HPP
+#define MPBP_SOLVER_HPP
+
+#include <chrono>
+#include <mpbp/Rect.hpp>
+#include <mpbp/ThreadPool.hpp>
+#include <span>
+
+namespace mpbp
+{
+  /**
+   * @brief An exact bin packing solver for small spans of Rect.
+   *
+   * This class finds the smallest amount of bin pages that a span of Rect can be packed into, which
+   * can be fewer pages than the greedy algorithm of Packer uses. It starts from the result of a
+   * Packer and then searches for packings with one page less at a time until the lower bound of
+   * mpbp::LowerBound() is reached or no packing exists. The search is a branch and bound over the
+   * pages that each Rect is assigned to, where each page is checked by placing its Rect at the
+   * corner points of the Rect before them. Rect of the same size and empty pages are never tried in
+   * more than one order.
+   *
+   * The search time grows exponentially with the amount of Rect, so it is only practical for up to
+   * a few hundred Rect. If the node or time limit is reached, the best packing found so far is kept,
+   * which is never worse than the result of a Packer.
+   *
+   */
+  class Solver
+  {
+   private:
+    int max_width = 0;
+    int max_height = 0;
+    long long node_limit = 10000000;
+    std::chrono::milliseconds time_limit = std::chrono::milliseconds(0);
+    int page_count = 0;
+    int heuristic_page_count = 0;
+    int lower_bound = 0;
+    long long node_count = 0;
+    bool is_optimal = false;
+
+   public:
+    /**
+     * @brief Construct a new Solver object with a specified page size.
+     *
+     * @param max_width The width of a bin page.
+     * @param max_height The height of a bin page.
+     */
+    Solver(int max_width, int max_height) noexcept;
+    /**
+     * @brief Set the amount of search nodes after which the search stops.
+     *
+     * @param node_limit The maximum amount of nodes, or 0 for no limit.
+     */
+    void SetNodeLimit(long long node_limit);
+    /**
+     * @brief Get the amount of search nodes after which the search stops.
+     *
+     * @return The maximum amount of nodes, or 0 if there is no limit.
+     */
+    long long GetNodeLimit() const noexcept;
+    /**
+     * @brief Set the time after which the search stops.
+     *
+     * @param time_limit The maximum time that a solve may take, or 0 for no limit.
+     */
+    void SetTimeLimit(std::chrono::milliseconds time_limit);
+    /**
+     * @brief Get the time after which the search stops.
+     *
+     * @return The maximum time that a solve may take, or 0 if there is no limit.
+     */
+    std::chrono::milliseconds GetTimeLimit() const noexcept;
+    /**
+     * @brief Solve the given span of Rect using a temporary ThreadPool.
+     *
+     * @param rects The span of Rect to pack.
+     */
+    void Solve(const std::span<mpbp::Rect> rects);
+    /**
+     * @brief Solve the given span of Rect using the threads of a ThreadPool.
+     *
+     * Each Rect is placed the same way that Packer::Pack() places it, but unlike a pack, the order of
+     * the Rect in the span is not changed. Branches near the root of the search are run as separate
+     * tasks, so idle threads steal whole subtrees of the search from busy ones.
+     *
+     * @param rects The span of Rect to pack.
+     * @param thread_pool The ThreadPool to run the search on. It may be shared with other work, and
+     * this may be called from one of its tasks.
+     */
+    void Solve(const std::span<mpbp::Rect> rects, mpbp::ThreadPool& thread_pool);
+    /**
+     * @brief Get the amount of pages that the last solve used.
+     *
+     * @return The amount of pages.
+     */
+    int GetPageCount() const noexcept;
+    /**
+     * @brief Get the amount of pages that a Packer used for the Rect of the last solve.
+     *
+     * @return The amount of pages of the greedy pack that the search started from.
+     */
+    int GetHeuristicPageCount() const noexcept;
+    /**
+     * @brief Get the lower bound on the amount of pages for the Rect of the last solve.
+     *
+     * @return The lower bound computed by mpbp::LowerBound().
+     */
+    int GetLowerBound() const noexcept;
+    /**
+     * @brief Get the amount of search nodes that the last solve visited.
+     *
+     * @return The amount of nodes.
+     */
+    long long GetNodeCount() const noexcept;
+    /**
+     * @brief Get if the page count of the last solve is proven to be the smallest possible.
+     *
+     * This is false if the search stopped at the node or time limit before it could finish.
+     *
+     * @return If the page count is optimal.
+     */
+    bool GetIsOptimal() const noexcept;
+  };
+}  // namespace mpbp
+
+#endif
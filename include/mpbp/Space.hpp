@@ -5,12 +5,12 @@
 #ifndef MPBP_SPACE_HPP
 #define MPBP_SPACE_HPP
 
+#include <algorithm>
 #include <compare>
+#include <mpbp/Rect.hpp>
 
 namespace mpbp
 {
-  struct Rect;
-  
   /**
    * @brief An axis-alligned rectangular space between packed Rect in a set of bin pages.
    * 
@@ -43,37 +43,37 @@ namespace mpbp
      * @param width The width of the Space.
      * @param height The height of the Space.
      */
-    Space(int left_x, int top_y, int page, int width, int height) noexcept;
+    constexpr Space(int left_x, int top_y, int page, int width, int height) noexcept;
     /**
      * @brief Get the x coordinate of the left side of the Space.
      * 
      * @return The x coordinate of the left side of the Space.
      */
-    int GetLeftX() const noexcept;
+    constexpr int GetLeftX() const noexcept;
     /**
      * @brief Get the y coordinate of the top side of the Space.
      * 
      * @return The y coordinate of the top side of the Space.
      */
-    int GetTopY() const noexcept;
+    constexpr int GetTopY() const noexcept;
     /**
      * @brief Get the bin page that the Space exists on.
      * 
      * @return The index of the bin page this Space exists on.
      */
-    int GetPage() const noexcept;
+    constexpr int GetPage() const noexcept;
     /**
      * @brief Get the width of the Space.
      * 
      * @return The width of the Space.
      */
-    int GetWidth() const noexcept;
+    constexpr int GetWidth() const noexcept;
     /**
      * @brief Get the height of the Space.
      * 
      * @return The height of the Space.
      */
-    int GetHeight() const noexcept;
+    constexpr int GetHeight() const noexcept;
     /**
      * @brief Get the size of the largest dimension of this Space.
      * 
@@ -81,7 +81,7 @@ namespace mpbp
      * 
      * @return The size of the largest dimension.
      */
-    int GetMaxDimension() const noexcept;
+    constexpr int GetMaxDimension() const noexcept;
     /**
      * @brief Get if this Space is degenerate.
      * 
@@ -89,7 +89,7 @@ namespace mpbp
      * 
      * @return If the Space is degenerate.
      */
-    bool GetIsDegenerate() const noexcept;
+    constexpr bool GetIsDegenerate() const noexcept;
     /**
      * @brief Compare this Space with a different Space.
      * 
@@ -97,7 +97,7 @@ namespace mpbp
      * 
      * @return The strong ordering of the Space.
      */
-    std::strong_ordering operator<=>(const mpbp::Space& other) const noexcept;
+    constexpr std::strong_ordering operator<=>(const mpbp::Space& other) const noexcept;
     /**
      * @brief Get if a Space fits within the Rect.
      * 
@@ -105,8 +105,62 @@ namespace mpbp
      * 
      * @return If the Rect fits within the Space. 
      */
-    bool Fits(const mpbp::Rect& rect) const noexcept;
+    constexpr bool Fits(const mpbp::Rect& rect) const noexcept;
+    /**
+     * @brief Get if an area of a given size fits within the Space.
+     *
+     * @param width The width of the area.
+     * @param height The height of the area.
+     *
+     * @return If the area fits within the Space.
+     */
+    constexpr bool Fits(int width, int height) const noexcept;
   };
 }  // namespace mpbp
 
+// The members of Space are defined here rather than in a source file, so that the packing loops
+// can inline them.
+
+constexpr mpbp::Space::Space(int left_x, int top_y, int page, int width, int height) noexcept
+    : max_dimension(std::max(width, height)),
+      left_x(left_x),
+      top_y(top_y),
+      page(page),
+      width(width),
+      height(height)
+{
+}
+
+constexpr int mpbp::Space::GetLeftX() const noexcept { return this->left_x; }
+
+constexpr int mpbp::Space::GetTopY() const noexcept { return this->top_y; }
+
+constexpr int mpbp::Space::GetPage() const noexcept { return this->page; }
+
+constexpr int mpbp::Space::GetWidth() const noexcept { return this->width; }
+
+constexpr int mpbp::Space::GetHeight() const noexcept { return this->height; }
+
+constexpr int mpbp::Space::GetMaxDimension() const noexcept { return this->max_dimension; }
+
+constexpr bool mpbp::Space::GetIsDegenerate() const noexcept
+{
+  return this->width <= 0 || this->height <= 0;
+}
+
+constexpr std::strong_ordering mpbp::Space::operator<=>(const mpbp::Space& other) const noexcept
+{
+  return this->max_dimension <=> other.max_dimension;
+}
+
+constexpr bool mpbp::Space::Fits(const mpbp::Rect& rect) const noexcept
+{
+  return this->width >= rect.GetWidth() && this->height >= rect.GetHeight();
+}
+
+constexpr bool mpbp::Space::Fits(int width, int height) const noexcept
+{
+  return this->width >= width && this->height >= height;
+}
+
 #endif
\ No newline at end of file
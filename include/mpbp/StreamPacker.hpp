@@ -0,0 +1,139 @@
+// SPDX-FileCopyrightText: 2022 Daniel Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef MPBP_STREAM_PACKER_HPP
+#define MPBP_STREAM_PACKER_HPP
+
+#include <cstddef>
+#include <deque>
+#include <istream>
+#include <mpbp/Packer.hpp>
+#include <mpbp/Rect.hpp>
+#include <ostream>
+#include <vector>
+
+namespace mpbp
+{
+  /**
+   * @brief A packer for streams of Rect that are too large to keep in memory.
+   *
+   * This class reads Rect from a binary input stream in chunks, packs each chunk with a Packer, and
+   * writes the placement of each Rect to a binary output stream as soon as it is packed. Placed Rect
+   * are never moved again, so only the Space of open pages has to be kept in memory. Pages are
+   * closed once they can not fit a Rect of the close threshold size, and the oldest open pages are
+   * closed when there are more open pages than the open page limit, so memory use depends on the
+   * chunk size and the amount of open pages rather than on the amount of Rect.
+   *
+   * Rect are packed best when the input stream is sorted by max dimension from largest to smallest,
+   * like Packer::Pack() sorts its span. Such a stream can be made with an external sort.
+   *
+   * Each input record is the identifier of a Rect as a 64 bit unsigned integer, followed by its
+   * width and height as 32 bit signed integers. Each output record is the identifier followed by
+   * the left x coordinate, top y coordinate, page, width and height as 32 bit signed integers. All
+   * values are in the native byte order.
+   *
+   */
+  class StreamPacker
+  {
+   private:
+    mpbp::Packer packer = mpbp::Packer();
+    std::size_t chunk_size = 65536;
+    int open_page_limit = 4;
+    std::deque<int> open_pages = std::deque<int>();
+    std::vector<mpbp::Rect> chunk = std::vector<mpbp::Rect>();
+    unsigned long long rect_count = 0;
+
+    void closePages();
+
+   public:
+    /**
+     * @brief Construct a new StreamPacker object with a specified maximum bin size.
+     *
+     * @param max_width The maximum width of a bin page.
+     * @param max_height The maximum height of a bin page.
+     */
+    StreamPacker(int max_width, int max_height) noexcept;
+    /**
+     * @brief Set the amount of Rect that are read and packed at once.
+     *
+     * @param chunk_size The amount of Rect in each chunk.
+     */
+    void SetChunkSize(std::size_t chunk_size);
+    /**
+     * @brief Get the amount of Rect that are read and packed at once.
+     *
+     * @return The amount of Rect in each chunk.
+     */
+    std::size_t GetChunkSize() const noexcept;
+    /**
+     * @brief Set the most pages that are kept open after each chunk.
+     *
+     * @param open_page_limit The maximum amount of open pages.
+     */
+    void SetOpenPageLimit(int open_page_limit);
+    /**
+     * @brief Get the most pages that are kept open after each chunk.
+     *
+     * @return The maximum amount of open pages.
+     */
+    int GetOpenPageLimit() const noexcept;
+    /**
+     * @brief Set the size of Rect that a page must still be able to fit to stay open.
+     *
+     * This is passed to Packer::SetCloseThreshold(). By default, pages are only closed by the open
+     * page limit.
+     *
+     * @param close_width The width of Rect that an open page must fit.
+     * @param close_height The height of Rect that an open page must fit.
+     */
+    void SetCloseThreshold(int close_width, int close_height) noexcept;
+    /**
+     * @brief Pack every Rect of an input stream and write their placements to an output stream.
+     *
+     * This can be called several times to continue packing into the same pages, like online packing
+     * with a Packer. An exception is thrown if the input ends within a record, if the output can not
+     * be written, or if a Rect can not be packed.
+     *
+     * @param input The binary stream of Rect to pack.
+     * @param output The binary stream to write the placed Rect to.
+     */
+    void Pack(std::istream& input, std::ostream& output);
+    /**
+     * @brief Get the Packer that the Rect are packed with.
+     *
+     * @return An immutable reference to the Packer, which has the page count and sizes.
+     */
+    const mpbp::Packer& GetPacker() const noexcept;
+    /**
+     * @brief Get the amount of pages that are still open.
+     *
+     * @return The amount of open pages.
+     */
+    int GetOpenPageCount() const noexcept;
+    /**
+     * @brief Get the amount of Rect packed by all previous packs.
+     *
+     * @return The amount of packed Rect.
+     */
+    unsigned long long GetRectCount() const noexcept;
+    /**
+     * @brief Write a Rect to an input stream of a StreamPacker.
+     *
+     * @param input The binary stream to write the Rect to.
+     * @param rect The Rect to write.
+     */
+    static void WriteInputRect(std::ostream& input, const mpbp::Rect& rect);
+    /**
+     * @brief Read a placed Rect from an output stream of a StreamPacker.
+     *
+     * @param output The binary stream to read the Rect from.
+     * @param rect The Rect to read into.
+     *
+     * @return If a Rect was read, or false if the stream has ended.
+     */
+    static bool ReadPlacedRect(std::istream& output, mpbp::Rect& rect);
+  };
+}  // namespace mpbp
+
+#endif
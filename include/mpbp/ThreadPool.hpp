@@ -0,0 +1,148 @@
+// SPDX-FileCopyrightText: 2022 Daniel Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef MPBP_THREAD_POOL_HPP
+#define MPBP_THREAD_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace mpbp
+{
+  class TaskGroup;
+
+  /**
+   * @brief A work stealing pool of threads used to run parallel parts of the library.
+   *
+   * Each thread has its own queue of tasks. Tasks submitted from a thread of the pool are added to
+   * that thread's queue, and threads with an empty queue steal the oldest tasks of other threads.
+   * This keeps recursive work close to the thread that created it while still balancing the load.
+   *
+   */
+  class ThreadPool
+  {
+   private:
+    struct Worker
+    {
+      std::deque<std::function<void()>> tasks = std::deque<std::function<void()>>();
+      std::mutex mutex = std::mutex();
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers = std::vector<std::unique_ptr<Worker>>();
+    std::vector<std::thread> threads = std::vector<std::thread>();
+    std::mutex wake_mutex = std::mutex();
+    std::condition_variable wake_condition = std::condition_variable();
+    std::condition_variable idle_condition = std::condition_variable();
+    std::atomic<std::size_t> queued_count = 0;
+    std::atomic<std::size_t> pending_count = 0;
+    std::atomic<std::size_t> next_worker_i = 0;
+    std::exception_ptr exception = nullptr;
+    bool stopping = false;
+
+    void run(std::size_t worker_i);
+    bool tryRunTask(std::size_t worker_i);
+    void finishTask();
+
+    friend class mpbp::TaskGroup;
+
+   public:
+    /**
+     * @brief Construct a new ThreadPool with one thread for each hardware thread.
+     *
+     */
+    ThreadPool();
+    /**
+     * @brief Construct a new ThreadPool with a specific amount of threads.
+     *
+     * @param thread_count The amount of threads, or 0 for one thread for each hardware thread.
+     */
+    explicit ThreadPool(std::size_t thread_count);
+    ThreadPool(const mpbp::ThreadPool&) = delete;
+    mpbp::ThreadPool& operator=(const mpbp::ThreadPool&) = delete;
+    /**
+     * @brief Destroy the ThreadPool object.
+     *
+     * All tasks that are still queued are finished before the threads are joined.
+     */
+    ~ThreadPool();
+    /**
+     * @brief Get the amount of threads in the pool.
+     *
+     * @return The amount of threads.
+     */
+    std::size_t GetThreadCount() const noexcept;
+    /**
+     * @brief Add a task to be run by a thread of the pool.
+     *
+     * This may be called from within a running task.
+     *
+     * @param task The task to run.
+     */
+    void Submit(std::function<void()> task);
+    /**
+     * @brief Wait until every submitted task has finished.
+     *
+     * The calling thread helps to run queued tasks while it waits. If any task threw an exception,
+     * the first exception is rethrown. This waits for the tasks of every caller of the pool, so
+     * code that shares a pool should wait for its own tasks with a TaskGroup instead. An exception
+     * is thrown if this is called from a task of the pool, because the pool would wait for that
+     * task too.
+     */
+    void Wait();
+  };
+
+  /**
+   * @brief A batch of tasks that run on a ThreadPool and can be waited for on their own.
+   *
+   * Waiting for a group only waits for the tasks of the group, and only rethrows their exceptions,
+   * so many callers can share one ThreadPool. A group may be waited for from within a task of the
+   * same pool, in which case the waiting thread runs other tasks of the pool until the group is
+   * done.
+   *
+   */
+  class TaskGroup
+  {
+   private:
+    mpbp::ThreadPool& thread_pool;
+    std::atomic<std::size_t> pending_count = 0;
+    std::mutex exception_mutex = std::mutex();
+    std::exception_ptr exception = nullptr;
+
+   public:
+    /**
+     * @brief Construct a new TaskGroup that runs its tasks on a ThreadPool.
+     *
+     * @param thread_pool The ThreadPool to run the tasks on.
+     */
+    explicit TaskGroup(mpbp::ThreadPool& thread_pool) noexcept;
+    TaskGroup(const mpbp::TaskGroup&) = delete;
+    mpbp::TaskGroup& operator=(const mpbp::TaskGroup&) = delete;
+    /**
+     * @brief Add a task of the group to the ThreadPool.
+     *
+     * This may be called from within a running task of the group.
+     *
+     * @param task The task to run.
+     */
+    void Submit(std::function<void()> task);
+    /**
+     * @brief Wait until every task of the group has finished.
+     *
+     * The calling thread helps to run queued tasks of the pool while it waits. If any task of the
+     * group threw an exception, the first exception is rethrown. The group must be waited for
+     * before it is destroyed.
+     */
+    void Wait();
+  };
+}  // namespace mpbp
+
+#endif
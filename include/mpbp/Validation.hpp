@@ -0,0 +1,119 @@
+// SPDX-FileCopyrightText: 2022 Daniel Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef MPBP_VALIDATION_HPP
+#define MPBP_VALIDATION_HPP
+
+#include <cstddef>
+#include <mpbp/Packer.hpp>
+#include <mpbp/Rect.hpp>
+#include <mpbp/ThreadPool.hpp>
+#include <span>
+#include <vector>
+
+namespace mpbp
+{
+  /**
+   * @brief A report of the problems found in the placements of a span of Rect.
+   *
+   * Use mpbp::Validate() to create one.
+   *
+   */
+  class Validation
+  {
+   private:
+    std::size_t unplaced_count = 0;
+    std::size_t out_of_bounds_count = 0;
+    std::size_t overlap_count = 0;
+    std::size_t shared_count = 0;
+    std::vector<std::size_t> invalid_indices = std::vector<std::size_t>();
+
+   public:
+    /**
+     * @brief Construct a new Validation with default values.
+     *
+     * A Validation created with this constructor has no problems.
+     */
+    Validation() noexcept = default;
+    /**
+     * @brief Construct a new Validation object from the problems found.
+     *
+     * @param unplaced_count The amount of Rect that are not placed.
+     * @param out_of_bounds_count The amount of Rect that are not within their page.
+     * @param overlap_count The amount of Rect that overlap another Rect.
+     * @param shared_count The amount of Rect that share the placement of another Rect of the same size.
+     * @param invalid_indices The indices of the Rect that are unplaced, out of bounds, or overlap.
+     */
+    Validation(std::size_t unplaced_count, std::size_t out_of_bounds_count,
+               std::size_t overlap_count, std::size_t shared_count,
+               std::vector<std::size_t> invalid_indices) noexcept;
+    /**
+     * @brief Get if every Rect is placed within its page without overlapping another Rect.
+     *
+     * Rect that share a placement are not counted as overlapping, because Packer places duplicate
+     * Rect that way when packing with content hashes.
+     *
+     * @return If the placements are valid.
+     */
+    bool GetIsValid() const noexcept;
+    /**
+     * @brief Get the amount of Rect that are not placed.
+     *
+     * @return The amount of unplaced Rect.
+     */
+    std::size_t GetUnplacedCount() const noexcept;
+    /**
+     * @brief Get the amount of Rect that are placed on a page that does not exist or reach outside of their page.
+     *
+     * @return The amount of out of bounds Rect.
+     */
+    std::size_t GetOutOfBoundsCount() const noexcept;
+    /**
+     * @brief Get the amount of Rect that overlap a Rect that was checked before them.
+     *
+     * @return The amount of overlapping Rect.
+     */
+    std::size_t GetOverlapCount() const noexcept;
+    /**
+     * @brief Get the amount of Rect that have the same size and placement as another Rect.
+     *
+     * @return The amount of Rect that share a placement.
+     */
+    std::size_t GetSharedCount() const noexcept;
+    /**
+     * @brief Get the indices of the invalid Rect in the validated span.
+     *
+     * @return An immutable reference to the indices in ascending order.
+     */
+    const std::vector<std::size_t>& GetInvalidIndices() const noexcept;
+  };
+
+  /**
+   * @brief Check the placements of a span of packed Rect using a temporary ThreadPool.
+   *
+   * @param rects The span of packed Rect.
+   * @param packer The Packer that packed the Rect.
+   *
+   * @return The problems found.
+   */
+  mpbp::Validation Validate(const std::span<const mpbp::Rect> rects, const mpbp::Packer& packer);
+
+  /**
+   * @brief Check the placements of a span of packed Rect using the threads of a ThreadPool.
+   *
+   * Each page is checked by a separate task with a sweep line over the x axis that keeps the
+   * vertical extents of the Rect crossing it in an ordered set, so the check takes O(n log n) time.
+   *
+   * @param rects The span of packed Rect.
+   * @param packer The Packer that packed the Rect.
+   * @param thread_pool The ThreadPool to run the checks on. It may be shared with other work, and
+   * this may be called from one of its tasks.
+   *
+   * @return The problems found.
+   */
+  mpbp::Validation Validate(const std::span<const mpbp::Rect> rects, const mpbp::Packer& packer,
+                            mpbp::ThreadPool& thread_pool);
+}  // namespace mpbp
+
+#endif
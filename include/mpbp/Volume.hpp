@@ -0,0 +1,191 @@
+// SPDX-FileCopyrightText: 2022 Daniel Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef MPBP_VOLUME_HPP
+#define MPBP_VOLUME_HPP
+
+#include <algorithm>
+#include <compare>
+#include <mpbp/Box.hpp>
+
+namespace mpbp
+{
+  /**
+   * @brief An axis-alligned box shaped space between packed Box in a set of bin pages.
+   *
+   * This class is the 3D counterpart of Space. It is used internally by BoxPacker to keep track of the free space between Box. It has little use to end users in most situations.
+   *
+   */
+  class Volume
+  {
+   private:
+    int max_dimension = 0;
+    int left_x = 0;
+    int top_y = 0;
+    int front_z = 0;
+    int page = 0;
+    int width = 0;
+    int height = 0;
+    int depth = 0;
+
+   public:
+    /**
+     * @brief Construct a new Volume with default values.
+     *
+     * The position coordinates, page, width, height and depth are all set to 0.
+     */
+    constexpr Volume() noexcept = default;
+    /**
+     * @brief Construct a new Volume object at the given coordinates and page with the given width, height and depth.
+     *
+     * @param left_x The x coordinate position of the front top left corner of the Volume.
+     * @param top_y The y coordinate position of the front top left corner of the Volume.
+     * @param front_z The z coordinate position of the front top left corner of the Volume.
+     * @param page The bin page that this Volume exists on.
+     * @param width The width of the Volume.
+     * @param height The height of the Volume.
+     * @param depth The depth of the Volume.
+     */
+    constexpr Volume(int left_x, int top_y, int front_z, int page, int width, int height,
+                     int depth) noexcept;
+    /**
+     * @brief Get the x coordinate of the left side of the Volume.
+     *
+     * @return The x coordinate of the left side of the Volume.
+     */
+    constexpr int GetLeftX() const noexcept;
+    /**
+     * @brief Get the y coordinate of the top side of the Volume.
+     *
+     * @return The y coordinate of the top side of the Volume.
+     */
+    constexpr int GetTopY() const noexcept;
+    /**
+     * @brief Get the z coordinate of the front side of the Volume.
+     *
+     * @return The z coordinate of the front side of the Volume.
+     */
+    constexpr int GetFrontZ() const noexcept;
+    /**
+     * @brief Get the bin page that the Volume exists on.
+     *
+     * @return The index of the bin page this Volume exists on.
+     */
+    constexpr int GetPage() const noexcept;
+    /**
+     * @brief Get the width of the Volume.
+     *
+     * @return The width of the Volume.
+     */
+    constexpr int GetWidth() const noexcept;
+    /**
+     * @brief Get the height of the Volume.
+     *
+     * @return The height of the Volume.
+     */
+    constexpr int GetHeight() const noexcept;
+    /**
+     * @brief Get the depth of the Volume.
+     *
+     * @return The depth of the Volume.
+     */
+    constexpr int GetDepth() const noexcept;
+    /**
+     * @brief Get the size of the largest dimension of this Volume.
+     *
+     * This is the maximum value between the width, the height and the depth of the Volume.
+     *
+     * @return The size of the largest dimension.
+     */
+    constexpr int GetMaxDimension() const noexcept;
+    /**
+     * @brief Get if this Volume is degenerate.
+     *
+     * A degenerate Volume has a width, height or depth that is less than or equal to 0.
+     *
+     * @return If the Volume is degenerate.
+     */
+    constexpr bool GetIsDegenerate() const noexcept;
+    /**
+     * @brief Compare this Volume with a different Volume.
+     *
+     * This comparison compares the max dimensions of each Volume. It use used internally by the pack algorithm.
+     *
+     * @return The strong ordering of the Volume.
+     */
+    constexpr std::strong_ordering operator<=>(const mpbp::Volume& other) const noexcept;
+    /**
+     * @brief Get if a Box fits within the Volume.
+     *
+     * @param box The Box to test fitting into the Volume.
+     *
+     * @return If the Box fits within the Volume.
+     */
+    constexpr bool Fits(const mpbp::Box& box) const noexcept;
+    /**
+     * @brief Get if a box of a given size fits within the Volume.
+     *
+     * @param width The width of the box.
+     * @param height The height of the box.
+     * @param depth The depth of the box.
+     *
+     * @return If the box fits within the Volume.
+     */
+    constexpr bool Fits(int width, int height, int depth) const noexcept;
+  };
+}  // namespace mpbp
+
+// The members of Volume are defined here rather than in a source file, so that the packing loops
+// can inline them.
+
+constexpr mpbp::Volume::Volume(int left_x, int top_y, int front_z, int page, int width,
+                               int height, int depth) noexcept
+    : max_dimension(std::max({width, height, depth})),
+      left_x(left_x),
+      top_y(top_y),
+      front_z(front_z),
+      page(page),
+      width(width),
+      height(height),
+      depth(depth)
+{
+}
+
+constexpr int mpbp::Volume::GetLeftX() const noexcept { return this->left_x; }
+
+constexpr int mpbp::Volume::GetTopY() const noexcept { return this->top_y; }
+
+constexpr int mpbp::Volume::GetFrontZ() const noexcept { return this->front_z; }
+
+constexpr int mpbp::Volume::GetPage() const noexcept { return this->page; }
+
+constexpr int mpbp::Volume::GetWidth() const noexcept { return this->width; }
+
+constexpr int mpbp::Volume::GetHeight() const noexcept { return this->height; }
+
+constexpr int mpbp::Volume::GetDepth() const noexcept { return this->depth; }
+
+constexpr int mpbp::Volume::GetMaxDimension() const noexcept { return this->max_dimension; }
+
+constexpr bool mpbp::Volume::GetIsDegenerate() const noexcept
+{
+  return this->width <= 0 || this->height <= 0 || this->depth <= 0;
+}
+
+constexpr std::strong_ordering mpbp::Volume::operator<=>(const mpbp::Volume& other) const noexcept
+{
+  return this->max_dimension <=> other.max_dimension;
+}
+
+constexpr bool mpbp::Volume::Fits(const mpbp::Box& box) const noexcept
+{
+  return this->Fits(box.GetWidth(), box.GetHeight(), box.GetDepth());
+}
+
+constexpr bool mpbp::Volume::Fits(int width, int height, int depth) const noexcept
+{
+  return this->width >= width && this->height >= height && this->depth >= depth;
+}
+
+#endif
@@ -5,8 +5,32 @@
 #ifndef MPBP_HPP
 #define MPBP_HPP
 
+#include <mpbp/Bound.hpp>
+#include <mpbp/Box.hpp>
+#include <mpbp/BoxPacker.hpp>
+#include <mpbp/Compositor.hpp>
+#include <mpbp/Fit.hpp>
+#include <mpbp/Image.hpp>
+#include <mpbp/IncrementalPacker.hpp>
+#include <mpbp/Move.hpp>
+#include <mpbp/configuration.h>
+#include <mpbp/PackCache.hpp>
+#include <mpbp/PackJob.hpp>
 #include <mpbp/Packer.hpp>
+#include <mpbp/PageStream.hpp>
+#include <mpbp/PageSize.hpp>
 #include <mpbp/Rect.hpp>
+#include <mpbp/Solver.hpp>
 #include <mpbp/Space.hpp>
+#include <mpbp/StreamPacker.hpp>
+#include <mpbp/ThreadPool.hpp>
+#include <mpbp/Validation.hpp>
+#include <mpbp/Volume.hpp>
+
+#ifdef MPBP_BUILD_DAEMON
+#include <mpbp/PackChannel.hpp>
+#include <mpbp/PackClient.hpp>
+#include <mpbp/PackServer.hpp>
+#endif
 
 #endif
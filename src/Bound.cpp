@@ -0,0 +1,194 @@
+// SPDX-FileCopyrightText: 2022 Daniel Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+#include <algorithm>
+#include <mpbp/Bound.hpp>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace
+{
+  // Get the dimensions of a page that every page of a Packer fits within.
+  std::pair<int, int> boundingPageSize(const mpbp::Packer& packer)
+  {
+    if (packer.GetPageSizes().empty())
+    {
+      return std::make_pair(packer.GetMaxWidth(), packer.GetMaxHeight());
+    }
+    auto size = std::make_pair(0, 0);
+    for (const auto& page_size : packer.GetPageSizes())
+    {
+      size.first = std::max(size.first, page_size.GetWidth());
+      size.second = std::max(size.second, page_size.GetHeight());
+    }
+    return size;
+  }
+
+  long long divideCeil(long long numerator, long long denominator)
+  {
+    return (numerator + denominator - 1) / denominator;
+  }
+
+  // Evaluate the L2 bound for every useful split p of the swept axis while the split of the fixed
+  // axis stays at 1. Each item is (swept size, fixed size). Only the sizes of items that fit within
+  // half of the page can change the bound as p grows, so those sizes are the only candidates.
+  int sweepL2Bound(const std::vector<std::pair<int, int>>& items, int max_swept, int max_fixed)
+  {
+    const long long page_area = static_cast<long long>(max_swept) * max_fixed;
+    const int fixed_split = 1;
+    int big_count = 0;
+    long long big_area = 0;
+    // Items that can not share a page with any other large item for some p, ordered by swept size.
+    std::vector<std::pair<int, long long>> full_items;
+    // Items small enough to fit beside large items, ordered by swept size.
+    std::vector<std::pair<int, long long>> small_items;
+    for (const auto& [swept, fixed] : items)
+    {
+      const long long area = static_cast<long long>(swept) * fixed;
+      if (swept * 2 > max_swept && fixed * 2 > max_fixed)
+      {
+        big_count++;
+        big_area += area;
+        if (fixed > max_fixed - fixed_split)
+        {
+          full_items.emplace_back(swept, area);
+        }
+      }
+      else if (swept * 2 <= max_swept && fixed * 2 <= max_fixed && fixed >= fixed_split)
+      {
+        small_items.emplace_back(swept, area);
+      }
+    }
+    std::sort(full_items.begin(), full_items.end());
+    std::sort(small_items.begin(), small_items.end());
+    // Suffix sums of area so that the area of all items at or after an index is O(1).
+    auto suffix_areas = [](const std::vector<std::pair<int, long long>>& sorted)
+    {
+      std::vector<long long> sums(sorted.size() + 1, 0);
+      for (std::size_t i = sorted.size(); i > 0; i--)
+      {
+        sums[i - 1] = sums[i] + sorted[i - 1].second;
+      }
+      return sums;
+    };
+    const auto full_suffix = suffix_areas(full_items);
+    const auto small_suffix = suffix_areas(small_items);
+    auto first_at_least = [](const std::vector<std::pair<int, long long>>& sorted, int size)
+    {
+      return static_cast<std::size_t>(
+          std::lower_bound(sorted.begin(), sorted.end(), size,
+                           [](const std::pair<int, long long>& item, int value)
+                           { return item.first < value; }) -
+          sorted.begin());
+    };
+    int best = big_count;
+    auto evaluate = [&](int split)
+    {
+      const auto full_i = first_at_least(full_items, max_swept - split + 1);
+      const auto full_count = static_cast<long long>(full_items.size() - full_i);
+      const auto full_area = full_suffix[full_i];
+      const auto small_area = small_suffix[first_at_least(small_items, split)];
+      // Area of small items that does not fit in the leftover area of pages holding a large item
+      // which is not full.
+      const auto overflow =
+          small_area - (page_area * (big_count - full_count) - (big_area - full_area));
+      const auto extra = overflow > 0 ? divideCeil(overflow, page_area) : 0;
+      best = std::max(best, static_cast<int>(big_count + extra));
+    };
+    const int max_split = max_swept / 2;
+    if (max_split < 1) return best;
+    for (std::size_t i = 0; i < small_items.size(); i++)
+    {
+      if (i > 0 && small_items[i].first == small_items[i - 1].first) continue;
+      evaluate(small_items[i].first);
+    }
+    evaluate(max_split);
+    return best;
+  }
+}  // namespace
+
+mpbp::Bound::Bound(int area_bound, int l2_bound) noexcept
+    : area_bound(area_bound), l2_bound(l2_bound)
+{
+}
+
+int mpbp::Bound::GetAreaBound() const noexcept { return this->area_bound; }
+
+int mpbp::Bound::GetL2Bound() const noexcept { return this->l2_bound; }
+
+int mpbp::Bound::GetPageCount() const noexcept { return std::max(this->area_bound, this->l2_bound); }
+
+mpbp::Bound mpbp::LowerBound(const std::span<const mpbp::Rect> rects, int max_width,
+                             int max_height)
+{
+  if (max_width <= 0 || max_height <= 0)
+  {
+    throw std::runtime_error("invalid max page dimensions");
+  }
+  if (rects.size() == 0) return mpbp::Bound();
+  std::vector<std::pair<int, int>> widths_first;
+  std::vector<std::pair<int, int>> heights_first;
+  widths_first.reserve(rects.size());
+  heights_first.reserve(rects.size());
+  long long total_area = 0;
+  for (const auto& rect : rects)
+  {
+    if (rect.GetIsDegenerate())
+    {
+      throw std::runtime_error("one or more rects are degenerate");
+    }
+    if (rect.GetWidth() > max_width || rect.GetHeight() > max_height)
+    {
+      throw std::runtime_error("one or more rects do not fit in bin");
+    }
+    total_area += static_cast<long long>(rect.GetWidth()) * rect.GetHeight();
+    widths_first.emplace_back(rect.GetWidth(), rect.GetHeight());
+    heights_first.emplace_back(rect.GetHeight(), rect.GetWidth());
+  }
+  const auto page_area = static_cast<long long>(max_width) * max_height;
+  const auto area_bound = static_cast<int>(divideCeil(total_area, page_area));
+  const auto l2_bound = std::max(sweepL2Bound(widths_first, max_width, max_height),
+                                 sweepL2Bound(heights_first, max_height, max_width));
+  return mpbp::Bound(area_bound, l2_bound);
+}
+
+mpbp::Efficiency::Efficiency(const mpbp::Packer& packer, const std::span<const mpbp::Rect> rects)
+    : page_count(packer.GetPageCount()), page_area(packer.GetPageArea())
+{
+  const auto [max_width, max_height] = boundingPageSize(packer);
+  this->bound = mpbp::LowerBound(rects, max_width, max_height);
+  this->max_page_area = static_cast<long long>(max_width) * max_height;
+  for (const auto& rect : rects)
+  {
+    this->rect_area += static_cast<long long>(rect.GetWidth()) * rect.GetHeight();
+  }
+}
+
+const mpbp::Bound& mpbp::Efficiency::GetBound() const noexcept { return this->bound; }
+
+int mpbp::Efficiency::GetPageCount() const noexcept { return this->page_count; }
+
+int mpbp::Efficiency::GetPageGap() const noexcept
+{
+  return this->page_count - this->bound.GetPageCount();
+}
+
+double mpbp::Efficiency::GetFillRatio() const noexcept
+{
+  if (this->page_area == 0) return 0.0;
+  return static_cast<double>(this->rect_area) / static_cast<double>(this->page_area);
+}
+
+double mpbp::Efficiency::GetBoundFillRatio() const noexcept
+{
+  const auto bound_area = this->max_page_area * this->bound.GetPageCount();
+  if (bound_area == 0) return 0.0;
+  return static_cast<double>(this->rect_area) / static_cast<double>(bound_area);
+}
+
+bool mpbp::Efficiency::GetIsOptimal() const noexcept
+{
+  return this->page_count <= this->bound.GetPageCount();
+}
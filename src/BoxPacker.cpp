@@ -0,0 +1,318 @@
+// SPDX-FileCopyrightText: 2022 Daniel Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+#include <algorithm>
+#include <bit>
+#include <functional>
+#include <mpbp/BoxPacker.hpp>
+#include <stdexcept>
+
+namespace
+{
+  // The x, y and z components of a position or size, so that the three axes can be handled by the
+  // same code.
+  using Extent = std::array<int, 3>;
+
+  Extent boxSize(const mpbp::Box& box) noexcept
+  {
+    return {box.GetWidth(), box.GetHeight(), box.GetDepth()};
+  }
+
+  // The power of two at or below a positive size, as an exponent.
+  int sizeLevel(int size) noexcept
+  {
+    return std::bit_width(static_cast<unsigned int>(size)) - 1;
+  }
+}  // namespace
+
+mpbp::BoxPacker::BoxPacker(int max_width, int max_height, int max_depth) noexcept
+    : max_width(max_width), max_height(max_height), max_depth(max_depth)
+{
+}
+
+void mpbp::BoxPacker::Clear() noexcept
+{
+  this->volumes.clear();
+  for (auto& bucket : this->volume_buckets) bucket.clear();
+  this->volume_bucket_slots.clear();
+  this->page_count = 0;
+  this->width = 0;
+  this->height = 0;
+  this->depth = 0;
+  this->top_bin_width = 0;
+  this->top_bin_height = 0;
+  this->top_bin_depth = 0;
+}
+
+void mpbp::BoxPacker::SetMaxPageSize(int max_width, int max_height, int max_depth)
+{
+  this->Clear();
+  this->volume_buckets.clear();
+  this->max_width = max_width;
+  this->max_height = max_height;
+  this->max_depth = max_depth;
+}
+
+const std::vector<mpbp::Volume>& mpbp::BoxPacker::GetVolumes() const noexcept
+{
+  return this->volumes;
+}
+
+int mpbp::BoxPacker::GetPageCount() const noexcept { return this->page_count; }
+
+int mpbp::BoxPacker::GetWidth() const noexcept { return this->width; }
+
+int mpbp::BoxPacker::GetHeight() const noexcept { return this->height; }
+
+int mpbp::BoxPacker::GetDepth() const noexcept { return this->depth; }
+
+long long mpbp::BoxPacker::GetPageVolume() const noexcept
+{
+  return static_cast<long long>(this->page_count) * this->width * this->height * this->depth;
+}
+
+int mpbp::BoxPacker::GetMaxWidth() const noexcept { return this->max_width; }
+
+int mpbp::BoxPacker::GetMaxHeight() const noexcept { return this->max_height; }
+
+int mpbp::BoxPacker::GetMaxDepth() const noexcept { return this->max_depth; }
+
+int mpbp::BoxPacker::GetTopBinWidth() const noexcept { return this->top_bin_width; }
+
+int mpbp::BoxPacker::GetTopBinHeight() const noexcept { return this->top_bin_height; }
+
+int mpbp::BoxPacker::GetTopBinDepth() const noexcept { return this->top_bin_depth; }
+
+void mpbp::BoxPacker::Pack(const std::span<mpbp::Box> boxes)
+{
+  if (boxes.size() == 0) return;
+  if (this->max_width <= 0 || this->max_height <= 0 || this->max_depth <= 0)
+  {
+    throw std::runtime_error("invalid max page dimensions");
+  }
+  for (const auto& box : boxes)
+  {
+    if (box.GetIsDegenerate())
+    {
+      throw std::runtime_error("one or more boxes are degenerate");
+    }
+    if (box.GetWidth() > this->max_width || box.GetHeight() > this->max_height ||
+        box.GetDepth() > this->max_depth)
+    {
+      throw std::runtime_error("one or more boxes do not fit in bin");
+    }
+  }
+  std::sort(boxes.begin(), boxes.end(), std::greater());
+  if (this->volume_buckets.empty())
+  {
+    this->bucket_levels = {sizeLevel(this->max_width) + 1, sizeLevel(this->max_height) + 1,
+                           sizeLevel(this->max_depth) + 1};
+    this->volume_buckets.resize(static_cast<std::size_t>(this->bucket_levels[0]) *
+                                this->bucket_levels[1] * this->bucket_levels[2]);
+  }
+  // Each placement removes one volume and adds at most three.
+  this->volumes.reserve(this->volumes.size() + boxes.size() * 2);
+  this->volume_bucket_slots.reserve(this->volumes.capacity());
+  std::size_t box_i = 0;
+  if (this->page_count == 0)
+  {
+    this->placeNewPage(boxes[box_i++]);
+  }
+  for (; box_i < boxes.size(); box_i++)
+  {
+    auto& box = boxes[box_i];
+    if (!this->tryPlaceVolume(box) && !this->tryPlaceExpandBin(box))
+    {
+      this->volumeLeftoverPage();
+      this->placeNewPage(box);
+    }
+  }
+}
+
+std::size_t mpbp::BoxPacker::getBucketI(int width, int height, int depth) const noexcept
+{
+  return (static_cast<std::size_t>(sizeLevel(width)) * this->bucket_levels[1] +
+          sizeLevel(height)) *
+             this->bucket_levels[2] +
+         sizeLevel(depth);
+}
+
+void mpbp::BoxPacker::addVolume(const std::array<int, 3>& origin, int page,
+                                const std::array<int, 3>& size)
+{
+  if (size[0] <= 0 || size[1] <= 0 || size[2] <= 0) return;
+  auto& bucket = this->volume_buckets[this->getBucketI(size[0], size[1], size[2])];
+  this->volume_bucket_slots.push_back(bucket.size());
+  bucket.push_back(this->volumes.size());
+  this->volumes.emplace_back(origin[0], origin[1], origin[2], page, size[0], size[1], size[2]);
+}
+
+void mpbp::BoxPacker::eraseVolume(std::size_t volume_i)
+{
+  // Both the volume and its bucket entry are erased by moving the last element into their place,
+  // so the index of the moved volume and the slot of the moved bucket entry are fixed up.
+  const auto& volume = this->volumes[volume_i];
+  auto& bucket = this->volume_buckets[this->getBucketI(volume.GetWidth(), volume.GetHeight(),
+                                                       volume.GetDepth())];
+  const auto slot = this->volume_bucket_slots[volume_i];
+  bucket[slot] = bucket.back();
+  this->volume_bucket_slots[bucket[slot]] = slot;
+  bucket.pop_back();
+  const auto last_i = this->volumes.size() - 1;
+  if (volume_i != last_i)
+  {
+    const auto& last = this->volumes[last_i];
+    this->volume_buckets[this->getBucketI(last.GetWidth(), last.GetHeight(), last.GetDepth())]
+                        [this->volume_bucket_slots[last_i]] = volume_i;
+    this->volumes[volume_i] = last;
+    this->volume_bucket_slots[volume_i] = this->volume_bucket_slots[last_i];
+  }
+  this->volumes.pop_back();
+  this->volume_bucket_slots.pop_back();
+}
+
+void mpbp::BoxPacker::splitVolume(const std::array<int, 3>& origin, int page,
+                                  const std::array<int, 3>& size,
+                                  const std::array<int, 3>& box_size)
+{
+  // Split the leftover of the volume on each axis, from the axis with the most leftover to the axis
+  // with the least. The leftover on the first axis reaches across the whole volume, and the
+  // leftover on each later axis only reaches across the box on the axes that were split before it.
+  // This is the opposite order of the split of a Space, because in three dimensions giving the
+  // largest leftover the whole volume keeps far fewer thin volumes that no later box fits.
+  std::array<int, 3> axes = {0, 1, 2};
+  std::stable_sort(axes.begin(), axes.end(), [&](int a, int b)
+                   { return size[a] - box_size[a] > size[b] - box_size[b]; });
+  auto leftover_size = size;
+  for (const auto axis : axes)
+  {
+    auto leftover_origin = origin;
+    leftover_origin[axis] += box_size[axis];
+    auto axis_leftover_size = leftover_size;
+    axis_leftover_size[axis] = size[axis] - box_size[axis];
+    this->addVolume(leftover_origin, page, axis_leftover_size);
+    leftover_size[axis] = box_size[axis];
+  }
+}
+
+bool mpbp::BoxPacker::tryPlaceVolume(mpbp::Box& box)
+{
+  // Only the buckets that are at or above the levels of the box on every axis can hold a volume
+  // that fits it, and every volume in a bucket that is above the box on every axis fits it. The
+  // buckets are searched from the smallest sum of levels to the largest, so that small volumes are
+  // used before large ones.
+  const Extent level = {sizeLevel(box.GetWidth()), sizeLevel(box.GetHeight()),
+                        sizeLevel(box.GetDepth())};
+  const auto& levels = this->bucket_levels;
+  const auto max_level_sum = levels[0] + levels[1] + levels[2] - 3;
+  for (int level_sum = level[0] + level[1] + level[2]; level_sum <= max_level_sum; level_sum++)
+  {
+    for (int x_level = level[0]; x_level < levels[0]; x_level++)
+    {
+      for (int y_level = level[1]; y_level < levels[1]; y_level++)
+      {
+        const auto z_level = level_sum - x_level - y_level;
+        if (z_level < level[2]) break;
+        if (z_level >= levels[2]) continue;
+        const auto& bucket =
+            this->volume_buckets[(static_cast<std::size_t>(x_level) * levels[1] + y_level) *
+                                     levels[2] +
+                                 z_level];
+        const auto volume_i_it =
+            std::find_if(bucket.begin(), bucket.end(), [&](std::size_t volume_i)
+                         { return this->volumes[volume_i].Fits(box); });
+        if (volume_i_it == bucket.end()) continue;
+        const auto volume = this->volumes[*volume_i_it];
+        this->eraseVolume(*volume_i_it);
+        box.Place(volume.GetLeftX(), volume.GetTopY(), volume.GetFrontZ(), volume.GetPage());
+        this->splitVolume({volume.GetLeftX(), volume.GetTopY(), volume.GetFrontZ()},
+                          volume.GetPage(), {volume.GetWidth(), volume.GetHeight(),
+                          volume.GetDepth()}, boxSize(box));
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+bool mpbp::BoxPacker::tryPlaceExpandBin(mpbp::Box& box)
+{
+  Extent bin = {this->top_bin_width, this->top_bin_height, this->top_bin_depth};
+  const Extent max = {this->max_width, this->max_height, this->max_depth};
+  const auto box_size = boxSize(box);
+  // Grow the bin along its shortest axis that has room for the box, so that it stays close to a
+  // cube. Like the top bin of a Packer, ties grow the bin down first.
+  std::array<int, 3> axes = {1, 0, 2};
+  std::stable_sort(axes.begin(), axes.end(), [&](int a, int b) { return bin[a] < bin[b]; });
+  const auto axis_it = std::find_if(axes.begin(), axes.end(), [&](int axis)
+                                    { return bin[axis] + box_size[axis] <= max[axis]; });
+  if (axis_it == axes.end()) return false;
+  const auto axis = *axis_it;
+  Extent position = {0, 0, 0};
+  position[axis] = bin[axis];
+  box.Place(position[0], position[1], position[2], this->getTopPageI());
+  // If the box is larger than the bin on another axis, the bin grows to fit it and the part of the
+  // growth beside the old bin is left free.
+  for (int other_axis = 0; other_axis < 3; other_axis++)
+  {
+    if (other_axis == axis || box_size[other_axis] <= bin[other_axis]) continue;
+    Extent growth_origin = {0, 0, 0};
+    growth_origin[other_axis] = bin[other_axis];
+    auto growth_size = bin;
+    growth_size[other_axis] = box_size[other_axis] - bin[other_axis];
+    this->addVolume(growth_origin, this->getTopPageI(), growth_size);
+    bin[other_axis] = box_size[other_axis];
+  }
+  // The slab of the bin that the box was placed in is split around the box like a volume.
+  auto slab_size = bin;
+  slab_size[axis] = box_size[axis];
+  this->splitVolume(position, this->getTopPageI(), slab_size, box_size);
+  bin[axis] += box_size[axis];
+  this->top_bin_width = bin[0];
+  this->top_bin_height = bin[1];
+  this->top_bin_depth = bin[2];
+  this->updateSize();
+  return true;
+}
+
+void mpbp::BoxPacker::volumeLeftoverPage()
+{
+  const auto page = this->getTopPageI();
+  this->addVolume({this->top_bin_width, 0, 0}, page,
+                  {this->max_width - this->top_bin_width, this->top_bin_height,
+                   this->top_bin_depth});
+  this->addVolume({0, this->top_bin_height, 0}, page,
+                  {this->max_width, this->max_height - this->top_bin_height, this->top_bin_depth});
+  this->addVolume({0, 0, this->top_bin_depth}, page,
+                  {this->max_width, this->max_height, this->max_depth - this->top_bin_depth});
+}
+
+void mpbp::BoxPacker::placeNewPage(mpbp::Box& box)
+{
+  this->page_count++;
+  box.Place(0, 0, 0, this->getTopPageI());
+  this->top_bin_width = box.GetWidth();
+  this->top_bin_height = box.GetHeight();
+  this->top_bin_depth = box.GetDepth();
+  this->updateSize();
+}
+
+void mpbp::BoxPacker::updateSize() noexcept
+{
+  // A single page only takes up the bounding box of its boxes.
+  if (this->page_count == 1)
+  {
+    this->width = this->top_bin_width;
+    this->height = this->top_bin_height;
+    this->depth = this->top_bin_depth;
+  }
+  else
+  {
+    this->width = this->max_width;
+    this->height = this->max_height;
+    this->depth = this->max_depth;
+  }
+}
+
+int mpbp::BoxPacker::getTopPageI() const noexcept { return this->page_count - 1; }
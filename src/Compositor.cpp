@@ -0,0 +1,140 @@
+// SPDX-FileCopyrightText: 2022 Daniel Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+#include <algorithm>
+#include <cstring>
+#include <mpbp/Compositor.hpp>
+#include <stdexcept>
+
+mpbp::Compositor::Compositor(mpbp::PixelFormat format) noexcept : format(format) {}
+
+void mpbp::Compositor::SetBandHeight(int band_height)
+{
+  if (band_height <= 0)
+  {
+    throw std::runtime_error("invalid band height");
+  }
+  this->band_height = band_height;
+}
+
+int mpbp::Compositor::GetBandHeight() const noexcept { return this->band_height; }
+
+mpbp::PixelFormat mpbp::Compositor::GetFormat() const noexcept { return this->format; }
+
+void mpbp::Compositor::Compose(const mpbp::Packer& packer, const std::span<const mpbp::Rect> rects,
+                               const std::span<const mpbp::Image> images)
+{
+  mpbp::ThreadPool thread_pool;
+  this->Compose(packer, rects, images, thread_pool);
+}
+
+void mpbp::Compositor::Compose(const mpbp::Packer& packer, const std::span<const mpbp::Rect> rects,
+                               const std::span<const mpbp::Image> images,
+                               mpbp::ThreadPool& thread_pool)
+{
+  const auto page_count = packer.GetPageCount();
+  std::vector<int> page_widths(page_count);
+  std::vector<int> page_heights(page_count);
+  // The index of the first band of each page in the flat list of bands of all pages.
+  std::vector<std::size_t> first_bands(page_count + 1, 0);
+  for (int page = 0; page < page_count; page++)
+  {
+    page_widths[page] = packer.GetPageWidth(page);
+    page_heights[page] = packer.GetPageHeight(page);
+    const auto band_count = (page_heights[page] + this->band_height - 1) / this->band_height;
+    first_bands[page + 1] = first_bands[page] + band_count;
+  }
+  for (const auto& rect : rects)
+  {
+    const auto page = rect.GetPage();
+    if (page < 0 || page >= page_count || rect.GetLeftX() < 0 || rect.GetTopY() < 0 ||
+        rect.GetRightX() >= page_widths[page] || rect.GetBottomY() >= page_heights[page])
+    {
+      throw std::runtime_error("one or more rects are not placed within a page");
+    }
+    if (rect.GetIdentifier() >= images.size())
+    {
+      throw std::runtime_error("one or more rects have no image");
+    }
+    const auto& image = images[rect.GetIdentifier()];
+    if (image.GetWidth() != rect.GetWidth() || image.GetHeight() != rect.GetHeight() ||
+        image.GetFormat() != this->format || image.GetData() == nullptr)
+    {
+      throw std::runtime_error("one or more images do not match their rect");
+    }
+  }
+  // Find the rects that cross each band, so each band only looks at the rects it contains.
+  std::vector<std::vector<const mpbp::Rect*>> bands(first_bands.back());
+  for (const auto& rect : rects)
+  {
+    const auto first_band = first_bands[rect.GetPage()];
+    for (auto band_i = rect.GetTopY() / this->band_height;
+         band_i <= rect.GetBottomY() / this->band_height; band_i++)
+    {
+      bands[first_band + band_i].push_back(&rect);
+    }
+  }
+  const auto pixel_size = static_cast<std::size_t>(mpbp::GetPixelSize(this->format));
+  this->pages.clear();
+  this->pages.reserve(page_count);
+  for (int page = 0; page < page_count; page++)
+  {
+    // The pages are left uninitialized here so that each band clears its own rows on the thread
+    // that fills them.
+    const auto page_size = static_cast<std::size_t>(page_widths[page]) * page_heights[page];
+    this->pages.emplace_back(new unsigned char[page_size * pixel_size]);
+  }
+  this->page_widths = std::move(page_widths);
+  this->page_heights = std::move(page_heights);
+  mpbp::TaskGroup task_group(thread_pool);
+  for (int page = 0; page < page_count; page++)
+  {
+    for (auto band_i = first_bands[page]; band_i < first_bands[page + 1]; band_i++)
+    {
+      task_group.Submit(
+          [&, page, band_i]()
+          {
+            auto& band = bands[band_i];
+            std::sort(band.begin(), band.end(),
+                      [](const mpbp::Rect* a, const mpbp::Rect* b)
+                      { return a->GetLeftX() < b->GetLeftX(); });
+            const auto stride = static_cast<std::size_t>(this->page_widths[page]) * pixel_size;
+            const auto top_y = static_cast<int>(band_i - first_bands[page]) * this->band_height;
+            const auto bottom_y = std::min(top_y + this->band_height, this->page_heights[page]);
+            auto page_data = this->pages[page].get();
+            for (auto y = top_y; y < bottom_y; y++)
+            {
+              auto row = page_data + static_cast<std::size_t>(y) * stride;
+              std::memset(row, 0, stride);
+              for (const auto rect : band)
+              {
+                if (y < rect->GetTopY() || y > rect->GetBottomY()) continue;
+                const auto& image = images[rect->GetIdentifier()];
+                std::memcpy(row + static_cast<std::size_t>(rect->GetLeftX()) * pixel_size,
+                            image.GetRow(y - rect->GetTopY()),
+                            static_cast<std::size_t>(rect->GetWidth()) * pixel_size);
+              }
+            }
+          });
+    }
+  }
+  task_group.Wait();
+}
+
+int mpbp::Compositor::GetPageCount() const noexcept
+{
+  return static_cast<int>(this->pages.size());
+}
+
+mpbp::Image mpbp::Compositor::GetPage(int page) const
+{
+  if (page < 0 || page >= this->GetPageCount())
+  {
+    throw std::runtime_error("invalid page index");
+  }
+  const auto pixel_size = static_cast<std::size_t>(mpbp::GetPixelSize(this->format));
+  return mpbp::Image(this->pages[page].get(), this->page_widths[page], this->page_heights[page],
+                     static_cast<std::size_t>(this->page_widths[page]) * pixel_size,
+                     this->format);
+}
@@ -0,0 +1,14 @@
+// SPDX-FileCopyrightText: 2022 Daniel Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+#include <mpbp/Fit.hpp>
+
+mpbp::Fit::Fit(bool fits, int new_page_count) noexcept
+    : fits(fits), new_page_count(new_page_count)
+{
+}
+
+bool mpbp::Fit::GetFits() const noexcept { return this->fits; }
+
+int mpbp::Fit::GetNewPageCount() const noexcept { return this->new_page_count; }
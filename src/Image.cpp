@@ -0,0 +1,42 @@
+// SPDX-FileCopyrightText: 2022 Daniel Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+#include <mpbp/Image.hpp>
+
+int mpbp::GetPixelSize(mpbp::PixelFormat format) noexcept
+{
+  switch (format)
+  {
+  case mpbp::PixelFormat::R8:
+    return 1;
+  case mpbp::PixelFormat::RG8:
+    return 2;
+  case mpbp::PixelFormat::RGB8:
+    return 3;
+  case mpbp::PixelFormat::RGBA8:
+    return 4;
+  }
+  return 0;
+}
+
+mpbp::Image::Image(const unsigned char* data, int width, int height, std::size_t stride,
+                   mpbp::PixelFormat format) noexcept
+    : data(data), width(width), height(height), stride(stride), format(format)
+{
+}
+
+const unsigned char* mpbp::Image::GetData() const noexcept { return this->data; }
+
+const unsigned char* mpbp::Image::GetRow(int y) const noexcept
+{
+  return this->data + static_cast<std::size_t>(y) * this->stride;
+}
+
+int mpbp::Image::GetWidth() const noexcept { return this->width; }
+
+int mpbp::Image::GetHeight() const noexcept { return this->height; }
+
+std::size_t mpbp::Image::GetStride() const noexcept { return this->stride; }
+
+mpbp::PixelFormat mpbp::Image::GetFormat() const noexcept { return this->format; }
@@ -0,0 +1,196 @@
+// SPDX-FileCopyrightText: 2022 Daniel Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+#include <algorithm>
+#include <mpbp/IncrementalPacker.hpp>
+#include <stdexcept>
+#include <unordered_set>
+
+namespace
+{
+  long long getArea(const mpbp::Rect& rect) noexcept
+  {
+    return static_cast<long long>(rect.GetWidth()) * rect.GetHeight();
+  }
+}  // namespace
+
+mpbp::IncrementalPacker::IncrementalPacker(int max_width, int max_height) noexcept
+    : packer(max_width, max_height)
+{
+  // Releasing the unused memory of the Space vector after every update would copy every Space.
+  this->packer.SetShrinkToFit(false);
+}
+
+void mpbp::IncrementalPacker::SetMinFillRatio(double min_fill_ratio)
+{
+  if (min_fill_ratio < 0.0 || min_fill_ratio > 1.0)
+  {
+    throw std::runtime_error("invalid fill ratio");
+  }
+  this->min_fill_ratio = min_fill_ratio;
+}
+
+double mpbp::IncrementalPacker::GetMinFillRatio() const noexcept { return this->min_fill_ratio; }
+
+void mpbp::IncrementalPacker::Pack(const std::span<mpbp::Rect> rects)
+{
+  std::unordered_map<unsigned long int, mpbp::Rect> new_rects;
+  new_rects.reserve(rects.size());
+  long long new_rect_area = 0;
+  for (const auto& rect : rects)
+  {
+    if (!new_rects.emplace(rect.GetIdentifier(), rect).second)
+    {
+      throw std::runtime_error("duplicate rect identifier");
+    }
+    new_rect_area += getArea(rect);
+  }
+  this->rects.clear();
+  this->rect_area = 0;
+  this->packer.Clear();
+  this->packer.Pack(rects);
+  for (const auto& rect : rects)
+  {
+    new_rects[rect.GetIdentifier()] = rect;
+  }
+  this->rects = std::move(new_rects);
+  this->rect_area = new_rect_area;
+  this->full_pack_count++;
+  this->full_pack_fill_ratio = this->GetFillRatio();
+}
+
+bool mpbp::IncrementalPacker::Update(const std::span<const unsigned long int> removed_identifiers,
+                                     const std::span<mpbp::Rect> changed_rects)
+{
+  // Check the whole diff before anything changes, so that the manifest is left as it was if it is
+  // invalid.
+  std::unordered_set<unsigned long int> removed_set(removed_identifiers.begin(),
+                                                    removed_identifiers.end());
+  for (const auto identifier : removed_identifiers)
+  {
+    if (this->rects.find(identifier) == this->rects.end())
+    {
+      throw std::runtime_error("unknown rect identifier");
+    }
+  }
+  std::unordered_set<unsigned long int> changed_set;
+  std::vector<mpbp::Rect> packed_rects;
+  for (auto& rect : changed_rects)
+  {
+    if (!changed_set.insert(rect.GetIdentifier()).second || removed_set.count(rect.GetIdentifier()))
+    {
+      throw std::runtime_error("duplicate rect identifier");
+    }
+    const auto old_it = this->rects.find(rect.GetIdentifier());
+    if (old_it != this->rects.end() && old_it->second.GetWidth() == rect.GetWidth() &&
+        old_it->second.GetHeight() == rect.GetHeight())
+    {
+      continue;
+    }
+    packed_rects.push_back(rect);
+  }
+  this->packer.Checkpoint();
+  try
+  {
+    for (const auto identifier : removed_identifiers)
+    {
+      this->packer.Remove(this->rects.find(identifier)->second);
+    }
+    for (const auto& rect : packed_rects)
+    {
+      const auto old_it = this->rects.find(rect.GetIdentifier());
+      if (old_it != this->rects.end()) this->packer.Remove(old_it->second);
+    }
+    this->packer.Pack(packed_rects);
+  }
+  catch (...)
+  {
+    this->packer.Rollback();
+    throw;
+  }
+  this->packer.Commit();
+  for (const auto identifier : removed_identifiers)
+  {
+    const auto rect_it = this->rects.find(identifier);
+    this->rect_area -= getArea(rect_it->second);
+    this->rects.erase(rect_it);
+  }
+  for (const auto& rect : packed_rects)
+  {
+    auto& stored_rect = this->rects[rect.GetIdentifier()];
+    this->rect_area += getArea(rect) - getArea(stored_rect);
+    stored_rect = rect;
+  }
+  auto packed_all = false;
+  if (this->full_pack_fill_ratio == 0.0)
+  {
+    // A manifest that was built by updates only has no full pack to compare with, so the first
+    // update that fills its pages sets the fill ratio that later updates are compared with.
+    this->full_pack_fill_ratio = this->GetFillRatio();
+  }
+  else if (this->GetFillRatio() < this->min_fill_ratio * this->full_pack_fill_ratio)
+  {
+    this->packAll();
+    packed_all = true;
+  }
+  for (auto& rect : changed_rects)
+  {
+    rect = this->rects.find(rect.GetIdentifier())->second;
+  }
+  return packed_all;
+}
+
+const mpbp::Rect& mpbp::IncrementalPacker::GetRect(unsigned long int identifier) const
+{
+  const auto rect_it = this->rects.find(identifier);
+  if (rect_it == this->rects.end())
+  {
+    throw std::runtime_error("unknown rect identifier");
+  }
+  return rect_it->second;
+}
+
+std::vector<mpbp::Rect> mpbp::IncrementalPacker::GetRects() const
+{
+  std::vector<mpbp::Rect> rects;
+  rects.reserve(this->rects.size());
+  for (const auto& [identifier, rect] : this->rects)
+  {
+    rects.push_back(rect);
+  }
+  std::sort(rects.begin(), rects.end(), [](const mpbp::Rect& a, const mpbp::Rect& b)
+            { return a.GetIdentifier() < b.GetIdentifier(); });
+  return rects;
+}
+
+std::size_t mpbp::IncrementalPacker::GetRectCount() const noexcept { return this->rects.size(); }
+
+double mpbp::IncrementalPacker::GetFillRatio() const
+{
+  const auto page_area = this->packer.GetPageArea();
+  if (page_area == 0) return 0.0;
+  return static_cast<double>(this->rect_area) / static_cast<double>(page_area);
+}
+
+std::size_t mpbp::IncrementalPacker::GetFullPackCount() const noexcept
+{
+  return this->full_pack_count;
+}
+
+const mpbp::Packer& mpbp::IncrementalPacker::GetPacker() const noexcept { return this->packer; }
+
+void mpbp::IncrementalPacker::packAll()
+{
+  // Pack in identifier order, so that the layout only depends on the manifest and not on the order
+  // of the hash map.
+  auto all_rects = this->GetRects();
+  this->packer.Clear();
+  this->packer.Pack(all_rects);
+  for (const auto& rect : all_rects)
+  {
+    this->rects[rect.GetIdentifier()] = rect;
+  }
+  this->full_pack_count++;
+  this->full_pack_fill_ratio = this->GetFillRatio();
+}
@@ -0,0 +1,37 @@
+// SPDX-FileCopyrightText: 2022 Daniel Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+#include <mpbp/Move.hpp>
+
+mpbp::Move::Move(unsigned long int identifier, int from_left_x, int from_top_y, int from_page,
+                 int to_left_x, int to_top_y, int to_page, int width, int height) noexcept
+    : identifier(identifier),
+      from_left_x(from_left_x),
+      from_top_y(from_top_y),
+      from_page(from_page),
+      to_left_x(to_left_x),
+      to_top_y(to_top_y),
+      to_page(to_page),
+      width(width),
+      height(height)
+{
+}
+
+unsigned long int mpbp::Move::GetIdentifier() const noexcept { return this->identifier; }
+
+int mpbp::Move::GetFromLeftX() const noexcept { return this->from_left_x; }
+
+int mpbp::Move::GetFromTopY() const noexcept { return this->from_top_y; }
+
+int mpbp::Move::GetFromPage() const noexcept { return this->from_page; }
+
+int mpbp::Move::GetToLeftX() const noexcept { return this->to_left_x; }
+
+int mpbp::Move::GetToTopY() const noexcept { return this->to_top_y; }
+
+int mpbp::Move::GetToPage() const noexcept { return this->to_page; }
+
+int mpbp::Move::GetWidth() const noexcept { return this->width; }
+
+int mpbp::Move::GetHeight() const noexcept { return this->height; }
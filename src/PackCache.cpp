@@ -0,0 +1,545 @@
+// SPDX-FileCopyrightText: 2022 Daniel Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <mpbp/PackCache.hpp>
+#include <mpbp/configuration.h>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+
+#if __has_include(<sys/mman.h>)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define MPBP_PACK_CACHE_MMAP
+#endif
+
+namespace
+{
+  constexpr char file_magic[8] = {'M', 'P', 'B', 'P', 'P', 'A', 'C', 'K'};
+  constexpr std::int32_t file_version = 2;
+  constexpr const char* file_extension = ".mpbp";
+  // Counts the temporary files of this process, so that each store writes a file of its own.
+  std::atomic<std::uint64_t> temporary_file_counter = 0;
+
+  // A random value that is drawn once for each process, so that processes sharing a cache
+  // directory do not count the same temporary file names.
+  std::uint64_t processToken()
+  {
+    static const std::uint64_t token = []()
+    {
+      std::random_device device;
+      return std::uint64_t{device()} << 32 | device();
+    }();
+    return token;
+  }
+
+  template <typename T>
+  void writeValue(std::vector<std::byte>& bytes, T value)
+  {
+    const auto offset = bytes.size();
+    bytes.resize(offset + sizeof(value));
+    std::memcpy(bytes.data() + offset, &value, sizeof(value));
+  }
+
+  // Reads values from the bytes of a cache file. Every read fails once the bytes run out, so a
+  // truncated file is found by checking the last read.
+  struct ByteReader
+  {
+    std::span<const std::byte> bytes;
+    std::size_t offset = 0;
+
+    template <typename T>
+    bool read(T& value) noexcept
+    {
+      if (this->bytes.size() - this->offset < sizeof(value)) return false;
+      std::memcpy(&value, this->bytes.data() + this->offset, sizeof(value));
+      this->offset += sizeof(value);
+      return true;
+    }
+
+    // Read a count of following values, and check that the rest of the file is long enough to have
+    // that many values of a size, so that a corrupt count can not cause a huge allocation.
+    bool readCount(std::size_t& count, std::size_t value_size) noexcept
+    {
+      std::uint64_t value = 0;
+      if (!this->read(value)) return false;
+      if (value > (this->bytes.size() - this->offset) / value_size) return false;
+      count = static_cast<std::size_t>(value);
+      return true;
+    }
+  };
+
+  // The whole contents of a file, mapped into memory where the platform supports it.
+  class FileView
+  {
+   private:
+#ifdef MPBP_PACK_CACHE_MMAP
+    void* data = nullptr;
+    std::size_t size = 0;
+#else
+    std::vector<std::byte> data = std::vector<std::byte>();
+#endif
+
+   public:
+    explicit FileView(const std::filesystem::path& path)
+    {
+#ifdef MPBP_PACK_CACHE_MMAP
+      const auto file = ::open(path.c_str(), O_RDONLY);
+      if (file < 0) return;
+      struct stat file_stat;
+      if (::fstat(file, &file_stat) == 0 && file_stat.st_size > 0)
+      {
+        const auto mapped = ::mmap(nullptr, static_cast<std::size_t>(file_stat.st_size), PROT_READ,
+                                   MAP_PRIVATE, file, 0);
+        if (mapped != MAP_FAILED)
+        {
+          this->data = mapped;
+          this->size = static_cast<std::size_t>(file_stat.st_size);
+        }
+      }
+      ::close(file);
+#else
+      std::ifstream file(path, std::ios::binary);
+      if (!file) return;
+      file.seekg(0, std::ios::end);
+      const auto size = file.tellg();
+      if (size <= 0) return;
+      file.seekg(0, std::ios::beg);
+      this->data.resize(static_cast<std::size_t>(size));
+      if (!file.read(reinterpret_cast<char*>(this->data.data()), size)) this->data.clear();
+#endif
+    }
+
+    FileView(const FileView&) = delete;
+    FileView& operator=(const FileView&) = delete;
+
+    ~FileView()
+    {
+#ifdef MPBP_PACK_CACHE_MMAP
+      if (this->data != nullptr) ::munmap(this->data, this->size);
+#endif
+    }
+
+    std::span<const std::byte> getBytes() const noexcept
+    {
+#ifdef MPBP_PACK_CACHE_MMAP
+      return std::span<const std::byte>(static_cast<const std::byte*>(this->data), this->size);
+#else
+      return std::span<const std::byte>(this->data);
+#endif
+    }
+  };
+
+  // The size and group of a Rect. Rect with the same key are interchangeable, so the cache keeps
+  // the placements of each key in a run and hands them out in any order.
+  struct RectKey
+  {
+    std::int32_t width;
+    std::int32_t height;
+    std::int32_t group;
+
+    auto operator<=>(const RectKey& other) const noexcept = default;
+  };
+
+  RectKey rectKey(const mpbp::Rect& rect) noexcept
+  {
+    return {rect.GetWidth(), rect.GetHeight(), rect.GetGroup()};
+  }
+
+  std::uint64_t mixBits(std::uint64_t bits) noexcept
+  {
+    bits = (bits ^ (bits >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    bits = (bits ^ (bits >> 27)) * 0x94D049BB133111EBULL;
+    return bits ^ (bits >> 31);
+  }
+
+  struct RectKeyHash
+  {
+    std::size_t operator()(const RectKey& key) const noexcept
+    {
+      const auto width_bits = static_cast<std::uint64_t>(static_cast<std::uint32_t>(key.width));
+      const auto size_bits = (width_bits << 32) | static_cast<std::uint32_t>(key.height);
+      const auto group_bits = mixBits(static_cast<std::uint32_t>(key.group));
+      return static_cast<std::size_t>(mixBits(size_bits ^ group_bits));
+    }
+  };
+
+  // Everything other than the Rect that the result of a pack depends on.
+  std::vector<std::int32_t> packSettings(const mpbp::Packer& packer)
+  {
+    std::vector<std::int32_t> settings = {file_version,
+                                          MPBP_VERSION_MAJOR,
+                                          MPBP_VERSION_MINOR,
+                                          MPBP_VERSION_PATCH,
+                                          packer.GetMaxWidth(),
+                                          packer.GetMaxHeight(),
+                                          static_cast<std::int32_t>(packer.GetPruneMode()),
+                                          packer.GetCloseWidth(),
+                                          packer.GetCloseHeight(),
+                                          packer.GetPadding(),
+                                          packer.GetAlignmentX(),
+                                          packer.GetAlignmentY(),
+                                          static_cast<std::int32_t>(packer.GetPageSizes().size())};
+    for (const auto& page_size : packer.GetPageSizes())
+    {
+      settings.push_back(page_size.GetWidth());
+      settings.push_back(page_size.GetHeight());
+      settings.push_back(page_size.GetCountLimit());
+    }
+    return settings;
+  }
+
+  // Hash values with 64 bit FNV-1a.
+  std::uint64_t hashValues(std::uint64_t hash, const std::span<const std::int32_t> values) noexcept
+  {
+    for (const auto value : values)
+    {
+      auto bits = static_cast<std::uint32_t>(value);
+      for (int byte_i = 0; byte_i < 4; byte_i++, bits >>= 8)
+      {
+        hash = (hash ^ (bits & 0xFF)) * 0x100000001B3ULL;
+      }
+    }
+    return hash;
+  }
+
+  std::string hexString(std::uint64_t value)
+  {
+    constexpr char digits[] = "0123456789abcdef";
+    std::string text(16, '0');
+    for (auto digit_i = text.size(); digit_i > 0; digit_i--, value >>= 4)
+    {
+      text[digit_i - 1] = digits[value & 0xF];
+    }
+    return text;
+  }
+
+  bool isCacheFile(const std::filesystem::directory_entry& entry)
+  {
+    std::error_code error;
+    return entry.is_regular_file(error) && entry.path().extension() == file_extension;
+  }
+}  // namespace
+
+mpbp::PackCache::PackCache(std::filesystem::path directory, std::uintmax_t max_size)
+    : directory(std::move(directory)), max_size(max_size)
+{
+  std::filesystem::create_directories(this->directory);
+}
+
+bool mpbp::PackCache::Pack(mpbp::Packer& packer, const std::span<mpbp::Rect> rects)
+{
+  if (packer.GetPageCount() != 0 || packer.GetCheckpointCount() != 0)
+  {
+    throw std::runtime_error("can not use the pack cache with a packer that is not empty");
+  }
+  if (rects.size() == 0) return false;
+  const auto settings = packSettings(packer);
+  // The hashes of the Rect are summed so that the hash of the multiset does not depend on their
+  // order, and the Rect do not have to be sorted to look them up.
+  std::uint64_t rects_hash = 0;
+  for (const auto& rect : rects) rects_hash += RectKeyHash()(rectKey(rect));
+  const std::int32_t rects_hash_values[] = {static_cast<std::int32_t>(rects_hash),
+                                            static_cast<std::int32_t>(rects_hash >> 32)};
+  const auto hash = hashValues(hashValues(0xCBF29CE484222325ULL, settings), rects_hash_values);
+  const auto path = this->directory / (hexString(hash) + file_extension);
+  if (this->tryLoad(path, settings, packer, rects))
+  {
+    this->hit_count++;
+    // The last write time doubles as the last use time for the eviction order.
+    std::error_code error;
+    std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), error);
+    return true;
+  }
+  this->miss_count++;
+  packer.Pack(rects);
+  this->store(path, settings, packer, rects);
+  return false;
+}
+
+void mpbp::PackCache::Clear()
+{
+  for (const auto& entry : std::filesystem::directory_iterator(this->directory))
+  {
+    if (isCacheFile(entry)) std::filesystem::remove(entry.path());
+  }
+}
+
+const std::filesystem::path& mpbp::PackCache::GetDirectory() const noexcept
+{
+  return this->directory;
+}
+
+std::uintmax_t mpbp::PackCache::GetMaxSize() const noexcept { return this->max_size; }
+
+std::uintmax_t mpbp::PackCache::GetSize() const
+{
+  std::uintmax_t size = 0;
+  for (const auto& entry : std::filesystem::directory_iterator(this->directory))
+  {
+    if (isCacheFile(entry)) size += entry.file_size();
+  }
+  return size;
+}
+
+std::size_t mpbp::PackCache::GetHitCount() const noexcept { return this->hit_count; }
+
+std::size_t mpbp::PackCache::GetMissCount() const noexcept { return this->miss_count; }
+
+std::size_t mpbp::PackCache::GetEvictionCount() const noexcept { return this->eviction_count; }
+
+bool mpbp::PackCache::tryLoad(const std::filesystem::path& path,
+                              const std::span<const std::int32_t> settings, mpbp::Packer& packer,
+                              const std::span<mpbp::Rect> rects) const
+{
+  const FileView file(path);
+  ByteReader reader{file.getBytes()};
+  // Every value is read and checked before the Packer or any Rect is changed, so a file that is
+  // corrupt or belongs to a different pack with the same hash is a miss.
+  char magic[sizeof(file_magic)] = {};
+  std::size_t count = 0;
+  if (!reader.read(magic) || std::memcmp(magic, file_magic, sizeof(magic)) != 0) return false;
+  if (!reader.readCount(count, sizeof(std::int32_t)) || count != settings.size()) return false;
+  for (const auto setting : settings)
+  {
+    std::int32_t value = 0;
+    if (!reader.read(value) || value != setting) return false;
+  }
+  // The placements are in runs of the same key. Each Rect takes the next placement of the run of
+  // its key, and since there are as many placements as Rect, the multisets match if no run runs
+  // out.
+  struct PlacementRun
+  {
+    std::size_t next_i;
+    std::size_t end_i;
+  };
+  constexpr auto placement_size = sizeof(std::int32_t) * 6;
+  if (!reader.readCount(count, placement_size) || count != rects.size()) return false;
+  const auto placements_offset = reader.offset;
+  std::unordered_map<RectKey, PlacementRun, RectKeyHash> runs;
+  for (std::size_t placement_i = 0; placement_i < count; placement_i++)
+  {
+    std::int32_t values[6] = {};
+    reader.read(values);
+    const RectKey key = {values[0], values[1], values[2]};
+    const auto run_it = runs.try_emplace(key, PlacementRun{placement_i, placement_i}).first;
+    if (run_it->second.end_i != placement_i) return false;
+    run_it->second.end_i++;
+  }
+  std::vector<std::size_t> placement_indices(rects.size());
+  for (std::size_t rect_i = 0; rect_i < rects.size(); rect_i++)
+  {
+    const auto run_it = runs.find(rectKey(rects[rect_i]));
+    if (run_it == runs.end() || run_it->second.next_i == run_it->second.end_i) return false;
+    placement_indices[rect_i] = run_it->second.next_i++;
+  }
+  std::int32_t counters[8] = {};
+  std::uint64_t pruned_space_count = 0;
+  std::uint64_t duplicate_count = 0;
+  if (!reader.read(counters) || !reader.read(pruned_space_count) || !reader.read(duplicate_count))
+  {
+    return false;
+  }
+  std::vector<mpbp::Space> spaces;
+  if (!reader.readCount(count, sizeof(std::int32_t) * 5)) return false;
+  spaces.reserve(count);
+  for (std::size_t space_i = 0; space_i < count; space_i++)
+  {
+    std::int32_t values[5] = {};
+    reader.read(values);
+    spaces.emplace_back(values[0], values[1], values[2], values[3], values[4]);
+  }
+  auto read_ints = [&](std::vector<int>& ints)
+  {
+    if (!reader.readCount(count, sizeof(std::int32_t))) return false;
+    ints.resize(count);
+    for (auto& value : ints)
+    {
+      std::int32_t read_value = 0;
+      reader.read(read_value);
+      value = read_value;
+    }
+    return true;
+  };
+  std::vector<int> page_size_uses;
+  std::vector<int> page_size_indices;
+  if (!read_ints(page_size_uses) || page_size_uses.size() != packer.page_size_uses.size() ||
+      !read_ints(page_size_indices))
+  {
+    return false;
+  }
+  std::vector<bool> closed_pages;
+  if (!reader.readCount(count, sizeof(std::uint8_t))) return false;
+  closed_pages.resize(count);
+  for (std::size_t page = 0; page < count; page++)
+  {
+    std::uint8_t value = 0;
+    reader.read(value);
+    closed_pages[page] = value != 0;
+  }
+  std::vector<int> placement_counts;
+  if (!read_ints(placement_counts) || placement_counts.size() != closed_pages.size()) return false;
+  std::unordered_map<int, std::vector<int>> group_pages;
+  std::size_t group_count = 0;
+  if (!reader.readCount(group_count, sizeof(std::int32_t) + sizeof(std::uint64_t))) return false;
+  for (std::size_t group_i = 0; group_i < group_count; group_i++)
+  {
+    std::int32_t group = 0;
+    if (!reader.read(group) || !read_ints(group_pages[group])) return false;
+  }
+  if (reader.offset != reader.bytes.size()) return false;
+  for (std::size_t rect_i = 0; rect_i < rects.size(); rect_i++)
+  {
+    std::int32_t values[6] = {};
+    const auto placement_offset = placements_offset + placement_indices[rect_i] * placement_size;
+    std::memcpy(values, reader.bytes.data() + placement_offset, placement_size);
+    rects[rect_i].Place(values[3], values[4], values[5]);
+  }
+  packer.page_count = counters[0];
+  packer.width = counters[1];
+  packer.height = counters[2];
+  packer.max_width = counters[3];
+  packer.max_height = counters[4];
+  packer.top_bin_width = counters[5];
+  packer.top_bin_height = counters[6];
+  packer.closed_page_count = counters[7];
+  packer.pruned_space_count = static_cast<std::size_t>(pruned_space_count);
+  packer.duplicate_count = static_cast<std::size_t>(duplicate_count);
+  packer.spaces = std::move(spaces);
+  packer.page_size_uses = std::move(page_size_uses);
+  packer.page_size_indices = std::move(page_size_indices);
+  packer.closed_pages = std::move(closed_pages);
+  packer.placement_counts = std::move(placement_counts);
+  packer.group_pages = std::move(group_pages);
+  return true;
+}
+
+void mpbp::PackCache::store(const std::filesystem::path& path,
+                            const std::span<const std::int32_t> settings,
+                            const mpbp::Packer& packer, const std::span<const mpbp::Rect> rects)
+{
+  std::vector<std::byte> bytes;
+  bytes.reserve(sizeof(file_magic) + settings.size() * sizeof(std::int32_t) +
+                rects.size() * sizeof(std::int32_t) * 6 +
+                packer.spaces.size() * sizeof(std::int32_t) * 5 + 256);
+  for (const auto magic_char : file_magic) writeValue(bytes, magic_char);
+  writeValue<std::uint64_t>(bytes, settings.size());
+  for (const auto setting : settings) writeValue<std::int32_t>(bytes, setting);
+  writeValue<std::uint64_t>(bytes, rects.size());
+  std::vector<std::size_t> rect_order(rects.size());
+  std::iota(rect_order.begin(), rect_order.end(), std::size_t{0});
+  std::sort(rect_order.begin(), rect_order.end(), [&](std::size_t a, std::size_t b)
+            { return rectKey(rects[a]) < rectKey(rects[b]); });
+  for (const auto rect_i : rect_order)
+  {
+    const auto& rect = rects[rect_i];
+    for (const auto value : {rect.GetWidth(), rect.GetHeight(), rect.GetGroup(), rect.GetLeftX(),
+                             rect.GetTopY(), rect.GetPage()})
+    {
+      writeValue<std::int32_t>(bytes, value);
+    }
+  }
+  for (const auto value : {packer.page_count, packer.width, packer.height, packer.max_width,
+                           packer.max_height, packer.top_bin_width, packer.top_bin_height,
+                           packer.closed_page_count})
+  {
+    writeValue<std::int32_t>(bytes, value);
+  }
+  writeValue<std::uint64_t>(bytes, packer.pruned_space_count);
+  writeValue<std::uint64_t>(bytes, packer.duplicate_count);
+  writeValue<std::uint64_t>(bytes, packer.spaces.size());
+  for (const auto& space : packer.spaces)
+  {
+    for (const auto value : {space.GetLeftX(), space.GetTopY(), space.GetPage(), space.GetWidth(),
+                             space.GetHeight()})
+    {
+      writeValue<std::int32_t>(bytes, value);
+    }
+  }
+  auto write_ints = [&](const std::vector<int>& ints)
+  {
+    writeValue<std::uint64_t>(bytes, ints.size());
+    for (const auto value : ints) writeValue<std::int32_t>(bytes, value);
+  };
+  write_ints(packer.page_size_uses);
+  write_ints(packer.page_size_indices);
+  writeValue<std::uint64_t>(bytes, packer.closed_pages.size());
+  for (const auto closed : packer.closed_pages) writeValue<std::uint8_t>(bytes, closed ? 1 : 0);
+  write_ints(packer.placement_counts);
+  writeValue<std::uint64_t>(bytes, packer.group_pages.size());
+  for (const auto& [group, pages] : packer.group_pages)
+  {
+    writeValue<std::int32_t>(bytes, group);
+    write_ints(pages);
+  }
+  // A result that is larger than the whole cache would only evict everything else.
+  if (bytes.size() > this->max_size) return;
+  // The file is written under a temporary name and renamed into place, so a process that reads the
+  // cache at the same time never sees a partly written file. The name is unique to this store, so
+  // threads and processes that store a result for the same key at once never share a file, and
+  // whichever of them renames last leaves a valid result.
+  auto temporary_path = path;
+  temporary_path += "." + hexString(processToken()) + "." +
+                    std::to_string(temporary_file_counter.fetch_add(1)) + ".tmp";
+  std::ofstream file(temporary_path, std::ios::binary | std::ios::trunc);
+  file.write(reinterpret_cast<const char*>(bytes.data()),
+             static_cast<std::streamsize>(bytes.size()));
+  file.close();
+  // The Rect are already packed, so a result that can not be stored only misses later packs.
+  std::error_code error;
+  if (file) std::filesystem::rename(temporary_path, path, error);
+  if (!file || error)
+  {
+    std::filesystem::remove(temporary_path, error);
+    return;
+  }
+  this->evict(path);
+}
+
+void mpbp::PackCache::evict(const std::filesystem::path& kept_path)
+{
+  struct CacheFile
+  {
+    std::filesystem::file_time_type last_use;
+    std::uintmax_t size;
+    std::filesystem::path path;
+  };
+  std::vector<CacheFile> files;
+  std::uintmax_t size = 0;
+  for (const auto& entry : std::filesystem::directory_iterator(this->directory))
+  {
+    if (!isCacheFile(entry)) continue;
+    std::error_code error;
+    const auto last_use = entry.last_write_time(error);
+    const auto file_size = entry.file_size(error);
+    if (error) continue;
+    files.push_back({last_use, file_size, entry.path()});
+    size += file_size;
+  }
+  if (size <= this->max_size) return;
+  std::sort(files.begin(), files.end(), [](const CacheFile& a, const CacheFile& b)
+            { return std::tie(a.last_use, a.path) < std::tie(b.last_use, b.path); });
+  for (const auto& file : files)
+  {
+    if (size <= this->max_size) return;
+    if (file.path == kept_path) continue;
+    std::error_code error;
+    if (std::filesystem::remove(file.path, error))
+    {
+      size -= file.size;
+      this->eviction_count++;
+    }
+  }
+}
@@ -0,0 +1,328 @@
+// SPDX-FileCopyrightText: 2022 Daniel Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <limits>
+#include <mpbp/PackChannel.hpp>
+#include <mpbp/configuration.h>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+  constexpr char channel_magic[8] = {'M', 'P', 'B', 'P', 'C', 'H', 'A', 'N'};
+  constexpr std::uint32_t channel_version =
+      MPBP_VERSION_MAJOR << 16 | MPBP_VERSION_MINOR << 8 | MPBP_VERSION_PATCH;
+  constexpr std::size_t line_size = 64;
+  constexpr std::size_t error_size = 128;
+
+  static_assert(std::is_trivially_copyable_v<mpbp::Rect>,
+                "Rect must be trivially copyable to be packed in shared memory");
+  static_assert(std::atomic<std::uint32_t>::is_always_lock_free,
+                "the state of a slot must be lock free to be shared between processes");
+
+  struct ChannelHeader
+  {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t rect_size;
+    std::uint32_t slot_count;
+    std::uint64_t slot_capacity;
+  };
+
+  struct SlotHeader
+  {
+    std::atomic<std::uint32_t> state;
+    std::int32_t max_width;
+    std::int32_t max_height;
+    std::uint64_t rect_count;
+    std::int32_t page_count;
+    std::int32_t width;
+    std::int32_t height;
+    std::uint32_t cache_hit;
+    std::uint32_t has_error;
+    char error[error_size];
+  };
+
+  constexpr std::size_t alignUp(std::size_t size) noexcept
+  {
+    return (size + line_size - 1) / line_size * line_size;
+  }
+
+  constexpr std::size_t header_size = alignUp(sizeof(ChannelHeader));
+  constexpr std::size_t rects_offset = alignUp(sizeof(SlotHeader));
+
+  // The largest slot capacity that keeps the size of a channel with the most slots in range.
+  constexpr std::size_t max_slot_capacity =
+      (std::numeric_limits<std::size_t>::max() / 256 - header_size - rects_offset - line_size) /
+      sizeof(mpbp::Rect);
+
+  std::size_t slotStride(std::size_t slot_capacity) noexcept
+  {
+    return alignUp(rects_offset + slot_capacity * sizeof(mpbp::Rect));
+  }
+
+  std::size_t channelSize(int slot_count, std::size_t slot_capacity) noexcept
+  {
+    return header_size + slot_count * slotStride(slot_capacity);
+  }
+
+  SlotHeader& getSlotHeader(void* data, std::size_t slot_capacity, int slot_i) noexcept
+  {
+    return *std::launder(reinterpret_cast<SlotHeader*>(static_cast<std::byte*>(data) +
+                                                       header_size +
+                                                       slot_i * slotStride(slot_capacity)));
+  }
+
+  std::string makeUniqueName()
+  {
+    static std::atomic<unsigned long> channel_counter = 0;
+    const auto ticks = std::chrono::steady_clock::now().time_since_epoch().count();
+    return "/mpbp-" + std::to_string(::getpid()) + "-" + std::to_string(channel_counter++) + "-" +
+           std::to_string(static_cast<unsigned long>(ticks) % 1000000);
+  }
+}  // namespace
+
+mpbp::PackChannel::PackChannel(int slot_count, std::size_t slot_capacity)
+{
+  if (slot_count < 1 || slot_count > 255)
+  {
+    throw std::runtime_error("invalid pack channel slot count");
+  }
+  if (slot_capacity == 0 || slot_capacity > max_slot_capacity)
+  {
+    throw std::runtime_error("invalid pack channel slot capacity");
+  }
+  int descriptor = -1;
+  // The name includes a counter and the clock, so it only collides with a stale object of a process
+  // that had the same id.
+  for (int attempt_i = 0; attempt_i < 8 && descriptor < 0; attempt_i++)
+  {
+    this->name = makeUniqueName();
+    descriptor = ::shm_open(this->name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (descriptor < 0 && errno != EEXIST) break;
+  }
+  if (descriptor < 0)
+  {
+    throw std::runtime_error("failed to create the shared memory of the pack channel");
+  }
+  this->owned = true;
+  const auto size = channelSize(slot_count, slot_capacity);
+  try
+  {
+    if (::ftruncate(descriptor, static_cast<off_t>(size)) != 0)
+    {
+      throw std::runtime_error("failed to create the shared memory of the pack channel");
+    }
+    this->map(descriptor, size);
+  }
+  catch (...)
+  {
+    ::close(descriptor);
+    ::shm_unlink(this->name.c_str());
+    throw;
+  }
+  ::close(descriptor);
+  this->slot_count = slot_count;
+  this->slot_capacity = slot_capacity;
+  // The new memory is zeroed, so every slot starts out as PackSlotState::Free.
+  auto* header = static_cast<ChannelHeader*>(this->data);
+  std::memcpy(header->magic, channel_magic, sizeof(channel_magic));
+  header->version = channel_version;
+  header->rect_size = sizeof(mpbp::Rect);
+  header->slot_count = static_cast<std::uint32_t>(slot_count);
+  header->slot_capacity = slot_capacity;
+  for (int slot_i = 0; slot_i < slot_count; slot_i++)
+  {
+    new (&getSlotHeader(this->data, slot_capacity, slot_i)) SlotHeader();
+  }
+}
+
+mpbp::PackChannel::PackChannel(const std::string& name) : name(name)
+{
+  const auto descriptor = ::shm_open(name.c_str(), O_RDWR, 0);
+  if (descriptor < 0)
+  {
+    throw std::runtime_error("failed to open the shared memory of the pack channel");
+  }
+  try
+  {
+    struct stat status;
+    if (::fstat(descriptor, &status) != 0 ||
+        static_cast<std::size_t>(status.st_size) < sizeof(ChannelHeader))
+    {
+      throw std::runtime_error("failed to open the shared memory of the pack channel");
+    }
+    this->map(descriptor, static_cast<std::size_t>(status.st_size));
+  }
+  catch (...)
+  {
+    ::close(descriptor);
+    throw;
+  }
+  ::close(descriptor);
+  // The header is copied out before it is checked, so that the process that created the channel
+  // can not change it between the checks and its use.
+  ChannelHeader header;
+  std::memcpy(&header, this->data, sizeof(header));
+  const auto is_same_version =
+      std::memcmp(header.magic, channel_magic, sizeof(channel_magic)) == 0 &&
+      header.version == channel_version && header.rect_size == sizeof(mpbp::Rect);
+  const auto is_valid = header.slot_count >= 1 && header.slot_count <= 255 &&
+                        header.slot_capacity != 0 && header.slot_capacity <= max_slot_capacity &&
+                        channelSize(static_cast<int>(header.slot_count),
+                                    static_cast<std::size_t>(header.slot_capacity)) <= this->size;
+  if (!is_same_version || !is_valid)
+  {
+    ::munmap(this->data, this->size);
+    this->data = nullptr;
+    throw std::runtime_error(is_same_version
+                                 ? "the shared memory of the pack channel is corrupt"
+                                 : "the pack channel was created by a different version of mpbp");
+  }
+  this->slot_count = static_cast<int>(header.slot_count);
+  this->slot_capacity = static_cast<std::size_t>(header.slot_capacity);
+}
+
+mpbp::PackChannel::PackChannel(mpbp::PackChannel&& other) noexcept
+    : name(std::move(other.name)),
+      data(std::exchange(other.data, nullptr)),
+      size(std::exchange(other.size, 0)),
+      slot_count(std::exchange(other.slot_count, 0)),
+      slot_capacity(std::exchange(other.slot_capacity, 0)),
+      owned(std::exchange(other.owned, false))
+{
+}
+
+mpbp::PackChannel& mpbp::PackChannel::operator=(mpbp::PackChannel&& other) noexcept
+{
+  std::swap(this->name, other.name);
+  std::swap(this->data, other.data);
+  std::swap(this->size, other.size);
+  std::swap(this->slot_count, other.slot_count);
+  std::swap(this->slot_capacity, other.slot_capacity);
+  std::swap(this->owned, other.owned);
+  return *this;
+}
+
+mpbp::PackChannel::~PackChannel()
+{
+  this->Unlink();
+  if (this->data != nullptr) ::munmap(this->data, this->size);
+}
+
+void mpbp::PackChannel::map(int descriptor, std::size_t size)
+{
+  auto* data = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+  if (data == MAP_FAILED)
+  {
+    throw std::runtime_error("failed to map the shared memory of the pack channel");
+  }
+  this->data = data;
+  this->size = size;
+}
+
+void mpbp::PackChannel::Unlink() noexcept
+{
+  if (!this->owned) return;
+  ::shm_unlink(this->name.c_str());
+  this->owned = false;
+}
+
+const std::string& mpbp::PackChannel::GetName() const noexcept { return this->name; }
+
+int mpbp::PackChannel::GetSlotCount() const noexcept { return this->slot_count; }
+
+std::size_t mpbp::PackChannel::GetSlotCapacity() const noexcept { return this->slot_capacity; }
+
+mpbp::PackSlotState mpbp::PackChannel::GetState(int slot_i) const noexcept
+{
+  const auto& slot = getSlotHeader(this->data, this->slot_capacity, slot_i);
+  return static_cast<mpbp::PackSlotState>(slot.state.load(std::memory_order_acquire));
+}
+
+void mpbp::PackChannel::SetState(int slot_i, mpbp::PackSlotState state) noexcept
+{
+  auto& slot = getSlotHeader(this->data, this->slot_capacity, slot_i);
+  slot.state.store(static_cast<std::uint32_t>(state), std::memory_order_release);
+}
+
+bool mpbp::PackChannel::TryClaim(int slot_i) noexcept
+{
+  auto& slot = getSlotHeader(this->data, this->slot_capacity, slot_i);
+  auto expected = static_cast<std::uint32_t>(mpbp::PackSlotState::Submitted);
+  const auto packing = static_cast<std::uint32_t>(mpbp::PackSlotState::Packing);
+  return slot.state.compare_exchange_strong(expected, packing, std::memory_order_acquire);
+}
+
+void mpbp::PackChannel::SetRequest(int slot_i, std::size_t rect_count, int max_width,
+                                   int max_height) noexcept
+{
+  auto& slot = getSlotHeader(this->data, this->slot_capacity, slot_i);
+  slot.rect_count = rect_count;
+  slot.max_width = max_width;
+  slot.max_height = max_height;
+}
+
+int mpbp::PackChannel::GetMaxWidth(int slot_i) const noexcept
+{
+  return getSlotHeader(this->data, this->slot_capacity, slot_i).max_width;
+}
+
+int mpbp::PackChannel::GetMaxHeight(int slot_i) const noexcept
+{
+  return getSlotHeader(this->data, this->slot_capacity, slot_i).max_height;
+}
+
+std::span<mpbp::Rect> mpbp::PackChannel::GetRects(int slot_i)
+{
+  auto& slot = getSlotHeader(this->data, this->slot_capacity, slot_i);
+  const auto rect_count = slot.rect_count;
+  if (rect_count > this->slot_capacity)
+  {
+    throw std::runtime_error("the pack request has more rects than the slot capacity");
+  }
+  auto* rects = reinterpret_cast<mpbp::Rect*>(reinterpret_cast<std::byte*>(&slot) + rects_offset);
+  return std::span<mpbp::Rect>(std::launder(rects), static_cast<std::size_t>(rect_count));
+}
+
+void mpbp::PackChannel::SetResponse(int slot_i, const mpbp::PackResponse& response) noexcept
+{
+  auto& slot = getSlotHeader(this->data, this->slot_capacity, slot_i);
+  slot.page_count = response.GetPageCount();
+  slot.width = response.GetWidth();
+  slot.height = response.GetHeight();
+  slot.cache_hit = response.GetCacheHit();
+  slot.has_error = false;
+}
+
+void mpbp::PackChannel::SetError(int slot_i, const std::string& message) noexcept
+{
+  auto& slot = getSlotHeader(this->data, this->slot_capacity, slot_i);
+  const auto length = std::min(message.size(), error_size - 1);
+  std::memcpy(slot.error, message.data(), length);
+  slot.error[length] = '\0';
+  slot.has_error = true;
+}
+
+mpbp::PackResponse mpbp::PackChannel::GetResponse(int slot_i) const
+{
+  const auto& slot = getSlotHeader(this->data, this->slot_capacity, slot_i);
+  if (slot.has_error)
+  {
+    throw std::runtime_error(std::string(slot.error, strnlen(slot.error, error_size)));
+  }
+  return mpbp::PackResponse(slot.page_count, slot.width, slot.height, slot.cache_hit != 0);
+}
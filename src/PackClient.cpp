@@ -0,0 +1,167 @@
+// SPDX-FileCopyrightText: 2022 Daniel Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <mpbp/PackClient.hpp>
+#include <stdexcept>
+#include <string>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace
+{
+  // The size of the name of a PackChannel in the first message of a connection.
+  constexpr std::size_t channel_name_size = 64;
+
+  void sendByte(int socket, unsigned char byte)
+  {
+    ssize_t sent_size = 0;
+    do
+    {
+      sent_size = ::send(socket, &byte, 1, MSG_NOSIGNAL);
+    } while (sent_size < 0 && errno == EINTR);
+    if (sent_size != 1)
+    {
+      throw std::runtime_error("the pack server closed the connection");
+    }
+  }
+
+  unsigned char receiveByte(int socket)
+  {
+    unsigned char byte = 0;
+    ssize_t received_size = 0;
+    do
+    {
+      received_size = ::recv(socket, &byte, 1, 0);
+    } while (received_size < 0 && errno == EINTR);
+    if (received_size != 1)
+    {
+      throw std::runtime_error("the pack server closed the connection");
+    }
+    return byte;
+  }
+}  // namespace
+
+mpbp::PackClient::PackClient(const std::filesystem::path& socket_path, int slot_count,
+                             std::size_t slot_capacity)
+    : channel(slot_count, slot_capacity)
+{
+  sockaddr_un address = {};
+  address.sun_family = AF_UNIX;
+  const auto& path = socket_path.native();
+  if (path.size() >= sizeof(address.sun_path))
+  {
+    throw std::runtime_error("the pack server socket path is too long");
+  }
+  std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+  this->socket = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (this->socket < 0)
+  {
+    throw std::runtime_error("failed to create the pack client socket");
+  }
+  try
+  {
+    if (::connect(this->socket, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0)
+    {
+      throw std::runtime_error("failed to connect to the pack server");
+    }
+    char name[channel_name_size] = {};
+    const auto& channel_name = this->channel.GetName();
+    std::copy_n(channel_name.begin(), std::min(channel_name.size(), channel_name_size - 1), name);
+    if (::send(this->socket, name, sizeof(name), MSG_NOSIGNAL) != sizeof(name) ||
+        receiveByte(this->socket) != 1)
+    {
+      throw std::runtime_error("the pack server refused the pack channel");
+    }
+  }
+  catch (...)
+  {
+    ::close(this->socket);
+    throw;
+  }
+  // The server has mapped the channel, so its name is not needed anymore, and removing it now
+  // means that it can not be leaked if either process crashes.
+  this->channel.Unlink();
+}
+
+mpbp::PackClient::~PackClient() { ::close(this->socket); }
+
+int mpbp::PackClient::GetSlotCount() const noexcept { return this->channel.GetSlotCount(); }
+
+std::size_t mpbp::PackClient::GetSlotCapacity() const noexcept
+{
+  return this->channel.GetSlotCapacity();
+}
+
+std::span<mpbp::Rect> mpbp::PackClient::Reserve(std::size_t rect_count)
+{
+  if (rect_count > this->channel.GetSlotCapacity())
+  {
+    throw std::runtime_error("the pack request has more rects than the slot capacity");
+  }
+  const auto slot_i = this->next_slot_i;
+  // Reusing a slot whose ticket was not waited for would drop its response, and make a later wait
+  // for the ticket return the response of the new request.
+  if (this->channel.GetState(slot_i) != mpbp::PackSlotState::Free)
+  {
+    throw std::runtime_error("the next pack request slot has a ticket that was not waited for");
+  }
+  this->channel.SetRequest(slot_i, rect_count, 0, 0);
+  this->reserved_slot_i = slot_i;
+  return this->channel.GetRects(slot_i);
+}
+
+int mpbp::PackClient::Submit(int max_width, int max_height)
+{
+  if (this->reserved_slot_i < 0)
+  {
+    throw std::runtime_error("no pack request slot is reserved");
+  }
+  const auto slot_i = this->reserved_slot_i;
+  this->channel.SetRequest(slot_i, this->channel.GetRects(slot_i).size(), max_width, max_height);
+  this->channel.SetState(slot_i, mpbp::PackSlotState::Submitted);
+  this->reserved_slot_i = -1;
+  this->next_slot_i = (slot_i + 1) % this->channel.GetSlotCount();
+  // The byte only wakes the server up. The server finds the request by the state of the slot.
+  sendByte(this->socket, static_cast<unsigned char>(slot_i));
+  return slot_i;
+}
+
+mpbp::PackResponse mpbp::PackClient::Wait(int ticket)
+{
+  if (ticket < 0 || ticket >= this->channel.GetSlotCount() ||
+      this->channel.GetState(ticket) == mpbp::PackSlotState::Free)
+  {
+    throw std::runtime_error("invalid pack request ticket");
+  }
+  this->waitDone(ticket);
+  this->channel.SetState(ticket, mpbp::PackSlotState::Free);
+  return this->channel.GetResponse(ticket);
+}
+
+mpbp::PackResponse mpbp::PackClient::Pack(const std::span<mpbp::Rect> rects, int max_width,
+                                          int max_height)
+{
+  auto slot_rects = this->Reserve(rects.size());
+  std::copy(rects.begin(), rects.end(), slot_rects.begin());
+  const auto response = this->Wait(this->Submit(max_width, max_height));
+  std::copy(slot_rects.begin(), slot_rects.end(), rects.begin());
+  return response;
+}
+
+void mpbp::PackClient::waitDone(int slot_i)
+{
+  // The server sends one byte for each finished request. A byte may belong to another slot that
+  // has not been waited for yet, which is fine because that slot is then found done by its state.
+  while (true)
+  {
+    const auto state = this->channel.GetState(slot_i);
+    if (state == mpbp::PackSlotState::Free || state == mpbp::PackSlotState::Done) return;
+    receiveByte(this->socket);
+  }
+}
@@ -0,0 +1,94 @@
+// SPDX-FileCopyrightText: 2022 Daniel Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+#include <exception>
+#include <latch>
+#include <mpbp/PackJob.hpp>
+#include <mutex>
+
+namespace
+{
+  // Pack a job with a Packer that belongs to the calling thread. The Packer is reused for every job
+  // the thread packs, so the Space vector grows to the largest job once instead of being allocated
+  // for each job.
+  void packWithThreadPacker(mpbp::PackJob& job)
+  {
+    thread_local mpbp::Packer packer = []()
+    {
+      mpbp::Packer thread_packer;
+      thread_packer.SetShrinkToFit(false);
+      return thread_packer;
+    }();
+    job.Pack(packer);
+  }
+}  // namespace
+
+mpbp::PackJob::PackJob(std::span<mpbp::Rect> rects, int max_width, int max_height) noexcept
+    : rects(rects), max_width(max_width), max_height(max_height)
+{
+}
+
+void mpbp::PackJob::Pack(mpbp::Packer& packer)
+{
+  packer.SetMaxPageSize(this->max_width, this->max_height);
+  packer.Pack(this->rects);
+  this->page_count = packer.GetPageCount();
+  this->width = packer.GetWidth();
+  this->height = packer.GetHeight();
+}
+
+std::span<mpbp::Rect> mpbp::PackJob::GetRects() const noexcept { return this->rects; }
+
+int mpbp::PackJob::GetMaxWidth() const noexcept { return this->max_width; }
+
+int mpbp::PackJob::GetMaxHeight() const noexcept { return this->max_height; }
+
+int mpbp::PackJob::GetPageCount() const noexcept { return this->page_count; }
+
+int mpbp::PackJob::GetWidth() const noexcept { return this->width; }
+
+int mpbp::PackJob::GetHeight() const noexcept { return this->height; }
+
+void mpbp::PackMany(const std::span<mpbp::PackJob> jobs)
+{
+  mpbp::ThreadPool thread_pool;
+  mpbp::PackMany(jobs, thread_pool);
+}
+
+void mpbp::PackMany(const std::span<mpbp::PackJob> jobs, mpbp::ThreadPool& thread_pool)
+{
+  mpbp::TaskGroup task_group(thread_pool);
+  for (auto& job : jobs)
+  {
+    task_group.Submit([&job]() { packWithThreadPacker(job); });
+  }
+  task_group.Wait();
+}
+
+void mpbp::PackMany(const std::span<mpbp::PackJob> jobs,
+                    const std::function<void(std::function<void()>)>& executor)
+{
+  std::latch finished(static_cast<std::ptrdiff_t>(jobs.size()));
+  std::mutex exception_mutex;
+  std::exception_ptr exception = nullptr;
+  for (auto& job : jobs)
+  {
+    executor(
+        [&]()
+        {
+          try
+          {
+            packWithThreadPacker(job);
+          }
+          catch (...)
+          {
+            std::lock_guard lock(exception_mutex);
+            if (!exception) exception = std::current_exception();
+          }
+          finished.count_down();
+        });
+  }
+  finished.wait();
+  if (exception) std::rethrow_exception(exception);
+}
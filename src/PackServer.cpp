@@ -0,0 +1,391 @@
+// SPDX-FileCopyrightText: 2022 Daniel Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <exception>
+#include <mpbp/PackCache.hpp>
+#include <mpbp/PackChannel.hpp>
+#include <mpbp/PackServer.hpp>
+#include <mpbp/Packer.hpp>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace
+{
+  // The size of the name of a PackChannel in the first message of a connection.
+  constexpr std::size_t channel_name_size = 64;
+  // Every PackChannel name starts with this, so a client can not make the server map any other
+  // shared memory object.
+  constexpr const char* channel_name_prefix = "/mpbp-";
+  // How long a client may take to send the name of its channel after connecting.
+  constexpr auto channel_name_timeout = std::chrono::seconds(1);
+
+  sockaddr_un makeAddress(const std::filesystem::path& socket_path)
+  {
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    const auto& path = socket_path.native();
+    if (path.size() >= sizeof(address.sun_path))
+    {
+      throw std::runtime_error("the pack server socket path is too long");
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    return address;
+  }
+
+  bool isListening(const sockaddr_un& address) noexcept
+  {
+    const auto socket = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (socket < 0) return false;
+    const auto is_listening =
+        ::connect(socket, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0;
+    ::close(socket);
+    return is_listening;
+  }
+
+  void sendByte(int socket, unsigned char byte) noexcept
+  {
+    // A client that closed its socket or stopped reading it only loses its own wake up.
+    [[maybe_unused]] const auto sent_size = ::send(socket, &byte, 1, MSG_NOSIGNAL | MSG_DONTWAIT);
+  }
+}  // namespace
+
+struct mpbp::PackServer::Connection
+{
+  int socket = -1;
+  mpbp::PackChannel channel;
+  bool is_closed = false;
+
+  Connection(int socket, mpbp::PackChannel channel) noexcept
+      : socket(socket), channel(std::move(channel))
+  {
+  }
+  Connection(const Connection&) = delete;
+  Connection& operator=(const Connection&) = delete;
+  ~Connection() { ::close(this->socket); }
+};
+
+// A client that has connected but has not sent the whole name of its channel yet.
+struct mpbp::PackServer::PendingConnection
+{
+  int socket = -1;
+  std::chrono::steady_clock::time_point deadline;
+  std::size_t received_size = 0;
+  char name[channel_name_size] = {};
+  bool is_closed = false;
+
+  PendingConnection(int socket, std::chrono::steady_clock::time_point deadline) noexcept
+      : socket(socket), deadline(deadline)
+  {
+  }
+  PendingConnection(const PendingConnection&) = delete;
+  PendingConnection& operator=(const PendingConnection&) = delete;
+  ~PendingConnection()
+  {
+    if (this->socket >= 0) ::close(this->socket);
+  }
+};
+
+struct mpbp::PackServer::Worker
+{
+  mpbp::Packer packer;
+  std::optional<mpbp::PackCache> cache;
+};
+
+mpbp::PackServer::PackServer(std::filesystem::path socket_path)
+    : mpbp::PackServer(std::move(socket_path), 0)
+{
+}
+
+mpbp::PackServer::PackServer(std::filesystem::path socket_path, std::size_t thread_count)
+    : socket_path(std::move(socket_path)), thread_pool(thread_count)
+{
+  const auto address = makeAddress(this->socket_path);
+  if (::pipe2(this->stop_pipe, O_CLOEXEC | O_NONBLOCK) != 0)
+  {
+    throw std::runtime_error("failed to create the pack server stop pipe");
+  }
+  this->listen_socket = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  auto is_bound = this->listen_socket >= 0 &&
+                  ::bind(this->listen_socket, reinterpret_cast<const sockaddr*>(&address),
+                         sizeof(address)) == 0;
+  if (!is_bound && this->listen_socket >= 0 && errno == EADDRINUSE && !isListening(address))
+  {
+    // The socket file was left behind by a server that did not exit cleanly.
+    ::unlink(address.sun_path);
+    is_bound = ::bind(this->listen_socket, reinterpret_cast<const sockaddr*>(&address),
+                      sizeof(address)) == 0;
+  }
+  const auto error = is_bound ? 0 : errno;
+  if (!is_bound || ::listen(this->listen_socket, SOMAXCONN) != 0)
+  {
+    if (is_bound) ::unlink(address.sun_path);
+    if (this->listen_socket >= 0) ::close(this->listen_socket);
+    ::close(this->stop_pipe[0]);
+    ::close(this->stop_pipe[1]);
+    throw std::runtime_error(error == EADDRINUSE
+                                 ? "a pack server is already listening on the socket"
+                                 : "failed to listen on the pack server socket");
+  }
+}
+
+mpbp::PackServer::~PackServer()
+{
+  this->connections.clear();
+  this->pending_connections.clear();
+  ::close(this->listen_socket);
+  ::unlink(this->socket_path.c_str());
+  ::close(this->stop_pipe[0]);
+  ::close(this->stop_pipe[1]);
+}
+
+void mpbp::PackServer::SetCache(std::filesystem::path directory, std::uintmax_t max_size)
+{
+  // Creating a cache now makes the directory, and reports a bad directory before Run() is called.
+  mpbp::PackCache(directory, max_size);
+  this->cache_directory = std::move(directory);
+  this->cache_max_size = max_size;
+  std::lock_guard lock(this->worker_mutex);
+  this->idle_workers.clear();
+}
+
+void mpbp::PackServer::Run()
+{
+  std::vector<pollfd> descriptors;
+  while (true)
+  {
+    descriptors.clear();
+    descriptors.push_back({this->stop_pipe[0], POLLIN, 0});
+    descriptors.push_back({this->listen_socket, POLLIN, 0});
+    for (const auto& connection : this->connections)
+    {
+      descriptors.push_back({connection->socket, POLLIN, 0});
+    }
+    // The names of new clients are read as they arrive, so a slow client does not stall the
+    // others, and the wait ends in time to drop a client that takes too long.
+    auto timeout = -1;
+    const auto now = std::chrono::steady_clock::now();
+    for (const auto& pending_connection : this->pending_connections)
+    {
+      descriptors.push_back({pending_connection->socket, POLLIN, 0});
+      const auto remaining = std::chrono::ceil<std::chrono::milliseconds>(
+          pending_connection->deadline - now);
+      const auto remaining_ms = static_cast<int>(std::max<std::int64_t>(remaining.count(), 0));
+      timeout = timeout < 0 ? remaining_ms : std::min(timeout, remaining_ms);
+    }
+    if (::poll(descriptors.data(), descriptors.size(), timeout) < 0)
+    {
+      if (errno == EINTR) continue;
+      throw std::runtime_error("failed to wait for pack clients");
+    }
+    if (descriptors[0].revents != 0)
+    {
+      char bytes[16];
+      while (::read(this->stop_pipe[0], bytes, sizeof(bytes)) > 0)
+      {
+      }
+      return;
+    }
+    // The bytes from a client only wake the server up, so they are all read and dropped.
+    for (std::size_t connection_i = 0; connection_i < this->connections.size(); connection_i++)
+    {
+      if (descriptors[connection_i + 2].revents == 0) continue;
+      auto& connection = *this->connections[connection_i];
+      char bytes[256];
+      ssize_t received_size = 0;
+      while ((received_size = ::recv(connection.socket, bytes, sizeof(bytes), MSG_DONTWAIT)) > 0)
+      {
+      }
+      if (received_size == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
+      {
+        connection.is_closed = true;
+      }
+    }
+    const auto first_pending_i = this->connections.size() + 2;
+    const auto pending_count = this->pending_connections.size();
+    for (std::size_t pending_i = 0; pending_i < pending_count; pending_i++)
+    {
+      auto& pending_connection = *this->pending_connections[pending_i];
+      if (descriptors[first_pending_i + pending_i].revents != 0)
+      {
+        this->receiveName(pending_connection);
+      }
+      if (!pending_connection.is_closed &&
+          std::chrono::steady_clock::now() >= pending_connection.deadline)
+      {
+        pending_connection.is_closed = true;
+      }
+    }
+    if (descriptors[1].revents != 0) this->accept();
+    this->packBatch();
+    std::erase_if(this->connections,
+                  [](const std::unique_ptr<Connection>& connection)
+                  { return connection->is_closed; });
+    std::erase_if(this->pending_connections,
+                  [](const std::unique_ptr<PendingConnection>& pending_connection)
+                  { return pending_connection->is_closed; });
+  }
+}
+
+void mpbp::PackServer::Stop() noexcept
+{
+  const char byte = 0;
+  [[maybe_unused]] const auto written_size = ::write(this->stop_pipe[1], &byte, 1);
+}
+
+const std::filesystem::path& mpbp::PackServer::GetSocketPath() const noexcept
+{
+  return this->socket_path;
+}
+
+std::size_t mpbp::PackServer::GetRequestCount() const noexcept { return this->request_count; }
+
+std::size_t mpbp::PackServer::GetBatchCount() const noexcept { return this->batch_count; }
+
+std::size_t mpbp::PackServer::GetCacheHitCount() const noexcept { return this->cache_hit_count; }
+
+void mpbp::PackServer::accept()
+{
+  const auto socket =
+      ::accept4(this->listen_socket, nullptr, nullptr, SOCK_CLOEXEC | SOCK_NONBLOCK);
+  if (socket < 0) return;
+  // A client that connects but never sends the name of its channel must not stall the server, so
+  // the name is read by Run() as it arrives. Most clients send it right away.
+  this->pending_connections.push_back(std::make_unique<PendingConnection>(
+      socket, std::chrono::steady_clock::now() + channel_name_timeout));
+  this->receiveName(*this->pending_connections.back());
+}
+
+void mpbp::PackServer::receiveName(PendingConnection& pending_connection)
+{
+  auto& name = pending_connection.name;
+  const auto received_size =
+      ::recv(pending_connection.socket, name + pending_connection.received_size,
+             channel_name_size - pending_connection.received_size, MSG_DONTWAIT);
+  if (received_size < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) return;
+  if (received_size <= 0)
+  {
+    pending_connection.is_closed = true;
+    return;
+  }
+  pending_connection.received_size += static_cast<std::size_t>(received_size);
+  if (pending_connection.received_size < channel_name_size) return;
+  pending_connection.is_closed = true;
+  const auto socket = std::exchange(pending_connection.socket, -1);
+  name[channel_name_size - 1] = '\0';
+  try
+  {
+    if (std::strncmp(name, channel_name_prefix, std::strlen(channel_name_prefix)) != 0)
+    {
+      throw std::runtime_error("invalid pack channel name");
+    }
+    auto connection = std::make_unique<Connection>(socket, mpbp::PackChannel(std::string(name)));
+    this->connections.push_back(std::move(connection));
+  }
+  catch (const std::exception&)
+  {
+    sendByte(socket, 0);
+    ::close(socket);
+    return;
+  }
+  sendByte(socket, 1);
+}
+
+void mpbp::PackServer::packBatch()
+{
+  // Every request that was submitted since the last batch is packed in this batch, no matter which
+  // client it came from.
+  std::vector<std::pair<Connection*, int>> batch;
+  for (const auto& connection : this->connections)
+  {
+    if (connection->is_closed) continue;
+    for (int slot_i = 0; slot_i < connection->channel.GetSlotCount(); slot_i++)
+    {
+      if (connection->channel.TryClaim(slot_i)) batch.emplace_back(connection.get(), slot_i);
+    }
+  }
+  if (batch.empty()) return;
+  this->batch_count++;
+  for (const auto& [connection, slot_i] : batch)
+  {
+    this->thread_pool.Submit(
+        [this, &channel = connection->channel, slot_i = slot_i]()
+        {
+          std::unique_ptr<Worker> worker = nullptr;
+          try
+          {
+            worker = this->takeWorker();
+            worker->packer.SetMaxPageSize(channel.GetMaxWidth(slot_i),
+                                          channel.GetMaxHeight(slot_i));
+            const auto rects = channel.GetRects(slot_i);
+            auto cache_hit = false;
+            if (worker->cache)
+            {
+              cache_hit = worker->cache->Pack(worker->packer, rects);
+            }
+            else
+            {
+              worker->packer.Pack(rects);
+            }
+            if (cache_hit) this->cache_hit_count++;
+            channel.SetResponse(slot_i, mpbp::PackResponse(worker->packer.GetPageCount(),
+                                                           worker->packer.GetWidth(),
+                                                           worker->packer.GetHeight(), cache_hit));
+          }
+          catch (const std::exception& exception)
+          {
+            channel.SetError(slot_i, exception.what());
+          }
+          // The client may see the done state before the server wakes it up, so the request is
+          // counted first.
+          this->request_count++;
+          channel.SetState(slot_i, mpbp::PackSlotState::Done);
+          if (worker) this->returnWorker(std::move(worker));
+        });
+  }
+  this->thread_pool.Wait();
+  for (const auto& [connection, slot_i] : batch)
+  {
+    sendByte(connection->socket, static_cast<unsigned char>(slot_i));
+  }
+}
+
+std::unique_ptr<mpbp::PackServer::Worker> mpbp::PackServer::takeWorker()
+{
+  {
+    std::lock_guard lock(this->worker_mutex);
+    if (!this->idle_workers.empty())
+    {
+      auto worker = std::move(this->idle_workers.back());
+      this->idle_workers.pop_back();
+      return worker;
+    }
+  }
+  // There is at most one worker for each thread of the pool, and each keeps its memory between
+  // requests.
+  auto worker = std::make_unique<Worker>();
+  worker->packer.SetShrinkToFit(false);
+  if (!this->cache_directory.empty())
+  {
+    worker->cache.emplace(this->cache_directory, this->cache_max_size);
+  }
+  return worker;
+}
+
+void mpbp::PackServer::returnWorker(std::unique_ptr<Worker> worker)
+{
+  std::lock_guard lock(this->worker_mutex);
+  this->idle_workers.push_back(std::move(worker));
+}
@@ -3,15 +3,54 @@
 // SPDX-License-Identifier: MIT
 
 #include <algorithm>
+#include <cmath>
+#include <limits>
 #include <mpbp/Packer.hpp>
 #include <stdexcept>
 #include <span>
+#include <unordered_map>
+#include <utility>
+
+namespace
+{
+  int alignUp(int value, int alignment) noexcept
+  {
+    return (value + alignment - 1) / alignment * alignment;
+  }
+
+  // Rect can only share a placement if they have both the same content hash and the same size.
+  struct ContentKey
+  {
+    std::uint64_t hash;
+    int width;
+    int height;
+
+    bool operator==(const ContentKey&) const noexcept = default;
+  };
+
+  struct ContentKeyHash
+  {
+    std::size_t operator()(const ContentKey& key) const noexcept
+    {
+      auto value = key.hash;
+      value ^= (static_cast<std::uint64_t>(static_cast<std::uint32_t>(key.width)) << 32 |
+                static_cast<std::uint32_t>(key.height)) +
+               0x9e3779b97f4a7c15ULL + (value << 6) + (value >> 2);
+      return static_cast<std::size_t>(value);
+    }
+  };
+}  // namespace
 
 mpbp::Packer::Packer(int max_width, int max_height) noexcept
     : max_width(max_width), max_height(max_height)
 {
 }
 
+mpbp::Packer::Packer(const std::span<const mpbp::PageSize> page_sizes)
+{
+  this->SetPageSizes(page_sizes);
+}
+
 void mpbp::Packer::Clear() noexcept
 {
   this->spaces.clear();
@@ -20,15 +59,58 @@ void mpbp::Packer::Clear() noexcept
   this->height = 0;
   this->top_bin_width = 0;
   this->top_bin_height = 0;
+  this->pruned_spaces.clear();
+  this->pruned_space_count = 0;
+  this->duplicate_count = 0;
+  this->page_size_indices.clear();
+  this->closed_pages.clear();
+  this->closed_page_count = 0;
+  this->placement_counts.clear();
+  this->group_pages.clear();
+  this->checkpoints.clear();
+  this->space_edits.clear();
+  this->closed_page_edits.clear();
+  this->group_page_edits.clear();
+  this->placement_count_edits.clear();
+  std::fill(this->page_size_uses.begin(), this->page_size_uses.end(), 0);
+  if (!this->page_sizes.empty())
+  {
+    this->max_width = 0;
+    this->max_height = 0;
+  }
 }
 
 void mpbp::Packer::SetMaxPageSize(int max_width, int max_height)
 {
+  this->page_sizes.clear();
+  this->page_size_uses.clear();
   this->Clear();
   this->max_width = max_width;
   this->max_height = max_height;
 }
 
+void mpbp::Packer::SetPageSizes(const std::span<const mpbp::PageSize> page_sizes)
+{
+  for (const auto& page_size : page_sizes)
+  {
+    if (page_size.GetIsDegenerate())
+    {
+      throw std::runtime_error("invalid max page dimensions");
+    }
+  }
+  this->page_sizes.assign(page_sizes.begin(), page_sizes.end());
+  std::stable_sort(this->page_sizes.begin(), this->page_sizes.end(),
+                   [](const mpbp::PageSize& a, const mpbp::PageSize& b)
+                   { return a.GetArea() < b.GetArea(); });
+  this->page_size_uses.assign(this->page_sizes.size(), 0);
+  this->Clear();
+}
+
+const std::vector<mpbp::PageSize>& mpbp::Packer::GetPageSizes() const noexcept
+{
+  return this->page_sizes;
+}
+
 const std::vector<mpbp::Space>& mpbp::Packer::GetSpaces() const noexcept { return this->spaces; }
 
 int mpbp::Packer::GetPageCount() const noexcept { return this->page_count; }
@@ -37,6 +119,44 @@ int mpbp::Packer::GetWidth() const noexcept { return this->width; }
 
 int mpbp::Packer::GetHeight() const noexcept { return this->height; }
 
+int mpbp::Packer::GetPageWidth(int page) const
+{
+  if (page < 0 || page >= this->page_count)
+  {
+    throw std::runtime_error("invalid page index");
+  }
+  if (this->page_sizes.empty()) return this->width;
+  if (page < this->getTopPageI()) return this->page_sizes[this->page_size_indices[page]].GetWidth();
+  return this->page_sizes[this->findPageSize(this->top_bin_width, this->top_bin_height, false)]
+      .GetWidth();
+}
+
+int mpbp::Packer::GetPageHeight(int page) const
+{
+  if (page < 0 || page >= this->page_count)
+  {
+    throw std::runtime_error("invalid page index");
+  }
+  if (this->page_sizes.empty()) return this->height;
+  if (page < this->getTopPageI()) return this->page_sizes[this->page_size_indices[page]].GetHeight();
+  return this->page_sizes[this->findPageSize(this->top_bin_width, this->top_bin_height, false)]
+      .GetHeight();
+}
+
+long long mpbp::Packer::GetPageArea() const
+{
+  if (this->page_sizes.empty())
+  {
+    return static_cast<long long>(this->page_count) * this->width * this->height;
+  }
+  long long area = 0;
+  for (int page = 0; page < this->page_count; page++)
+  {
+    area += static_cast<long long>(this->GetPageWidth(page)) * this->GetPageHeight(page);
+  }
+  return area;
+}
+
 int mpbp::Packer::GetMaxWidth() const noexcept { return this->max_width; }
 
 int mpbp::Packer::GetMaxHeight() const noexcept { return this->max_height; }
@@ -45,6 +165,351 @@ int mpbp::Packer::GetTopBinWidth() const noexcept { return this->top_bin_width;
 
 int mpbp::Packer::GetTopBinHeight() const noexcept { return this->top_bin_height; }
 
+void mpbp::Packer::SetPruneMode(mpbp::PruneMode prune_mode) noexcept
+{
+  this->prune_mode = prune_mode;
+}
+
+mpbp::PruneMode mpbp::Packer::GetPruneMode() const noexcept { return this->prune_mode; }
+
+std::size_t mpbp::Packer::GetPrunedSpaceCount() const noexcept { return this->pruned_space_count; }
+
+std::size_t mpbp::Packer::GetDuplicateCount() const noexcept { return this->duplicate_count; }
+
+void mpbp::Packer::ClosePage(int page)
+{
+  if (page < 0 || page >= this->page_count)
+  {
+    throw std::runtime_error("invalid page index");
+  }
+  if (this->closed_pages[page]) return;
+  this->closePage(page);
+  this->releaseClosedSpaces();
+}
+
+bool mpbp::Packer::GetIsPageClosed(int page) const
+{
+  if (page < 0 || page >= this->page_count)
+  {
+    throw std::runtime_error("invalid page index");
+  }
+  return this->closed_pages[page];
+}
+
+int mpbp::Packer::GetClosedPageCount() const noexcept { return this->closed_page_count; }
+
+const std::vector<int>& mpbp::Packer::GetGroupPages(int group) const noexcept
+{
+  static const std::vector<int> no_pages = std::vector<int>();
+  const auto pages_it = this->group_pages.find(group);
+  if (pages_it == this->group_pages.end()) return no_pages;
+  return pages_it->second;
+}
+
+void mpbp::Packer::SetCloseThreshold(int close_width, int close_height) noexcept
+{
+  this->close_width = close_width;
+  this->close_height = close_height;
+}
+
+int mpbp::Packer::GetCloseWidth() const noexcept { return this->close_width; }
+
+int mpbp::Packer::GetCloseHeight() const noexcept { return this->close_height; }
+
+void mpbp::Packer::SetPadding(int padding)
+{
+  if (padding < 0)
+  {
+    throw std::runtime_error("invalid padding");
+  }
+  if (this->page_count > 0)
+  {
+    throw std::runtime_error("padding can not change while pages are packed");
+  }
+  this->padding = padding;
+}
+
+int mpbp::Packer::GetPadding() const noexcept { return this->padding; }
+
+void mpbp::Packer::SetAlignment(int alignment_x, int alignment_y)
+{
+  if (alignment_x <= 0 || alignment_y <= 0)
+  {
+    throw std::runtime_error("invalid alignment");
+  }
+  if (this->page_count > 0)
+  {
+    throw std::runtime_error("alignment can not change while pages are packed");
+  }
+  this->alignment_x = alignment_x;
+  this->alignment_y = alignment_y;
+}
+
+int mpbp::Packer::GetAlignmentX() const noexcept { return this->alignment_x; }
+
+int mpbp::Packer::GetAlignmentY() const noexcept { return this->alignment_y; }
+
+void mpbp::Packer::SetShrinkToFit(bool shrink_to_fit) noexcept
+{
+  this->shrink_to_fit = shrink_to_fit;
+}
+
+bool mpbp::Packer::GetShrinkToFit() const noexcept { return this->shrink_to_fit; }
+
+void mpbp::Packer::Checkpoint()
+{
+  this->checkpoints.push_back({this->space_edits.size(), this->closed_page_edits.size(),
+                               this->group_page_edits.size(), this->placement_count_edits.size(),
+                               this->page_size_indices.size(),
+                               this->page_count, this->width, this->height, this->max_width,
+                               this->max_height, this->top_bin_width, this->top_bin_height,
+                               this->closed_page_count, this->pruned_space_count,
+                               this->duplicate_count});
+}
+
+void mpbp::Packer::Rollback()
+{
+  if (this->checkpoints.empty())
+  {
+    throw std::runtime_error("no checkpoint to roll back to");
+  }
+  const auto checkpoint = this->checkpoints.back();
+  this->checkpoints.pop_back();
+  // Undo the space edits from newest to oldest, so the index of each one is valid again when it
+  // is undone.
+  while (this->space_edits.size() > checkpoint.space_edit_count)
+  {
+    const auto& edit = this->space_edits.back();
+    if (edit.inserted)
+    {
+      this->spaces.erase(this->spaces.begin() + edit.space_i);
+    }
+    else
+    {
+      this->spaces.insert(this->spaces.begin() + edit.space_i, edit.space);
+    }
+    this->space_edits.pop_back();
+  }
+  while (this->closed_page_edits.size() > checkpoint.closed_page_edit_count)
+  {
+    this->closed_pages[this->closed_page_edits.back()] = false;
+    this->closed_page_edits.pop_back();
+  }
+  while (this->group_page_edits.size() > checkpoint.group_page_edit_count)
+  {
+    const auto [group, page] = this->group_page_edits.back();
+    auto pages_it = this->group_pages.find(group);
+    pages_it->second.erase(
+        std::lower_bound(pages_it->second.begin(), pages_it->second.end(), page));
+    if (pages_it->second.empty()) this->group_pages.erase(pages_it);
+    this->group_page_edits.pop_back();
+  }
+  while (this->placement_count_edits.size() > checkpoint.placement_count_edit_count)
+  {
+    const auto [page, count] = this->placement_count_edits.back();
+    this->placement_counts[page] -= count;
+    this->placement_count_edits.pop_back();
+  }
+  // Every use of a page size belongs to a finished page, so the uses are given back with the pages.
+  while (this->page_size_indices.size() > checkpoint.page_size_index_count)
+  {
+    this->page_size_uses[this->page_size_indices.back()]--;
+    this->page_size_indices.pop_back();
+  }
+  this->closed_pages.resize(checkpoint.page_count);
+  this->placement_counts.resize(checkpoint.page_count);
+  this->pruned_spaces.clear();
+  this->prune_width = 0;
+  this->prune_height = 0;
+  this->page_count = checkpoint.page_count;
+  this->width = checkpoint.width;
+  this->height = checkpoint.height;
+  this->max_width = checkpoint.max_width;
+  this->max_height = checkpoint.max_height;
+  this->top_bin_width = checkpoint.top_bin_width;
+  this->top_bin_height = checkpoint.top_bin_height;
+  this->closed_page_count = checkpoint.closed_page_count;
+  this->pruned_space_count = checkpoint.pruned_space_count;
+  this->duplicate_count = checkpoint.duplicate_count;
+}
+
+void mpbp::Packer::Commit()
+{
+  if (this->checkpoints.empty())
+  {
+    throw std::runtime_error("no checkpoint to commit");
+  }
+  this->checkpoints.pop_back();
+  // The log is still needed to roll back an outer checkpoint.
+  if (!this->checkpoints.empty()) return;
+  this->space_edits.clear();
+  this->closed_page_edits.clear();
+  this->group_page_edits.clear();
+  this->placement_count_edits.clear();
+}
+
+std::size_t mpbp::Packer::GetCheckpointCount() const noexcept { return this->checkpoints.size(); }
+
+void mpbp::Packer::closeFullPages()
+{
+  if (this->close_width <= 0 && this->close_height <= 0) return;
+  std::vector<bool> usable_pages(this->page_count, false);
+  for (const auto& space : this->spaces)
+  {
+    if (space.Fits(this->close_width + this->padding * 2, this->close_height + this->padding * 2))
+    {
+      usable_pages[space.GetPage()] = true;
+    }
+  }
+  auto closed_any = false;
+  // The top page is never closed automatically because it can still grow.
+  for (int page = 0; page < this->getTopPageI(); page++)
+  {
+    if (!usable_pages[page] && !this->closed_pages[page])
+    {
+      this->closePage(page);
+      closed_any = true;
+    }
+  }
+  if (closed_any) this->releaseClosedSpaces();
+}
+
+void mpbp::Packer::closePage(int page)
+{
+  this->closed_pages[page] = true;
+  this->closed_page_count++;
+  if (!this->checkpoints.empty()) this->closed_page_edits.push_back(page);
+}
+
+void mpbp::Packer::releaseClosedSpaces()
+{
+  std::size_t keep_i = 0;
+  for (std::size_t space_i = 0; space_i < this->spaces.size(); space_i++)
+  {
+    const auto& space = this->spaces[space_i];
+    if (this->closed_pages[space.GetPage()])
+    {
+      if (!this->checkpoints.empty()) this->space_edits.push_back({keep_i, space, false});
+      continue;
+    }
+    this->spaces[keep_i++] = space;
+  }
+  this->spaces.resize(keep_i);
+}
+
+int mpbp::Packer::findPageSize(int width, int height, bool largest) const noexcept
+{
+  // The width and height are padded, but the page sizes are not.
+  int found_i = -1;
+  for (int size_i = 0; size_i < static_cast<int>(this->page_sizes.size()); size_i++)
+  {
+    const auto& page_size = this->page_sizes[size_i];
+    const auto limit = page_size.GetCountLimit();
+    if (!page_size.Fits(width - this->padding * 2, height - this->padding * 2) ||
+        (limit >= 0 && this->page_size_uses[size_i] >= limit))
+    {
+      continue;
+    }
+    found_i = size_i;
+    if (!largest) break;
+  }
+  return found_i;
+}
+
+void mpbp::Packer::addSpace(int left_x, int top_y, int page, int width, int height)
+{
+  // Move the space to the next aligned coordinates, so that every rect placed in it is aligned.
+  const auto aligned_left_x = alignUp(left_x, this->alignment_x);
+  const auto aligned_top_y = alignUp(top_y, this->alignment_y);
+  width -= aligned_left_x - left_x;
+  height -= aligned_top_y - top_y;
+  left_x = aligned_left_x;
+  top_y = aligned_top_y;
+  if (width <= 0 || height <= 0) return;
+  if (width < this->prune_width || height < this->prune_height)
+  {
+    this->pruned_space_count++;
+    if (this->prune_mode == mpbp::PruneMode::SetAside)
+    {
+      this->pruned_spaces.emplace_back(left_x, top_y, page, width, height);
+    }
+    return;
+  }
+  this->insertSpace(mpbp::Space(left_x, top_y, page, width, height));
+}
+
+void mpbp::Packer::insertSpace(const mpbp::Space& space)
+{
+  // Keep the spaces sorted as they are added, so a placement only moves the spaces after the ones
+  // it changes instead of sorting all of them, and so each change can be undone by its position.
+  const auto space_it = std::upper_bound(this->spaces.begin(), this->spaces.end(), space);
+  if (!this->checkpoints.empty())
+  {
+    this->space_edits.push_back({static_cast<std::size_t>(space_it - this->spaces.begin()),
+                                 mpbp::Space(), true});
+  }
+  this->spaces.insert(space_it, space);
+}
+
+void mpbp::Packer::eraseSpace(std::size_t space_i)
+{
+  if (!this->checkpoints.empty())
+  {
+    this->space_edits.push_back({space_i, this->spaces[space_i], false});
+  }
+  this->spaces.erase(this->spaces.begin() + space_i);
+}
+
+void mpbp::Packer::pruneSpaces()
+{
+  // Compact the reachable spaces to the front while keeping their sorted order.
+  std::size_t keep_i = 0;
+  for (std::size_t space_i = 0; space_i < this->spaces.size(); space_i++)
+  {
+    const auto& space = this->spaces[space_i];
+    if (space.GetWidth() < this->prune_width || space.GetHeight() < this->prune_height)
+    {
+      this->pruned_space_count++;
+      if (this->prune_mode == mpbp::PruneMode::SetAside)
+      {
+        this->pruned_spaces.push_back(space);
+      }
+      // Each removal is logged at the index it would have if the removals before it were done one
+      // at a time, so that undoing them in reverse restores the original order.
+      if (!this->checkpoints.empty()) this->space_edits.push_back({keep_i, space, false});
+      continue;
+    }
+    this->spaces[keep_i++] = space;
+  }
+  this->spaces.resize(keep_i);
+}
+
+void mpbp::Packer::restorePrunedSpaces()
+{
+  // Merge the set aside spaces back in from the end, so that no space is moved more than once.
+  std::stable_sort(this->pruned_spaces.begin(), this->pruned_spaces.end());
+  const auto old_size = this->spaces.size();
+  this->spaces.resize(old_size + this->pruned_spaces.size());
+  auto space_i = old_size;
+  auto pruned_i = this->pruned_spaces.size();
+  const auto first_edit_i = this->space_edits.size();
+  for (auto out_i = this->spaces.size(); pruned_i > 0; out_i--)
+  {
+    // Restored spaces go after kept spaces of the same size, like any other inserted space.
+    if (space_i > 0 && this->pruned_spaces[pruned_i - 1] < this->spaces[space_i - 1])
+    {
+      this->spaces[out_i - 1] = this->spaces[--space_i];
+      continue;
+    }
+    this->spaces[out_i - 1] = this->pruned_spaces[--pruned_i];
+    if (!this->checkpoints.empty()) this->space_edits.push_back({out_i - 1, mpbp::Space(), true});
+  }
+  // The insertions were found from the last index to the first, but are undone in reverse order,
+  // so they are logged from the first index to the last.
+  std::reverse(this->space_edits.begin() + first_edit_i, this->space_edits.end());
+  this->pruned_spaces.clear();
+}
+
 void mpbp::Packer::reserveSpaces(const std::span<mpbp::Rect>& rects)
 {
   const auto highest_new_space_count = rects.size() * 2;
@@ -52,30 +517,37 @@ void mpbp::Packer::reserveSpaces(const std::span<mpbp::Rect>& rects)
   this->spaces.reserve(new_space_capacity);
 }
 
-bool mpbp::Packer::tryPlaceSpace(mpbp::Rect& rect)
+bool mpbp::Packer::tryPlaceSpace(mpbp::Rect& rect, const std::span<const int> pages)
 {
+  // Place the padded rect, so that the spaces split from around it leave a gutter.
+  const auto padded_width = rect.GetWidth() + this->padding * 2;
+  const auto padded_height = rect.GetHeight() + this->padding * 2;
   for (std::size_t space_i = 0; space_i < this->spaces.size(); space_i++)
   {
-    auto& space = this->spaces[space_i];
-    if (space.Fits(rect))
+    // Only use spaces on the given pages, unless no pages are given.
+    if (this->spaces[space_i].Fits(padded_width, padded_height) &&
+        (pages.empty() ||
+         std::binary_search(pages.begin(), pages.end(), this->spaces[space_i].GetPage())))
     {
+      const auto space = this->spaces[space_i];
+      this->eraseSpace(space_i);
       rect.Place(space.GetLeftX(), space.GetTopY(), space.GetPage());
       // If the extra space to the right of the rect is greater than the extra space bellow...
-      if (space.GetWidth() - rect.GetWidth() > space.GetHeight() - rect.GetHeight())
+      if (space.GetWidth() - padded_width > space.GetHeight() - padded_height)
       {
         // If there is leftover space to the right of the rect within the containing space...
-        if (rect.GetWidth() < space.GetWidth())
+        if (padded_width < space.GetWidth())
         {
           // Place a space to the right that reaches down to the bottom of the rect.
-          this->spaces.emplace_back(rect.GetLeftX() + rect.GetWidth(), rect.GetTopY(), space.GetPage(),
-                                    space.GetWidth() - rect.GetWidth(), rect.GetHeight());
+          this->addSpace(rect.GetLeftX() + padded_width, rect.GetTopY(), space.GetPage(),
+                         space.GetWidth() - padded_width, padded_height);
         }
         // If there is leftover space bellow the rect within the containing space...
-        if (rect.GetHeight() < space.GetHeight())
+        if (padded_height < space.GetHeight())
         {
           // Place a space bellow that reaches to the right of the containing space.
-          this->spaces.emplace_back(rect.GetLeftX(), rect.GetTopY() + rect.GetHeight(), space.GetPage(), space.GetWidth(),
-                                    space.GetHeight() - rect.GetHeight());
+          this->addSpace(rect.GetLeftX(), rect.GetTopY() + padded_height, space.GetPage(), space.GetWidth(),
+                         space.GetHeight() - padded_height);
         }
       }
       // If the space above and bellow are the same size, or the bottom gap is bigger than the
@@ -83,24 +555,21 @@ bool mpbp::Packer::tryPlaceSpace(mpbp::Rect& rect)
       else  // if (cur_space.width - cur_rect->width <= cur_space.height - cur_rect->height)
       {
         // If there is leftover space to the right of the rect within the containing space...
-        if (rect.GetWidth() < space.GetWidth())
+        if (padded_width < space.GetWidth())
         {
           // Place a space to the right of the rect that reaches down to the bottom of the
           // containing space.
-          this->spaces.emplace_back(rect.GetLeftX() + rect.GetWidth(), rect.GetTopY(), space.GetPage(),
-                                    space.GetWidth() - rect.GetWidth(), space.GetHeight());
+          this->addSpace(rect.GetLeftX() + padded_width, rect.GetTopY(), space.GetPage(),
+                         space.GetWidth() - padded_width, space.GetHeight());
         }
         // If there is leftover space bellow the rect within the containing space...
-        if (rect.GetHeight() < space.GetHeight())
+        if (padded_height < space.GetHeight())
         {
           // Place a space bellow the rect that reaches only to the width of the rect.
-          this->spaces.emplace_back(rect.GetLeftX(), rect.GetTopY() + rect.GetHeight(), space.GetPage(), rect.GetWidth(),
-                                    space.GetHeight() - rect.GetHeight());
+          this->addSpace(rect.GetLeftX(), rect.GetTopY() + padded_height, space.GetPage(), padded_width,
+                         space.GetHeight() - padded_height);
         }
       }
-      this->spaces[space_i] = this->spaces.back();
-      this->spaces.pop_back();
-      std::sort(this->spaces.begin(), this->spaces.end());
       return true;
     }
   }
@@ -109,36 +578,59 @@ bool mpbp::Packer::tryPlaceSpace(mpbp::Rect& rect)
 
 bool mpbp::Packer::tryPlaceExpandBin(mpbp::Rect& rect)
 {
+  if (this->closed_pages[this->getTopPageI()]) return false;
+  const auto padded_width = rect.GetWidth() + this->padding * 2;
+  const auto padded_height = rect.GetHeight() + this->padding * 2;
+  const auto right_x = alignUp(this->top_bin_width, this->alignment_x);
+  const auto bellow_y = alignUp(this->top_bin_height, this->alignment_y);
   auto place_rect_right = [&]()
   {
-    rect.Place(this->top_bin_width, 0, this->getTopPageI());
-    this->top_bin_width += rect.GetWidth();
-    if (rect.GetHeight() < this->top_bin_height)
+    rect.Place(right_x, 0, this->getTopPageI());
+    this->top_bin_width = right_x + padded_width;
+    if (padded_height < this->top_bin_height)
+    {
+      this->addSpace(rect.GetLeftX(), padded_height, this->getTopPageI(), padded_width,
+                     this->top_bin_height - padded_height);
+    }
+    else if (padded_height > this->top_bin_height)
     {
-      spaces.emplace_back(rect.GetLeftX(), rect.GetHeight(), this->getTopPageI(), rect.GetWidth(),
-                          this->top_bin_height - rect.GetHeight());
+      // The rect is taller than the bin, so the bin grows down to its bottom and the area bellow
+      // the old bin is left free.
+      this->addSpace(0, this->top_bin_height, this->getTopPageI(), right_x,
+                     padded_height - this->top_bin_height);
+      this->top_bin_height = padded_height;
     }
     if (this->page_count == 1)
     {
-      this->width = this->top_bin_width;
+      this->width = this->getUnpaddedWidth(this->top_bin_width);
+      this->height = this->getUnpaddedHeight(this->top_bin_height);
     }
   };
   auto place_rect_bellow = [&]()
   {
-    rect.Place(0, this->top_bin_height, this->getTopPageI());
-    this->top_bin_height += rect.GetHeight();
-    if (rect.GetWidth() < this->top_bin_width)
+    rect.Place(0, bellow_y, this->getTopPageI());
+    this->top_bin_height = bellow_y + padded_height;
+    if (padded_width < this->top_bin_width)
+    {
+      this->addSpace(padded_width, rect.GetTopY(), this->getTopPageI(),
+                     this->top_bin_width - padded_width, padded_height);
+    }
+    else if (padded_width > this->top_bin_width)
     {
-      spaces.emplace_back(rect.GetWidth(), rect.GetTopY(), this->getTopPageI(),
-                          this->top_bin_width - rect.GetWidth(), rect.GetHeight());
+      // The rect is wider than the bin, so the bin grows right to its right side and the area to
+      // the right of the old bin is left free.
+      this->addSpace(this->top_bin_width, 0, this->getTopPageI(),
+                     padded_width - this->top_bin_width, bellow_y);
+      this->top_bin_width = padded_width;
     }
     if (this->page_count == 1)
     {
-      this->height = this->top_bin_height;
+      this->width = this->getUnpaddedWidth(this->top_bin_width);
+      this->height = this->getUnpaddedHeight(this->top_bin_height);
     }
   };
-  const auto fits_bellow = this->top_bin_height + rect.GetHeight() <= this->max_height;
-  const auto fits_right = this->top_bin_width + rect.GetWidth() <= this->max_width;
+  const auto fits_bellow = bellow_y + padded_height <= this->getPaddedMaxHeight();
+  const auto fits_right = right_x + padded_width <= this->getPaddedMaxWidth();
   /*
       Weight the placement choice based on the placed bin has a larger width or height.
   */
@@ -168,75 +660,771 @@ bool mpbp::Packer::tryPlaceExpandBin(mpbp::Rect& rect)
   return false;
 }
 
+void mpbp::Packer::placeGrid(const std::span<mpbp::Rect> rects)
+{
+  std::size_t placed_count = 0;
+  while (placed_count < rects.size())
+  {
+    const auto remaining_rects = rects.subspan(placed_count);
+    const auto padded_width = remaining_rects.front().GetWidth() + this->padding * 2;
+    const auto padded_height = remaining_rects.front().GetHeight() + this->padding * 2;
+    const auto space_it = std::find_if(this->spaces.begin(), this->spaces.end(),
+                                       [&](const mpbp::Space& space)
+                                       { return space.Fits(padded_width, padded_height); });
+    if (space_it != this->spaces.end())
+    {
+      placed_count += this->fillSpaceGrid(space_it - this->spaces.begin(), remaining_rects);
+    }
+    else if (this->tryPlaceExpandBin(remaining_rects.front()))
+    {
+      // Expanding places one rect and leaves a strip of space beside it, which the next iteration
+      // fills with a grid.
+      placed_count++;
+    }
+    else
+    {
+      this->spaceLeftoverPage();
+      placed_count += this->placeGridPage(remaining_rects);
+    }
+  }
+}
+
+std::size_t mpbp::Packer::fillSpaceGrid(std::size_t space_i, const std::span<mpbp::Rect> rects)
+{
+  const auto space = this->spaces[space_i];
+  const auto rect_width = rects.front().GetWidth() + this->padding * 2;
+  const auto rect_height = rects.front().GetHeight() + this->padding * 2;
+  // The distance between the columns and rows, which keeps every rect of the grid aligned.
+  const auto column_pitch = alignUp(rect_width, this->alignment_x);
+  const auto row_pitch = alignUp(rect_height, this->alignment_y);
+  const auto columns = static_cast<std::size_t>((space.GetWidth() - rect_width) / column_pitch + 1);
+  const auto rows = static_cast<std::size_t>((space.GetHeight() - rect_height) / row_pitch + 1);
+  const auto count = std::min(columns * rows, rects.size());
+  for (std::size_t rect_i = 0; rect_i < count; rect_i++)
+  {
+    rects[rect_i].Place(space.GetLeftX() + static_cast<int>(rect_i % columns) * column_pitch,
+                        space.GetTopY() + static_cast<int>(rect_i / columns) * row_pitch,
+                        space.GetPage());
+  }
+  this->eraseSpace(space_i);
+  const auto used_columns = static_cast<int>(std::min(columns, count));
+  const auto used_rows = static_cast<int>((count + columns - 1) / columns);
+  const auto last_row_count = static_cast<int>(count % columns);
+  const auto grid_width = (used_columns - 1) * column_pitch + rect_width;
+  const auto grid_height = (used_rows - 1) * row_pitch + rect_height;
+  // The unused end of a partly filled last row.
+  if (last_row_count > 0 && last_row_count < used_columns)
+  {
+    this->addSpace(space.GetLeftX() + last_row_count * column_pitch,
+                   space.GetTopY() + (used_rows - 1) * row_pitch, space.GetPage(),
+                   grid_width - last_row_count * column_pitch, rect_height);
+  }
+  // The space to the right of the grid that reaches down to the bottom of the containing space.
+  if (grid_width < space.GetWidth())
+  {
+    this->addSpace(space.GetLeftX() + grid_width, space.GetTopY(), space.GetPage(),
+                   space.GetWidth() - grid_width, space.GetHeight());
+  }
+  // The space bellow the grid that reaches only to the width of the grid.
+  if (grid_height < space.GetHeight())
+  {
+    this->addSpace(space.GetLeftX(), space.GetTopY() + grid_height, space.GetPage(), grid_width,
+                   space.GetHeight() - grid_height);
+  }
+  return count;
+}
+
+std::size_t mpbp::Packer::placeGridPage(const std::span<mpbp::Rect> rects)
+{
+  this->placeNewPage(rects.front());
+  const auto rect_width = rects.front().GetWidth() + this->padding * 2;
+  const auto rect_height = rects.front().GetHeight() + this->padding * 2;
+  const auto column_pitch = alignUp(rect_width, this->alignment_x);
+  const auto row_pitch = alignUp(rect_height, this->alignment_y);
+  // Aim for a square grid, like the bin expansion does, so that the page can keep growing in both
+  // directions afterwards.
+  const auto square_columns = static_cast<std::size_t>(std::ceil(std::sqrt(
+      static_cast<double>(rects.size()) * row_pitch / static_cast<double>(column_pitch))));
+  const auto columns = std::clamp<std::size_t>(
+      square_columns, 1,
+      static_cast<std::size_t>((this->getPaddedMaxWidth() - rect_width) / column_pitch + 1));
+  const auto rows =
+      std::min(static_cast<std::size_t>((this->getPaddedMaxHeight() - rect_height) / row_pitch + 1),
+               (rects.size() + columns - 1) / columns);
+  const auto count = std::min(columns * rows, rects.size());
+  for (std::size_t rect_i = 1; rect_i < count; rect_i++)
+  {
+    rects[rect_i].Place(static_cast<int>(rect_i % columns) * column_pitch,
+                        static_cast<int>(rect_i / columns) * row_pitch, this->getTopPageI());
+  }
+  const auto used_columns = static_cast<int>(std::min(columns, count));
+  const auto used_rows = static_cast<int>((count + columns - 1) / columns);
+  const auto last_row_count = static_cast<int>(count % columns);
+  this->top_bin_width = (used_columns - 1) * column_pitch + rect_width;
+  this->top_bin_height = (used_rows - 1) * row_pitch + rect_height;
+  if (this->page_count == 1)
+  {
+    this->width = this->getUnpaddedWidth(this->top_bin_width);
+    this->height = this->getUnpaddedHeight(this->top_bin_height);
+  }
+  if (last_row_count > 0 && last_row_count < used_columns)
+  {
+    this->addSpace(last_row_count * column_pitch, (used_rows - 1) * row_pitch, this->getTopPageI(),
+                   this->top_bin_width - last_row_count * column_pitch, rect_height);
+  }
+  return count;
+}
+
 void mpbp::Packer::spaceLeftoverPage()
 {
-  if (this->top_bin_width < this->max_width)
+  if (!this->page_sizes.empty())
+  {
+    // Shrink the finished page to the smallest available size that still contains its rects. The
+    // size it grew within is always available, because it was available when the page was opened.
+    const auto size_i = this->findPageSize(this->top_bin_width, this->top_bin_height, false);
+    this->page_size_indices.push_back(size_i);
+    this->page_size_uses[size_i]++;
+    this->max_width = this->page_sizes[size_i].GetWidth();
+    this->max_height = this->page_sizes[size_i].GetHeight();
+  }
+  if (this->closed_pages[this->getTopPageI()]) return;
+  const auto padded_max_width = this->getPaddedMaxWidth();
+  const auto padded_max_height = this->getPaddedMaxHeight();
+  if (this->top_bin_width < padded_max_width)
   {
-    this->spaces.emplace_back(this->top_bin_width, 0, this->getTopPageI(), this->max_width - this->top_bin_width,
-                              this->top_bin_height);
+    this->addSpace(this->top_bin_width, 0, this->getTopPageI(), padded_max_width - this->top_bin_width,
+                   this->top_bin_height);
   }
-  if (this->top_bin_height < this->max_height)
+  if (this->top_bin_height < padded_max_height)
   {
-    this->spaces.emplace_back(0, this->top_bin_height, this->getTopPageI(), this->max_width,
-                              this->max_height - this->top_bin_height);
+    this->addSpace(0, this->top_bin_height, this->getTopPageI(), padded_max_width,
+                   padded_max_height - this->top_bin_height);
   }
 }
 
 void mpbp::Packer::placeNewPage(mpbp::Rect& rect)
 {
+  if (!this->page_sizes.empty())
+  {
+    // Let the new page grow within the largest available size so it can take as many rects as
+    // possible before it is shrunk.
+    const auto size_i = this->findPageSize(rect.GetWidth() + this->padding * 2,
+                                           rect.GetHeight() + this->padding * 2, true);
+    if (size_i < 0)
+    {
+      throw std::runtime_error("no page size is left that fits one or more rects");
+    }
+    this->max_width = this->page_sizes[size_i].GetWidth();
+    this->max_height = this->page_sizes[size_i].GetHeight();
+  }
   this->page_count++;
+  this->closed_pages.push_back(false);
+  this->placement_counts.push_back(0);
   rect.Place(0, 0, this->getTopPageI());
+  this->top_bin_width = rect.GetWidth() + this->padding * 2;
+  this->top_bin_height = rect.GetHeight() + this->padding * 2;
   if (this->page_count == 1)
   {
-    this->width = rect.GetWidth();
-    this->height = rect.GetHeight();
+    this->width = this->getUnpaddedWidth(this->top_bin_width);
+    this->height = this->getUnpaddedHeight(this->top_bin_height);
   }
   else
   {
     this->width = this->max_width;
     this->height = this->max_height;
   }
-  this->top_bin_width = rect.GetWidth();
-  this->top_bin_height = rect.GetHeight();
+}
+
+void mpbp::Packer::recordGroupPage(const mpbp::Rect& rect)
+{
+  if (rect.GetGroup() < 0) return;
+  auto& pages = this->group_pages[rect.GetGroup()];
+  const auto page_it = std::lower_bound(pages.begin(), pages.end(), rect.GetPage());
+  if (page_it == pages.end() || *page_it != rect.GetPage())
+  {
+    pages.insert(page_it, rect.GetPage());
+    if (!this->checkpoints.empty())
+    {
+      this->group_page_edits.emplace_back(rect.GetGroup(), rect.GetPage());
+    }
+  }
+}
+
+void mpbp::Packer::countPlacement(int page, int count)
+{
+  this->placement_counts[page] += count;
+  if (!this->checkpoints.empty()) this->placement_count_edits.emplace_back(page, count);
+}
+
+void mpbp::Packer::dropTopPage()
+{
+  const auto top_page = this->getTopPageI();
+  if (this->closed_pages[top_page]) this->closed_page_count--;
+  this->closed_pages.pop_back();
+  this->placement_counts.pop_back();
+  this->page_count--;
+  for (auto& [group, pages] : this->group_pages)
+  {
+    if (!pages.empty() && pages.back() == top_page) pages.pop_back();
+  }
+  std::erase_if(this->group_pages, [](const auto& group_page) { return group_page.second.empty(); });
+  // The new top page was finished when the dropped page was opened, so its leftover area is
+  // already Space and its bin is the whole page.
+  if (!this->page_sizes.empty())
+  {
+    const auto size_i = this->page_size_indices.back();
+    this->page_size_indices.pop_back();
+    this->page_size_uses[size_i]--;
+    this->max_width = this->page_sizes[size_i].GetWidth();
+    this->max_height = this->page_sizes[size_i].GetHeight();
+  }
+  this->top_bin_width = this->getPaddedMaxWidth();
+  this->top_bin_height = this->getPaddedMaxHeight();
 }
 
 int mpbp::Packer::getTopPageI() const noexcept { return this->page_count - 1; }
 
-void mpbp::Packer::Pack(const std::span<mpbp::Rect> rects)
+int mpbp::Packer::getPaddedMaxWidth() const noexcept
+{
+  // Rects may touch the edges of a page, so only the padding that reaches past them is added.
+  return this->max_width + this->padding * 2;
+}
+
+int mpbp::Packer::getPaddedMaxHeight() const noexcept
+{
+  return this->max_height + this->padding * 2;
+}
+
+int mpbp::Packer::getUnpaddedWidth(int padded_width) const noexcept
+{
+  return std::min(alignUp(padded_width - this->padding * 2, this->alignment_x), this->max_width);
+}
+
+int mpbp::Packer::getUnpaddedHeight(int padded_height) const noexcept
+{
+  return std::min(alignUp(padded_height - this->padding * 2, this->alignment_y), this->max_height);
+}
+
+bool mpbp::Packer::canRejectFit(const std::span<const mpbp::Rect> rects) const
+{
+  if (this->page_count == 0) return true;
+  // Summarize the free area and the widest and tallest Space of each page. A rect can only fit on
+  // a page whose widest and tallest Space are both at least as large as the rect.
+  struct PageSummary
+  {
+    long long free_area = 0;
+    int widest = 0;
+    int tallest = 0;
+  };
+  std::vector<PageSummary> summaries(this->page_count);
+  long long free_area = 0;
+  for (const auto& space : this->spaces)
+  {
+    auto& summary = summaries[space.GetPage()];
+    const auto area = static_cast<long long>(space.GetWidth()) * space.GetHeight();
+    summary.free_area += area;
+    summary.widest = std::max(summary.widest, space.GetWidth());
+    summary.tallest = std::max(summary.tallest, space.GetHeight());
+    free_area += area;
+  }
+  // The top page can still grow to the right of and bellow its bounding rectangle.
+  if (!this->closed_pages[this->getTopPageI()])
+  {
+    auto& summary = summaries[this->getTopPageI()];
+    const auto padded_max_width = this->getPaddedMaxWidth();
+    const auto padded_max_height = this->getPaddedMaxHeight();
+    const auto growth_area = static_cast<long long>(padded_max_width) * padded_max_height -
+                             static_cast<long long>(this->top_bin_width) * this->top_bin_height;
+    summary.free_area += growth_area;
+    if (this->top_bin_width < padded_max_width)
+    {
+      summary.widest = std::max(summary.widest, padded_max_width - this->top_bin_width);
+      summary.tallest = padded_max_height;
+    }
+    if (this->top_bin_height < padded_max_height)
+    {
+      summary.widest = padded_max_width;
+      summary.tallest = std::max(summary.tallest, padded_max_height - this->top_bin_height);
+    }
+    free_area += growth_area;
+  }
+  long long rect_area = 0;
+  for (const auto& rect : rects)
+  {
+    const auto padded_width = rect.GetWidth() + this->padding * 2;
+    const auto padded_height = rect.GetHeight() + this->padding * 2;
+    const auto padded_area = static_cast<long long>(padded_width) * padded_height;
+    rect_area += padded_area;
+    const auto fits_any_page =
+        std::any_of(summaries.begin(), summaries.end(),
+                    [&](const PageSummary& summary)
+                    {
+                      return padded_width <= summary.widest && padded_height <= summary.tallest &&
+                             padded_area <= summary.free_area;
+                    });
+    if (!fits_any_page) return true;
+  }
+  return rect_area > free_area;
+}
+
+mpbp::Packer mpbp::Packer::copyForQuery() const
+{
+  // Copy only the state that a pack reads, and leave out the undo logs and scratch memory.
+  mpbp::Packer packer;
+  packer.spaces = this->spaces;
+  packer.page_count = this->page_count;
+  packer.width = this->width;
+  packer.height = this->height;
+  packer.max_width = this->max_width;
+  packer.max_height = this->max_height;
+  packer.top_bin_width = this->top_bin_width;
+  packer.top_bin_height = this->top_bin_height;
+  packer.prune_mode = this->prune_mode;
+  packer.padding = this->padding;
+  packer.alignment_x = this->alignment_x;
+  packer.alignment_y = this->alignment_y;
+  packer.page_sizes = this->page_sizes;
+  packer.page_size_uses = this->page_size_uses;
+  packer.page_size_indices = this->page_size_indices;
+  packer.closed_pages = this->closed_pages;
+  packer.closed_page_count = this->closed_page_count;
+  packer.placement_counts = this->placement_counts;
+  packer.group_pages = this->group_pages;
+  return packer;
+}
+
+mpbp::Fit mpbp::Packer::QueryFit(const std::span<const mpbp::Rect> rects) const
+{
+  return this->QueryFit(rects, false);
+}
+
+mpbp::Fit mpbp::Packer::QueryFit(const std::span<const mpbp::Rect> rects,
+                                 bool count_new_pages) const
+{
+  if (rects.empty()) return mpbp::Fit(true, 0);
+  if (!count_new_pages && this->canRejectFit(rects)) return mpbp::Fit(false, -1);
+  auto packer = this->copyForQuery();
+  std::vector<mpbp::Rect> query_rects(rects.begin(), rects.end());
+  packer.Pack(query_rects);
+  const auto new_page_count = packer.page_count - this->page_count;
+  if (new_page_count > 0 && !count_new_pages) return mpbp::Fit(false, -1);
+  return mpbp::Fit(new_page_count == 0, new_page_count);
+}
+
+void mpbp::Packer::Remove(const mpbp::Rect& rect)
+{
+  if (rect.GetPage() < 0 || rect.GetPage() >= this->page_count ||
+      this->placement_counts[rect.GetPage()] == 0)
+  {
+    throw std::runtime_error("rect is not placed in the packer");
+  }
+  const auto page = rect.GetPage();
+  const auto right_x = rect.GetLeftX() + rect.GetWidth() + this->padding * 2;
+  const auto bottom_y = rect.GetTopY() + rect.GetHeight() + this->padding * 2;
+  // Placed Rect never overlap free Space, so an overlap means that the area is already free.
+  const auto overlaps_space = std::any_of(
+      this->spaces.begin(), this->spaces.end(),
+      [&](const mpbp::Space& space)
+      {
+        return space.GetPage() == page && space.GetLeftX() < right_x &&
+               rect.GetLeftX() < space.GetLeftX() + space.GetWidth() &&
+               space.GetTopY() < bottom_y && rect.GetTopY() < space.GetTopY() + space.GetHeight();
+      });
+  if (overlaps_space)
+  {
+    throw std::runtime_error("rect area is already free");
+  }
+  this->countPlacement(page, -1);
+  if (this->closed_pages[page]) return;
+  this->addSpace(rect.GetLeftX(), rect.GetTopY(), page, rect.GetWidth() + this->padding * 2,
+                 rect.GetHeight() + this->padding * 2);
+}
+
+std::vector<mpbp::Move> mpbp::Packer::DropTopPages(const std::span<mpbp::Rect> rects)
+{
+  return this->DropTopPages(rects, std::numeric_limits<long long>::max());
+}
+
+std::vector<mpbp::Move> mpbp::Packer::DropTopPages(const std::span<mpbp::Rect> rects,
+                                                   long long move_budget)
+{
+  if (move_budget < 0)
+  {
+    throw std::runtime_error("invalid move budget");
+  }
+  if (!this->checkpoints.empty())
+  {
+    throw std::runtime_error("can not drop pages while a checkpoint is active");
+  }
+  std::vector<int> rect_counts(this->page_count, 0);
+  for (const auto& rect : rects)
+  {
+    if (rect.GetPage() < 0 || rect.GetPage() >= this->page_count)
+    {
+      throw std::runtime_error("one or more rects are not placed in the packer");
+    }
+    rect_counts[rect.GetPage()]++;
+  }
+  // A Rect that is missing from the span would be left behind on its dropped page, and one that was
+  // removed would take area that later packs may use.
+  if (rect_counts != this->placement_counts)
+  {
+    throw std::runtime_error("the rects do not match the placements of the packer");
+  }
+  std::vector<mpbp::Move> moves;
+  // Copies of the Rect of the top page. The identifier of each copy is the index of its Rect in the
+  // span, so the copies can be sorted and placed without changing the span until the moves are
+  // kept.
+  std::vector<mpbp::Rect> evacuated_rects;
+  // The index of the move of each Rect of the span. A Rect that is moved onto a page that is later
+  // dropped is moved again, which only changes the destination of its move.
+  constexpr auto unmoved = std::numeric_limits<std::size_t>::max();
+  std::vector<std::size_t> move_indices(rects.size(), unmoved);
+  while (this->page_count > 1)
+  {
+    const auto top_page = this->getTopPageI();
+    evacuated_rects.clear();
+    long long moved_area = 0;
+    for (std::size_t rect_i = 0; rect_i < rects.size(); rect_i++)
+    {
+      const auto& rect = rects[rect_i];
+      if (rect.GetPage() != top_page) continue;
+      evacuated_rects.emplace_back(rect_i, rect.GetWidth(), rect.GetHeight(), rect.GetGroup());
+      if (move_indices[rect_i] == unmoved)
+      {
+        moved_area += static_cast<long long>(rect.GetWidth()) * rect.GetHeight();
+      }
+    }
+    if (moved_area > move_budget) break;
+    std::sort(evacuated_rects.begin(), evacuated_rects.end(), std::greater());
+    this->Checkpoint();
+    if (!this->closed_pages[top_page])
+    {
+      this->closePage(top_page);
+      this->releaseClosedSpaces();
+    }
+    const auto all_moved =
+        std::all_of(evacuated_rects.begin(), evacuated_rects.end(),
+                    [&](mpbp::Rect& rect) { return this->tryPlaceSpace(rect, {}); });
+    if (!all_moved)
+    {
+      this->Rollback();
+      break;
+    }
+    this->Commit();
+    move_budget -= moved_area;
+    for (const auto& evacuated_rect : evacuated_rects)
+    {
+      const auto rect_i = static_cast<std::size_t>(evacuated_rect.GetIdentifier());
+      auto& rect = rects[rect_i];
+      if (move_indices[rect_i] == unmoved)
+      {
+        move_indices[rect_i] = moves.size();
+        moves.emplace_back(rect.GetIdentifier(), rect.GetLeftX(), rect.GetTopY(), rect.GetPage(),
+                           rect.GetLeftX(), rect.GetTopY(), rect.GetPage(), rect.GetWidth(),
+                           rect.GetHeight());
+      }
+      auto& move = moves[move_indices[rect_i]];
+      move = mpbp::Move(rect.GetIdentifier(), move.GetFromLeftX(), move.GetFromTopY(),
+                        move.GetFromPage(), evacuated_rect.GetLeftX(), evacuated_rect.GetTopY(),
+                        evacuated_rect.GetPage(), rect.GetWidth(), rect.GetHeight());
+      rect.Place(evacuated_rect.GetLeftX(), evacuated_rect.GetTopY(), evacuated_rect.GetPage());
+      this->recordGroupPage(rect);
+      this->countPlacement(rect.GetPage(), 1);
+    }
+    this->dropTopPage();
+  }
+  return moves;
+}
+
+void mpbp::Packer::Pack(const std::span<mpbp::Rect> rects) { this->Pack(rects, 0, nullptr); }
+
+void mpbp::Packer::Pack(
+    const std::span<mpbp::Rect> rects, int open_page_limit,
+    const std::function<void(int page, std::span<const mpbp::Rect> placed_rects)>& page_finished)
 {
+  if (open_page_limit < 0)
+  {
+    throw std::runtime_error("invalid open page limit");
+  }
   if (rects.size() == 0) return;
-  if (this->max_width == 0 || this->max_height == 0)
+  const auto has_page_sizes = !this->page_sizes.empty();
+  if (!has_page_sizes && (this->max_width == 0 || this->max_height == 0))
   {
     throw std::runtime_error("invalid max page dimensions");
   }
+  auto has_groups = false;
   for (const auto& rect : rects)
   {
+    has_groups = has_groups || rect.GetGroup() >= 0;
     if (rect.GetIsDegenerate())
     {
       throw std::runtime_error("one or more rects are degenerate");
     }
+    const auto fits_page =
+        has_page_sizes
+            ? std::any_of(this->page_sizes.begin(), this->page_sizes.end(),
+                          [&](const mpbp::PageSize& page_size)
+                          { return page_size.Fits(rect.GetWidth(), rect.GetHeight()); })
+            : rect.GetWidth() <= this->max_width && rect.GetHeight() <= this->max_height;
+    if (!fits_page)
+    {
+      throw std::runtime_error("one or more rects do not fit in bin");
+    }
+  }
+  if (has_groups)
+  {
+    // Pack group by group so that each group is placed close together. Groups are ordered by their
+    // total area, and rects without a group are ordered by their own area as groups of one.
+    std::unordered_map<int, long long> group_areas;
+    for (const auto& rect : rects)
+    {
+      if (rect.GetGroup() < 0) continue;
+      group_areas[rect.GetGroup()] += static_cast<long long>(rect.GetWidth()) * rect.GetHeight();
+    }
+    auto sort_area = [&](const mpbp::Rect& rect)
+    {
+      if (rect.GetGroup() < 0) return static_cast<long long>(rect.GetWidth()) * rect.GetHeight();
+      return group_areas.find(rect.GetGroup())->second;
+    };
+    std::sort(rects.begin(), rects.end(),
+              [&](const mpbp::Rect& a, const mpbp::Rect& b)
+              {
+                const auto a_area = sort_area(a);
+                const auto b_area = sort_area(b);
+                if (a_area != b_area) return a_area > b_area;
+                if (a.GetGroup() != b.GetGroup()) return a.GetGroup() < b.GetGroup();
+                return a > b;
+              });
+  }
+  else
+  {
+    std::sort(rects.begin(), rects.end(), std::greater());
+    // Order each run of rects of the same max dimension by their size, so that rects of identical
+    // size are next to each other and can be placed as grids. Runs that are already of one size
+    // are left as they are, which keeps this a single pass for inputs of uniform tiles.
+    for (auto segment_begin = rects.begin(); segment_begin != rects.end();)
+    {
+      const auto max_dimension = segment_begin->GetMaxDimension();
+      auto is_uniform = true;
+      auto segment_end = segment_begin + 1;
+      for (; segment_end != rects.end() && segment_end->GetMaxDimension() == max_dimension;
+           segment_end++)
+      {
+        is_uniform = is_uniform && segment_end->GetWidth() == segment_begin->GetWidth() &&
+                     segment_end->GetHeight() == segment_begin->GetHeight();
+      }
+      if (!is_uniform)
+      {
+        std::sort(segment_begin, segment_end,
+                  [](const mpbp::Rect& a, const mpbp::Rect& b)
+                  {
+                    if (a.GetWidth() != b.GetWidth()) return a.GetWidth() > b.GetWidth();
+                    return a.GetHeight() > b.GetHeight();
+                  });
+      }
+      segment_begin = segment_end;
+    }
   }
-  std::sort(rects.begin(), rects.end(), std::greater());
   std::size_t rect_i = 0;
   auto rect = &rects[rect_i++];
-  if (rect->GetWidth() > this->max_width || rect->GetHeight() > this->max_height)
+  this->reserveSpaces(rects);
+  // The smallest width and height of the rects at and after each index, used to find spaces that
+  // no remaining rect can fit in.
+  std::vector<std::pair<int, int>> remaining_minimums;
+  if (this->prune_mode != mpbp::PruneMode::Keep || page_finished)
   {
-    throw std::runtime_error("one or more rects do not fit in bin");
+    remaining_minimums.resize(rects.size());
+    auto minimums = std::make_pair(std::numeric_limits<int>::max(), std::numeric_limits<int>::max());
+    for (std::size_t min_i = rects.size(); min_i > 0; min_i--)
+    {
+      minimums.first = std::min(minimums.first, rects[min_i - 1].GetWidth() + this->padding * 2);
+      minimums.second =
+          std::min(minimums.second, rects[min_i - 1].GetHeight() + this->padding * 2);
+      remaining_minimums[min_i - 1] = minimums;
+    }
   }
-  this->reserveSpaces(rects);
-  auto top_page_i = [&]() -> int { return this->page_count - 1; };
+  auto prune_remaining = [&]()
+  {
+    if (this->prune_mode == mpbp::PruneMode::Keep || rect_i >= rects.size()) return;
+    const auto [min_width, min_height] = remaining_minimums[rect_i];
+    if (min_width == this->prune_width && min_height == this->prune_height) return;
+    this->prune_width = min_width;
+    this->prune_height = min_height;
+    this->pruneSpaces();
+  };
+  // The pages that rects of this pack were placed on, and which of them were reported as final.
+  std::vector<bool> used_pages;
+  std::vector<bool> finished_pages;
+  std::size_t used_rect_i = 0;
+  auto checked_page_count = -1;
+  auto checked_minimums = std::make_pair(0, 0);
+  auto finish_page = [&](int page)
+  {
+    finished_pages[page] = true;
+    page_finished(page, rects.first(rect_i));
+  };
+  auto finish_pages = [&]()
+  {
+    if (!page_finished) return;
+    used_pages.resize(this->page_count, false);
+    finished_pages.resize(this->page_count, false);
+    for (; used_rect_i < rect_i; used_rect_i++) used_pages[rects[used_rect_i].GetPage()] = true;
+    if (rect_i >= rects.size()) return;
+    const auto minimums = remaining_minimums[rect_i];
+    if (this->page_count == checked_page_count && minimums == checked_minimums) return;
+    checked_page_count = this->page_count;
+    checked_minimums = minimums;
+    // Only the spaces at least as large as the larger minimum can fit a remaining rect, and they
+    // are at the end of the sorted spaces.
+    std::vector<bool> open_pages(this->page_count, false);
+    open_pages[this->getTopPageI()] = true;
+    const auto min_dimension = std::max(minimums.first, minimums.second);
+    for (auto space_it = std::partition_point(this->spaces.begin(), this->spaces.end(),
+                                              [&](const mpbp::Space& space)
+                                              { return space.GetMaxDimension() < min_dimension; });
+         space_it != this->spaces.end(); space_it++)
+    {
+      if (space_it->Fits(minimums.first, minimums.second)) open_pages[space_it->GetPage()] = true;
+    }
+    auto open_page_count = 0;
+    for (int page = 0; page < this->page_count; page++)
+    {
+      if (!used_pages[page] || finished_pages[page]) continue;
+      if (open_pages[page])
+      {
+        open_page_count++;
+        continue;
+      }
+      finish_page(page);
+    }
+    if (open_page_limit == 0) return;
+    auto closed_any = false;
+    for (int page = 0; page < this->getTopPageI() && open_page_count > open_page_limit; page++)
+    {
+      if (!used_pages[page] || finished_pages[page]) continue;
+      if (!this->closed_pages[page])
+      {
+        this->closePage(page);
+        closed_any = true;
+      }
+      open_page_count--;
+      finish_page(page);
+    }
+    if (closed_any) this->releaseClosedSpaces();
+  };
   auto next_rect = [&]() { rect = &rects[rect_i++]; };
   if (this->page_count == 0)
   {
     this->placeNewPage(*rect);
+    this->recordGroupPage(*rect);
+    this->countPlacement(rect->GetPage(), 1);
+    prune_remaining();
+    finish_pages();
     next_rect();
   }
   for (; rect_i <= rects.size(); next_rect())
   {
-    if (this->tryPlaceSpace(*rect)) continue;
-    if (this->tryPlaceExpandBin(*rect)) continue;
-    this->spaceLeftoverPage();
-    this->placeNewPage(*rect);
+    if (rect->GetGroup() < 0)
+    {
+      auto run_end = rect_i;
+      while (run_end < rects.size() && rects[run_end].GetGroup() < 0 &&
+             rects[run_end].GetWidth() == rect->GetWidth() &&
+             rects[run_end].GetHeight() == rect->GetHeight())
+      {
+        run_end++;
+      }
+      const auto run_start = rect_i - 1;
+      if (run_end - run_start >= Packer::grid_run_length)
+      {
+        this->placeGrid(rects.subspan(run_start, run_end - run_start));
+        for (auto grid_i = run_start; grid_i < run_end; grid_i++)
+        {
+          this->countPlacement(rects[grid_i].GetPage(), 1);
+        }
+        rect_i = run_end;
+        prune_remaining();
+        finish_pages();
+        continue;
+      }
+    }
+    // Rects of a group try the pages that the group already touches before any other page.
+    const auto group_pages_it = rect->GetGroup() < 0 ? this->group_pages.end()
+                                                     : this->group_pages.find(rect->GetGroup());
+    const auto has_group_pages = group_pages_it != this->group_pages.end();
+    const auto top_page_in_group =
+        has_group_pages && std::binary_search(group_pages_it->second.begin(),
+                                              group_pages_it->second.end(), this->getTopPageI());
+    if (!(has_group_pages && this->tryPlaceSpace(*rect, group_pages_it->second)) &&
+        !(top_page_in_group && this->tryPlaceExpandBin(*rect)) &&
+        !this->tryPlaceSpace(*rect, {}) && !this->tryPlaceExpandBin(*rect))
+    {
+      this->spaceLeftoverPage();
+      this->placeNewPage(*rect);
+    }
+    this->recordGroupPage(*rect);
+    this->countPlacement(rect->GetPage(), 1);
+    prune_remaining();
+    finish_pages();
+  }
+  this->prune_width = 0;
+  this->prune_height = 0;
+  if (this->prune_mode == mpbp::PruneMode::SetAside && !this->pruned_spaces.empty())
+  {
+    this->restorePrunedSpaces();
+  }
+  this->closeFullPages();
+  if (this->shrink_to_fit) this->spaces.shrink_to_fit();
+  if (page_finished)
+  {
+    rect_i = rects.size();
+    finish_pages();
+    for (int page = 0; page < this->page_count; page++)
+    {
+      if (used_pages[page] && !finished_pages[page]) finish_page(page);
+    }
+  }
+}
+
+void mpbp::Packer::Pack(const std::span<mpbp::Rect> rects,
+                        const std::span<const std::uint64_t> content_hashes)
+{
+  if (content_hashes.size() != rects.size())
+  {
+    throw std::runtime_error("content hash count does not match rect count");
+  }
+  // Pick the first rect of each hash and size as its representative. The identifier of each
+  // representative is its own index so that its placement can be found again after it is sorted by
+  // the pack.
+  std::unordered_map<ContentKey, std::size_t, ContentKeyHash> representative_by_key;
+  representative_by_key.reserve(rects.size());
+  std::vector<std::size_t> representative_indices(rects.size());
+  std::vector<mpbp::Rect> representatives;
+  for (std::size_t rect_i = 0; rect_i < rects.size(); rect_i++)
+  {
+    const auto& rect = rects[rect_i];
+    const auto [key_it, inserted] = representative_by_key.try_emplace(
+        ContentKey{content_hashes[rect_i], rect.GetWidth(), rect.GetHeight()},
+        representatives.size());
+    representative_indices[rect_i] = key_it->second;
+    if (!inserted) continue;
+    representatives.emplace_back(representatives.size(), rect.GetWidth(), rect.GetHeight(),
+                                 rect.GetGroup());
+  }
+  this->Pack(representatives);
+  std::vector<const mpbp::Rect*> placed_representatives(representatives.size());
+  for (const auto& representative : representatives)
+  {
+    placed_representatives[representative.GetIdentifier()] = &representative;
+  }
+  for (std::size_t rect_i = 0; rect_i < rects.size(); rect_i++)
+  {
+    const auto& representative = *placed_representatives[representative_indices[rect_i]];
+    rects[rect_i].Place(representative.GetLeftX(), representative.GetTopY(),
+                        representative.GetPage());
+    // A duplicate may be in a different group than its representative, and its group is on the
+    // page of the shared placement too.
+    this->recordGroupPage(rects[rect_i]);
   }
-  this->spaces.shrink_to_fit();
+  this->duplicate_count += rects.size() - representatives.size();
 }
@@ -0,0 +1,33 @@
+// SPDX-FileCopyrightText: 2022 Daniel Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+#include <mpbp/PageSize.hpp>
+
+mpbp::PageSize::PageSize(int width, int height) noexcept : width(width), height(height) {}
+
+mpbp::PageSize::PageSize(int width, int height, int count_limit) noexcept
+    : width(width), height(height), count_limit(count_limit)
+{
+}
+
+int mpbp::PageSize::GetWidth() const noexcept { return this->width; }
+
+int mpbp::PageSize::GetHeight() const noexcept { return this->height; }
+
+long long mpbp::PageSize::GetArea() const noexcept
+{
+  return static_cast<long long>(this->width) * this->height;
+}
+
+int mpbp::PageSize::GetCountLimit() const noexcept { return this->count_limit; }
+
+bool mpbp::PageSize::GetIsDegenerate() const noexcept
+{
+  return this->width <= 0 || this->height <= 0;
+}
+
+bool mpbp::PageSize::Fits(int width, int height) const noexcept
+{
+  return this->width >= width && this->height >= height;
+}
@@ -0,0 +1,96 @@
+// SPDX-FileCopyrightText: 2022 Daniel Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+#include <mpbp/PageStream.hpp>
+#include <stdexcept>
+#include <utility>
+
+mpbp::PackedPage::PackedPage(int page, int width, int height,
+                             std::vector<mpbp::Rect> rects) noexcept
+    : page(page), width(width), height(height), rects(std::move(rects))
+{
+}
+
+int mpbp::PackedPage::GetPage() const noexcept { return this->page; }
+
+int mpbp::PackedPage::GetWidth() const noexcept { return this->width; }
+
+int mpbp::PackedPage::GetHeight() const noexcept { return this->height; }
+
+const std::vector<mpbp::Rect>& mpbp::PackedPage::GetRects() const noexcept { return this->rects; }
+
+mpbp::PageStream::PageStream(mpbp::Packer& packer, const std::span<mpbp::Rect> rects)
+    : PageStream(packer, rects, 0)
+{
+}
+
+mpbp::PageStream::PageStream(mpbp::Packer& packer, const std::span<mpbp::Rect> rects,
+                             int open_page_limit)
+{
+  if (open_page_limit < 0)
+  {
+    throw std::runtime_error("invalid open page limit");
+  }
+  this->thread = std::thread([this, &packer, rects, open_page_limit]()
+                             { this->run(packer, rects, open_page_limit); });
+}
+
+mpbp::PageStream::~PageStream() { this->thread.join(); }
+
+bool mpbp::PageStream::Next(mpbp::PackedPage& page)
+{
+  std::unique_lock lock(this->mutex);
+  this->page_condition.wait(lock, [&]() { return !this->pages.empty() || this->finished; });
+  if (!this->pages.empty())
+  {
+    page = std::move(this->pages.front());
+    this->pages.pop_front();
+    return true;
+  }
+  if (this->exception != nullptr)
+  {
+    std::rethrow_exception(std::exchange(this->exception, nullptr));
+  }
+  return false;
+}
+
+void mpbp::PageStream::run(mpbp::Packer& packer, const std::span<mpbp::Rect> rects,
+                           int open_page_limit)
+{
+  // The placed rects are the front of the sorted span, so each report only has to sort the rects
+  // placed since the last report into the pages they were placed on.
+  std::vector<std::vector<mpbp::Rect>> page_rects;
+  std::size_t sorted_rect_i = 0;
+  auto page_finished = [&](int page, std::span<const mpbp::Rect> placed_rects)
+  {
+    page_rects.resize(packer.GetPageCount());
+    for (; sorted_rect_i < placed_rects.size(); sorted_rect_i++)
+    {
+      const auto& rect = placed_rects[sorted_rect_i];
+      page_rects[rect.GetPage()].push_back(rect);
+    }
+    mpbp::PackedPage packed_page(page, packer.GetPageWidth(page), packer.GetPageHeight(page),
+                                 std::move(page_rects[page]));
+    {
+      std::lock_guard lock(this->mutex);
+      this->pages.push_back(std::move(packed_page));
+    }
+    this->page_condition.notify_one();
+  };
+  std::exception_ptr pack_exception = nullptr;
+  try
+  {
+    packer.Pack(rects, open_page_limit, page_finished);
+  }
+  catch (...)
+  {
+    pack_exception = std::current_exception();
+  }
+  {
+    std::lock_guard lock(this->mutex);
+    this->exception = pack_exception;
+    this->finished = true;
+  }
+  this->page_condition.notify_all();
+}
@@ -0,0 +1,542 @@
+// SPDX-FileCopyrightText: 2022 Daniel Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+#include <algorithm>
+#include <atomic>
+#include <mpbp/Bound.hpp>
+#include <mpbp/Packer.hpp>
+#include <mpbp/Solver.hpp>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace
+{
+  // Branches of the search for the first items are run as separate tasks, so that idle threads
+  // can steal them.
+  constexpr std::size_t split_depth = 3;
+  // The amount of nodes each search counts by itself before it adds them to the shared count.
+  constexpr long long node_batch_size = 256;
+
+  struct Item
+  {
+    int width;
+    int height;
+    long long area;
+    std::size_t rect_i;
+    // The index of the size of the item among all distinct sizes. Items of the same size are next
+    // to each other after sorting, so they have consecutive items with the same size index.
+    int size_i;
+    // If the item is more than half as wide and more than half as tall as a page, in which case no
+    // two such items can share a page.
+    bool is_big;
+  };
+
+  // The right and bottom sides are exclusive.
+  struct Placed
+  {
+    std::size_t item_i;
+    int left_x;
+    int top_y;
+    int right_x;
+    int bottom_y;
+  };
+
+  // The limits and the result shared by every task of a search.
+  struct SearchControl
+  {
+    long long node_limit = 0;
+    bool has_deadline = false;
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point();
+    std::atomic<long long> node_count = 0;
+    std::atomic<bool> aborted = false;
+    std::atomic<bool> found = false;
+    std::mutex solution_mutex = std::mutex();
+    std::vector<int> solution_pages = std::vector<int>();
+
+    bool GetShouldStop() const noexcept { return this->aborted || this->found; }
+
+    void CountNodes(long long count)
+    {
+      const auto node_count = this->node_count.fetch_add(count) + count;
+      if ((this->node_limit > 0 && node_count >= this->node_limit) ||
+          (this->has_deadline && std::chrono::steady_clock::now() >= this->deadline))
+      {
+        this->aborted = true;
+      }
+    }
+
+    void RecordSolution(const std::vector<int>& pages)
+    {
+      std::lock_guard lock(this->solution_mutex);
+      if (this->found) return;
+      this->solution_pages = pages;
+      this->found = true;
+    }
+  };
+
+  // Counts the nodes of one thread of a search, and reports if the search should stop.
+  class NodeCounter
+  {
+   private:
+    SearchControl* control = nullptr;
+    long long pending_count = 0;
+
+   public:
+    explicit NodeCounter(SearchControl* control) noexcept : control(control) {}
+
+    ~NodeCounter()
+    {
+      if (this->control) this->control->CountNodes(this->pending_count);
+    }
+
+    bool Count()
+    {
+      if (!this->control) return true;
+      if (++this->pending_count >= node_batch_size)
+      {
+        this->control->CountNodes(this->pending_count);
+        this->pending_count = 0;
+      }
+      return !this->control->GetShouldStop();
+    }
+  };
+
+  // Finds positions for a set of items within one page, placing each item at a corner point of the
+  // staircase formed by the items placed before it. Any feasible packing of a page can be reached
+  // this way by choosing the right order of items, so trying every order is exhaustive.
+  class PageSearch
+  {
+   private:
+    const std::vector<Item>& items;
+    const std::vector<std::size_t>& page_items;
+    int max_width;
+    int max_height;
+    NodeCounter& counter;
+    std::vector<Placed> placed = std::vector<Placed>();
+    std::vector<bool> used = std::vector<bool>();
+    long long remaining_area = 0;
+    bool aborted = false;
+
+    // Find the corner points of the staircase, and the area under it that no item can be placed in.
+    std::vector<std::pair<int, int>> cornerPoints(long long& covered_area) const
+    {
+      covered_area = 0;
+      if (this->placed.empty()) return {{0, 0}};
+      auto envelope = this->placed;
+      std::sort(envelope.begin(), envelope.end(),
+                [](const Placed& a, const Placed& b)
+                {
+                  if (a.bottom_y != b.bottom_y) return a.bottom_y > b.bottom_y;
+                  return a.right_x > b.right_x;
+                });
+      std::vector<std::pair<int, int>> corners;
+      int max_right_x = 0;
+      for (const auto& item : envelope)
+      {
+        // Items that do not reach further right than a lower item are hidden by the staircase.
+        if (item.right_x <= max_right_x) continue;
+        corners.emplace_back(max_right_x, item.bottom_y);
+        covered_area += static_cast<long long>(item.right_x - max_right_x) * item.bottom_y;
+        max_right_x = item.right_x;
+      }
+      corners.emplace_back(max_right_x, 0);
+      return corners;
+    }
+
+    bool place()
+    {
+      if (this->placed.size() == this->page_items.size()) return true;
+      if (!this->counter.Count())
+      {
+        this->aborted = true;
+        return false;
+      }
+      long long covered_area = 0;
+      const auto corners = this->cornerPoints(covered_area);
+      if (covered_area + this->remaining_area >
+          static_cast<long long>(this->max_width) * this->max_height)
+      {
+        return false;
+      }
+      auto tried_size_i = -1;
+      for (std::size_t page_item_i = 0; page_item_i < this->page_items.size(); page_item_i++)
+      {
+        if (this->used[page_item_i]) continue;
+        const auto item_i = this->page_items[page_item_i];
+        const auto& item = this->items[item_i];
+        // Placing an item of the same size as the one just tried leads to the same packings.
+        if (item.size_i == tried_size_i) continue;
+        tried_size_i = item.size_i;
+        for (const auto& [left_x, top_y] : corners)
+        {
+          if (left_x + item.width > this->max_width || top_y + item.height > this->max_height)
+          {
+            continue;
+          }
+          this->placed.push_back(
+              {item_i, left_x, top_y, left_x + item.width, top_y + item.height});
+          this->used[page_item_i] = true;
+          this->remaining_area -= item.area;
+          if (this->place()) return true;
+          this->remaining_area += item.area;
+          this->used[page_item_i] = false;
+          this->placed.pop_back();
+          if (this->aborted) return false;
+        }
+      }
+      return false;
+    }
+
+   public:
+    PageSearch(const std::vector<Item>& items, const std::vector<std::size_t>& page_items,
+               int max_width, int max_height, NodeCounter& counter)
+        : items(items),
+          page_items(page_items),
+          max_width(max_width),
+          max_height(max_height),
+          counter(counter),
+          used(page_items.size(), false)
+    {
+    }
+
+    bool Run()
+    {
+      // Items that fit side by side in a single row or column need no search.
+      long long total_width = 0;
+      long long total_height = 0;
+      for (const auto item_i : this->page_items)
+      {
+        total_width += this->items[item_i].width;
+        total_height += this->items[item_i].height;
+        this->remaining_area += this->items[item_i].area;
+      }
+      if (total_width <= this->max_width || total_height <= this->max_height)
+      {
+        auto offset = 0;
+        for (const auto item_i : this->page_items)
+        {
+          const auto& item = this->items[item_i];
+          const auto left_x = total_width <= this->max_width ? offset : 0;
+          const auto top_y = total_width <= this->max_width ? 0 : offset;
+          this->placed.push_back(
+              {item_i, left_x, top_y, left_x + item.width, top_y + item.height});
+          offset += total_width <= this->max_width ? item.width : item.height;
+        }
+        return true;
+      }
+      return this->place();
+    }
+
+    bool GetAborted() const noexcept { return this->aborted; }
+
+    const std::vector<Placed>& GetPlaced() const noexcept { return this->placed; }
+  };
+
+  // The pages that the items before an index of the search are assigned to.
+  struct Assignment
+  {
+    std::vector<int> pages;
+    std::vector<long long> page_areas;
+    std::vector<bool> page_has_big;
+    int used_page_count = 0;
+    int big_page_count = 0;
+  };
+
+  // The data that is shared by every task of the search for a packing into a number of pages.
+  struct SearchContext
+  {
+    const std::vector<Item>& items;
+    // The total area, smallest area, and amount of big items of the items at and after each index.
+    const std::vector<long long>& suffix_areas;
+    const std::vector<long long>& suffix_min_areas;
+    const std::vector<int>& suffix_big_counts;
+    int max_width;
+    int max_height;
+    int page_limit;
+    SearchControl& control;
+    mpbp::TaskGroup& task_group;
+  };
+
+  void submitSearch(const SearchContext& context, Assignment assignment, std::size_t item_i);
+
+  // Assigns items to pages one at a time in order of decreasing area, checking that each page can
+  // still fit its items after every assignment.
+  class AssignmentSearch
+  {
+   private:
+    const SearchContext& context;
+    NodeCounter counter;
+    // Whether a page with the given sizes of items is feasible, keyed by the size indices.
+    std::unordered_map<std::string, bool> feasible_pages = std::unordered_map<std::string, bool>();
+
+    bool pageFits(const Assignment& assignment, int page, std::size_t last_item_i)
+    {
+      std::vector<std::size_t> page_items;
+      std::string key;
+      for (std::size_t item_i = 0; item_i <= last_item_i; item_i++)
+      {
+        if (assignment.pages[item_i] != page) continue;
+        page_items.push_back(item_i);
+        const auto size_i = this->context.items[item_i].size_i;
+        key.append(reinterpret_cast<const char*>(&size_i), sizeof(size_i));
+      }
+      const auto feasible_it = this->feasible_pages.find(key);
+      if (feasible_it != this->feasible_pages.end()) return feasible_it->second;
+      PageSearch page_search(this->context.items, page_items, this->context.max_width,
+                             this->context.max_height, this->counter);
+      const auto fits = page_search.Run();
+      // An unfinished search proves nothing, so it is not remembered.
+      if (!page_search.GetAborted()) this->feasible_pages.emplace(std::move(key), fits);
+      return fits;
+    }
+
+    bool remainingFits(const Assignment& assignment, std::size_t item_i) const
+    {
+      const auto page_area =
+          static_cast<long long>(this->context.max_width) * this->context.max_height;
+      const auto min_area = this->context.suffix_min_areas[item_i];
+      // Free area on a page that is too small for every remaining item is wasted.
+      long long free_area =
+          static_cast<long long>(this->context.page_limit - assignment.used_page_count) *
+          page_area;
+      for (int page = 0; page < assignment.used_page_count; page++)
+      {
+        const auto page_free_area = page_area - assignment.page_areas[page];
+        if (page_free_area >= min_area) free_area += page_free_area;
+      }
+      if (this->context.suffix_areas[item_i] > free_area) return false;
+      // Every remaining big item needs a page without another big item.
+      return this->context.suffix_big_counts[item_i] <=
+             this->context.page_limit - assignment.big_page_count;
+    }
+
+   public:
+    explicit AssignmentSearch(const SearchContext& context)
+        : context(context), counter(&context.control)
+    {
+    }
+
+    void Search(Assignment& assignment, std::size_t item_i)
+    {
+      if (!this->counter.Count()) return;
+      const auto& items = this->context.items;
+      if (item_i == items.size())
+      {
+        this->context.control.RecordSolution(assignment.pages);
+        return;
+      }
+      if (!this->remainingFits(assignment, item_i)) return;
+      const auto& item = items[item_i];
+      const auto page_area =
+          static_cast<long long>(this->context.max_width) * this->context.max_height;
+      // Items of the same size are interchangeable, so they are assigned to pages in order. Empty
+      // pages are interchangeable too, so only the first empty page is tried.
+      const auto first_page =
+          item_i > 0 && items[item_i - 1].size_i == item.size_i ? assignment.pages[item_i - 1] : 0;
+      const auto last_page = std::min(assignment.used_page_count, this->context.page_limit - 1);
+      for (auto page = first_page; page <= last_page; page++)
+      {
+        if (assignment.page_areas[page] + item.area > page_area) continue;
+        if (item.is_big && assignment.page_has_big[page]) continue;
+        const auto opens_page = page == assignment.used_page_count;
+        assignment.pages[item_i] = page;
+        assignment.page_areas[page] += item.area;
+        if (opens_page) assignment.used_page_count++;
+        if (item.is_big)
+        {
+          assignment.page_has_big[page] = true;
+          assignment.big_page_count++;
+        }
+        if (opens_page || this->pageFits(assignment, page, item_i))
+        {
+          if (item_i < split_depth)
+          {
+            submitSearch(this->context, assignment, item_i + 1);
+          }
+          else
+          {
+            this->Search(assignment, item_i + 1);
+          }
+        }
+        if (item.is_big)
+        {
+          assignment.page_has_big[page] = false;
+          assignment.big_page_count--;
+        }
+        if (opens_page) assignment.used_page_count--;
+        assignment.page_areas[page] -= item.area;
+        assignment.pages[item_i] = -1;
+        if (this->context.control.GetShouldStop()) return;
+      }
+    }
+  };
+
+  void submitSearch(const SearchContext& context, Assignment assignment, std::size_t item_i)
+  {
+    context.task_group.Submit(
+        [&context, assignment = std::move(assignment), item_i]() mutable
+        {
+          AssignmentSearch search(context);
+          search.Search(assignment, item_i);
+        });
+  }
+}  // namespace
+
+mpbp::Solver::Solver(int max_width, int max_height) noexcept
+    : max_width(max_width), max_height(max_height)
+{
+}
+
+void mpbp::Solver::SetNodeLimit(long long node_limit)
+{
+  if (node_limit < 0)
+  {
+    throw std::runtime_error("invalid node limit");
+  }
+  this->node_limit = node_limit;
+}
+
+long long mpbp::Solver::GetNodeLimit() const noexcept { return this->node_limit; }
+
+void mpbp::Solver::SetTimeLimit(std::chrono::milliseconds time_limit)
+{
+  if (time_limit.count() < 0)
+  {
+    throw std::runtime_error("invalid time limit");
+  }
+  this->time_limit = time_limit;
+}
+
+std::chrono::milliseconds mpbp::Solver::GetTimeLimit() const noexcept { return this->time_limit; }
+
+void mpbp::Solver::Solve(const std::span<mpbp::Rect> rects)
+{
+  mpbp::ThreadPool thread_pool;
+  this->Solve(rects, thread_pool);
+}
+
+void mpbp::Solver::Solve(const std::span<mpbp::Rect> rects, mpbp::ThreadPool& thread_pool)
+{
+  // This also checks that the page size is valid and that every rect fits in a page.
+  this->lower_bound = mpbp::LowerBound(rects, this->max_width, this->max_height).GetPageCount();
+  this->node_count = 0;
+  if (rects.empty())
+  {
+    this->page_count = 0;
+    this->heuristic_page_count = 0;
+    this->is_optimal = true;
+    return;
+  }
+  // Start from the greedy pack, which is the best packing until the search finds a better one.
+  std::vector<mpbp::Rect> best_rects;
+  best_rects.reserve(rects.size());
+  for (std::size_t rect_i = 0; rect_i < rects.size(); rect_i++)
+  {
+    best_rects.emplace_back(rect_i, rects[rect_i].GetWidth(), rects[rect_i].GetHeight());
+  }
+  mpbp::Packer packer(this->max_width, this->max_height);
+  packer.Pack(best_rects);
+  std::sort(best_rects.begin(), best_rects.end(),
+            [](const mpbp::Rect& a, const mpbp::Rect& b)
+            { return a.GetIdentifier() < b.GetIdentifier(); });
+  this->heuristic_page_count = packer.GetPageCount();
+  this->page_count = this->heuristic_page_count;
+  this->is_optimal = this->page_count <= this->lower_bound;
+  std::vector<Item> items;
+  items.reserve(rects.size());
+  for (std::size_t rect_i = 0; rect_i < rects.size(); rect_i++)
+  {
+    const auto& rect = rects[rect_i];
+    items.push_back({rect.GetWidth(), rect.GetHeight(),
+                     static_cast<long long>(rect.GetWidth()) * rect.GetHeight(), rect_i, 0,
+                     rect.GetWidth() * 2 > this->max_width && rect.GetHeight() * 2 > this->max_height});
+  }
+  std::sort(items.begin(), items.end(),
+            [](const Item& a, const Item& b)
+            {
+              if (a.area != b.area) return a.area > b.area;
+              if (a.height != b.height) return a.height > b.height;
+              return a.width > b.width;
+            });
+  std::vector<long long> suffix_areas(items.size() + 1, 0);
+  std::vector<long long> suffix_min_areas(items.size() + 1, 0);
+  std::vector<int> suffix_big_counts(items.size() + 1, 0);
+  for (std::size_t item_i = items.size(); item_i > 0; item_i--)
+  {
+    const auto& item = items[item_i - 1];
+    suffix_areas[item_i - 1] = suffix_areas[item_i] + item.area;
+    // The last item is the smallest, because the items are sorted by decreasing area.
+    suffix_min_areas[item_i - 1] = items.back().area;
+    suffix_big_counts[item_i - 1] = suffix_big_counts[item_i] + (item.is_big ? 1 : 0);
+  }
+  for (std::size_t item_i = 1; item_i < items.size(); item_i++)
+  {
+    const auto same_size = items[item_i].width == items[item_i - 1].width &&
+                           items[item_i].height == items[item_i - 1].height;
+    items[item_i].size_i = items[item_i - 1].size_i + (same_size ? 0 : 1);
+  }
+  SearchControl control;
+  control.node_limit = this->node_limit;
+  control.has_deadline = this->time_limit.count() > 0;
+  control.deadline = std::chrono::steady_clock::now() + this->time_limit;
+  // Search for a packing with one page less than the best so far until none exists.
+  while (!this->is_optimal && !control.aborted)
+  {
+    const auto page_limit = this->page_count - 1;
+    mpbp::TaskGroup task_group(thread_pool);
+    SearchContext context = {items,           suffix_areas,     suffix_min_areas,
+                             suffix_big_counts, this->max_width, this->max_height,
+                             page_limit,      control,          task_group};
+    Assignment assignment = {std::vector<int>(items.size(), -1),
+                             std::vector<long long>(page_limit, 0),
+                             std::vector<bool>(page_limit, false), 0, 0};
+    control.found = false;
+    submitSearch(context, std::move(assignment), 0);
+    task_group.Wait();
+    if (!control.found)
+    {
+      // A search that ran to the end without a packing proves that the best packing is optimal.
+      this->is_optimal = !control.aborted;
+      break;
+    }
+    // Place the items of each page of the solution again to get their positions.
+    for (int page = 0; page < page_limit; page++)
+    {
+      std::vector<std::size_t> page_items;
+      for (std::size_t item_i = 0; item_i < items.size(); item_i++)
+      {
+        if (control.solution_pages[item_i] == page) page_items.push_back(item_i);
+      }
+      NodeCounter counter(nullptr);
+      PageSearch page_search(items, page_items, this->max_width, this->max_height, counter);
+      page_search.Run();
+      for (const auto& placed : page_search.GetPlaced())
+      {
+        best_rects[items[placed.item_i].rect_i].Place(placed.left_x, placed.top_y, page);
+      }
+    }
+    this->page_count = page_limit;
+    this->is_optimal = this->page_count <= this->lower_bound;
+  }
+  this->node_count = control.node_count;
+  for (std::size_t rect_i = 0; rect_i < rects.size(); rect_i++)
+  {
+    const auto& best_rect = best_rects[rect_i];
+    rects[rect_i].Place(best_rect.GetLeftX(), best_rect.GetTopY(), best_rect.GetPage());
+  }
+}
+
+int mpbp::Solver::GetPageCount() const noexcept { return this->page_count; }
+
+int mpbp::Solver::GetHeuristicPageCount() const noexcept { return this->heuristic_page_count; }
+
+int mpbp::Solver::GetLowerBound() const noexcept { return this->lower_bound; }
+
+long long mpbp::Solver::GetNodeCount() const noexcept { return this->node_count; }
+
+bool mpbp::Solver::GetIsOptimal() const noexcept { return this->is_optimal; }
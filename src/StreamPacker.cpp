@@ -0,0 +1,164 @@
+// SPDX-FileCopyrightText: 2022 Daniel Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+#include <cstdint>
+#include <mpbp/StreamPacker.hpp>
+#include <stdexcept>
+
+namespace
+{
+  template <typename T>
+  void writeValue(std::ostream& stream, T value)
+  {
+    stream.write(reinterpret_cast<const char*>(&value), sizeof(value));
+  }
+
+  template <typename T>
+  bool readValue(std::istream& stream, T& value)
+  {
+    stream.read(reinterpret_cast<char*>(&value), sizeof(value));
+    return stream.gcount() == sizeof(value);
+  }
+
+  // Read the next record of a stream of rects to pack. Returns false if the stream has ended
+  // before the record, and throws an exception if it ends within the record.
+  bool readInputRect(std::istream& input, mpbp::Rect& rect)
+  {
+    std::uint64_t identifier = 0;
+    std::int32_t width = 0;
+    std::int32_t height = 0;
+    if (!readValue(input, identifier))
+    {
+      if (input.gcount() == 0) return false;
+      throw std::runtime_error("truncated rect stream");
+    }
+    if (!readValue(input, width) || !readValue(input, height))
+    {
+      throw std::runtime_error("truncated rect stream");
+    }
+    rect = mpbp::Rect(static_cast<unsigned long int>(identifier), width, height);
+    return true;
+  }
+
+  void writePlacedRect(std::ostream& output, const mpbp::Rect& rect)
+  {
+    writeValue<std::uint64_t>(output, rect.GetIdentifier());
+    writeValue<std::int32_t>(output, rect.GetLeftX());
+    writeValue<std::int32_t>(output, rect.GetTopY());
+    writeValue<std::int32_t>(output, rect.GetPage());
+    writeValue<std::int32_t>(output, rect.GetWidth());
+    writeValue<std::int32_t>(output, rect.GetHeight());
+  }
+}  // namespace
+
+mpbp::StreamPacker::StreamPacker(int max_width, int max_height) noexcept
+    : packer(max_width, max_height)
+{
+}
+
+void mpbp::StreamPacker::SetChunkSize(std::size_t chunk_size)
+{
+  if (chunk_size == 0)
+  {
+    throw std::runtime_error("invalid chunk size");
+  }
+  this->chunk_size = chunk_size;
+}
+
+std::size_t mpbp::StreamPacker::GetChunkSize() const noexcept { return this->chunk_size; }
+
+void mpbp::StreamPacker::SetOpenPageLimit(int open_page_limit)
+{
+  if (open_page_limit <= 0)
+  {
+    throw std::runtime_error("invalid open page limit");
+  }
+  this->open_page_limit = open_page_limit;
+}
+
+int mpbp::StreamPacker::GetOpenPageLimit() const noexcept { return this->open_page_limit; }
+
+void mpbp::StreamPacker::SetCloseThreshold(int close_width, int close_height) noexcept
+{
+  this->packer.SetCloseThreshold(close_width, close_height);
+}
+
+void mpbp::StreamPacker::Pack(std::istream& input, std::ostream& output)
+{
+  while (true)
+  {
+    this->chunk.clear();
+    mpbp::Rect rect;
+    while (this->chunk.size() < this->chunk_size && readInputRect(input, rect))
+    {
+      this->chunk.push_back(rect);
+    }
+    if (this->chunk.empty()) return;
+    const auto first_new_page = this->packer.GetPageCount();
+    this->packer.Pack(this->chunk);
+    for (auto page = first_new_page; page < this->packer.GetPageCount(); page++)
+    {
+      this->open_pages.push_back(page);
+    }
+    // The placements are final as soon as the chunk is packed, so they are spilled right away.
+    for (const auto& placed_rect : this->chunk)
+    {
+      writePlacedRect(output, placed_rect);
+    }
+    if (!output)
+    {
+      throw std::runtime_error("failed to write placed rects");
+    }
+    this->rect_count += this->chunk.size();
+    this->closePages();
+  }
+}
+
+const mpbp::Packer& mpbp::StreamPacker::GetPacker() const noexcept { return this->packer; }
+
+int mpbp::StreamPacker::GetOpenPageCount() const noexcept
+{
+  return static_cast<int>(this->open_pages.size());
+}
+
+unsigned long long mpbp::StreamPacker::GetRectCount() const noexcept { return this->rect_count; }
+
+void mpbp::StreamPacker::WriteInputRect(std::ostream& input, const mpbp::Rect& rect)
+{
+  writeValue<std::uint64_t>(input, rect.GetIdentifier());
+  writeValue<std::int32_t>(input, rect.GetWidth());
+  writeValue<std::int32_t>(input, rect.GetHeight());
+}
+
+bool mpbp::StreamPacker::ReadPlacedRect(std::istream& output, mpbp::Rect& rect)
+{
+  std::uint64_t identifier = 0;
+  std::int32_t values[5] = {};
+  if (!readValue(output, identifier))
+  {
+    if (output.gcount() == 0) return false;
+    throw std::runtime_error("truncated rect stream");
+  }
+  for (auto& value : values)
+  {
+    if (!readValue(output, value))
+    {
+      throw std::runtime_error("truncated rect stream");
+    }
+  }
+  rect = mpbp::Rect(static_cast<unsigned long int>(identifier), values[3], values[4]);
+  rect.Place(values[0], values[1], values[2]);
+  return true;
+}
+
+void mpbp::StreamPacker::closePages()
+{
+  // Forget the pages that the Packer closed by its close threshold.
+  std::erase_if(this->open_pages, [&](int page) { return this->packer.GetIsPageClosed(page); });
+  while (static_cast<int>(this->open_pages.size()) > this->open_page_limit)
+  {
+    this->packer.ClosePage(this->open_pages.front());
+    this->open_pages.pop_front();
+  }
+}
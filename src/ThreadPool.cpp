@@ -0,0 +1,210 @@
+// SPDX-FileCopyrightText: 2022 Daniel Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+#include <algorithm>
+#include <mpbp/ThreadPool.hpp>
+#include <stdexcept>
+#include <utility>
+
+namespace
+{
+  // The pool and queue of the current thread, so tasks submitted from within a task are queued on
+  // the thread that is running it.
+  thread_local const mpbp::ThreadPool* current_pool = nullptr;
+  thread_local std::size_t current_worker_i = 0;
+  // The pool of the task that the current thread is running, which may also be a task that a
+  // waiting thread outside of the pool helps with.
+  thread_local const mpbp::ThreadPool* running_pool = nullptr;
+}  // namespace
+
+mpbp::ThreadPool::ThreadPool() : ThreadPool(0) {}
+
+mpbp::ThreadPool::ThreadPool(std::size_t thread_count)
+{
+  if (thread_count == 0)
+  {
+    thread_count = std::max(1u, std::thread::hardware_concurrency());
+  }
+  this->workers.reserve(thread_count);
+  for (std::size_t worker_i = 0; worker_i < thread_count; worker_i++)
+  {
+    this->workers.push_back(std::make_unique<Worker>());
+  }
+  this->threads.reserve(thread_count);
+  for (std::size_t worker_i = 0; worker_i < thread_count; worker_i++)
+  {
+    this->threads.emplace_back([this, worker_i]() { this->run(worker_i); });
+  }
+}
+
+mpbp::ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard lock(this->wake_mutex);
+    this->stopping = true;
+  }
+  this->wake_condition.notify_all();
+  for (auto& thread : this->threads)
+  {
+    thread.join();
+  }
+}
+
+std::size_t mpbp::ThreadPool::GetThreadCount() const noexcept { return this->threads.size(); }
+
+void mpbp::ThreadPool::Submit(std::function<void()> task)
+{
+  this->pending_count++;
+  const auto worker_i = current_pool == this
+                            ? current_worker_i
+                            : this->next_worker_i++ % this->workers.size();
+  {
+    // Count the task before it is visible so that a thief never decrements past zero.
+    std::lock_guard lock(this->wake_mutex);
+    this->queued_count++;
+  }
+  {
+    auto& worker = *this->workers[worker_i];
+    std::lock_guard lock(worker.mutex);
+    worker.tasks.push_back(std::move(task));
+  }
+  this->wake_condition.notify_one();
+}
+
+void mpbp::ThreadPool::Wait()
+{
+  if (running_pool == this)
+  {
+    throw std::runtime_error("can not wait for a thread pool from one of its own tasks");
+  }
+  while (this->pending_count > 0)
+  {
+    if (this->tryRunTask(this->workers.size())) continue;
+    std::unique_lock lock(this->wake_mutex);
+    this->idle_condition.wait(lock, [&]() { return this->pending_count == 0; });
+  }
+  std::exception_ptr task_exception = nullptr;
+  {
+    std::lock_guard lock(this->wake_mutex);
+    std::swap(task_exception, this->exception);
+  }
+  if (task_exception) std::rethrow_exception(task_exception);
+}
+
+mpbp::TaskGroup::TaskGroup(mpbp::ThreadPool& thread_pool) noexcept : thread_pool(thread_pool) {}
+
+void mpbp::TaskGroup::Submit(std::function<void()> task)
+{
+  this->pending_count++;
+  this->thread_pool.Submit(
+      [this, task = std::move(task)]()
+      {
+        try
+        {
+          task();
+        }
+        catch (...)
+        {
+          std::lock_guard lock(this->exception_mutex);
+          if (!this->exception) this->exception = std::current_exception();
+        }
+        // The group may be destroyed as soon as its count reaches zero, so only the pool is used
+        // after that.
+        auto& thread_pool = this->thread_pool;
+        if (this->pending_count.fetch_sub(1) == 1)
+        {
+          std::lock_guard lock(thread_pool.wake_mutex);
+          thread_pool.wake_condition.notify_all();
+        }
+      });
+}
+
+void mpbp::TaskGroup::Wait()
+{
+  // A thread of the pool keeps taking tasks from its own queue first.
+  const auto worker_i =
+      current_pool == &this->thread_pool ? current_worker_i : this->thread_pool.workers.size();
+  while (this->pending_count > 0)
+  {
+    if (this->thread_pool.tryRunTask(worker_i)) continue;
+    // Sleep until the group is done or there is a task to help with, which the tasks of the group
+    // may be waiting for if every thread of the pool is waiting for a group.
+    std::unique_lock lock(this->thread_pool.wake_mutex);
+    this->thread_pool.wake_condition.wait(
+        lock, [&]() { return this->pending_count == 0 || this->thread_pool.queued_count > 0; });
+  }
+  std::exception_ptr task_exception = nullptr;
+  {
+    std::lock_guard lock(this->exception_mutex);
+    std::swap(task_exception, this->exception);
+  }
+  if (task_exception) std::rethrow_exception(task_exception);
+}
+
+void mpbp::ThreadPool::run(std::size_t worker_i)
+{
+  current_pool = this;
+  current_worker_i = worker_i;
+  while (true)
+  {
+    if (this->tryRunTask(worker_i)) continue;
+    std::unique_lock lock(this->wake_mutex);
+    this->wake_condition.wait(lock,
+                              [&]() { return this->stopping || this->queued_count > 0; });
+    if (this->stopping && this->queued_count == 0) return;
+  }
+}
+
+bool mpbp::ThreadPool::tryRunTask(std::size_t worker_i)
+{
+  std::function<void()> task = nullptr;
+  // Take the newest task of this thread first, since its data is most likely still in cache.
+  if (worker_i < this->workers.size())
+  {
+    auto& worker = *this->workers[worker_i];
+    std::lock_guard lock(worker.mutex);
+    if (!worker.tasks.empty())
+    {
+      task = std::move(worker.tasks.back());
+      worker.tasks.pop_back();
+    }
+  }
+  // Otherwise steal the oldest task of another thread, which is likely to be the largest.
+  for (std::size_t offset = 1; !task && offset <= this->workers.size(); offset++)
+  {
+    const auto victim_i = (worker_i + offset) % this->workers.size();
+    if (victim_i == worker_i) continue;
+    auto& victim = *this->workers[victim_i];
+    std::lock_guard lock(victim.mutex);
+    if (!victim.tasks.empty())
+    {
+      task = std::move(victim.tasks.front());
+      victim.tasks.pop_front();
+    }
+  }
+  if (!task) return false;
+  this->queued_count--;
+  const auto outer_running_pool = std::exchange(running_pool, this);
+  try
+  {
+    task();
+  }
+  catch (...)
+  {
+    std::lock_guard lock(this->wake_mutex);
+    if (!this->exception) this->exception = std::current_exception();
+  }
+  running_pool = outer_running_pool;
+  this->finishTask();
+  return true;
+}
+
+void mpbp::ThreadPool::finishTask()
+{
+  if (this->pending_count.fetch_sub(1) == 1)
+  {
+    std::lock_guard lock(this->wake_mutex);
+    this->idle_condition.notify_all();
+  }
+}
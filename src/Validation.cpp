@@ -0,0 +1,234 @@
+// SPDX-FileCopyrightText: 2022 Daniel Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <mpbp/Validation.hpp>
+#include <utility>
+
+namespace
+{
+  struct PageResult
+  {
+    std::size_t overlap_count = 0;
+    std::size_t shared_count = 0;
+    std::vector<std::size_t> invalid_indices = std::vector<std::size_t>();
+  };
+
+  // The left or right side of a rect crossed by the sweep line. The right side is exclusive, so a
+  // rect leaves the sweep at the same x that a rect touching its right side enters it.
+  struct SweepEvent
+  {
+    int x;
+    bool is_enter;
+    std::size_t rect_i;
+  };
+
+  bool samePlacement(const mpbp::Rect& a, const mpbp::Rect& b) noexcept
+  {
+    return a.GetLeftX() == b.GetLeftX() && a.GetTopY() == b.GetTopY() &&
+           a.GetWidth() == b.GetWidth() && a.GetHeight() == b.GetHeight();
+  }
+
+  // Check the rects of one page for overlaps with a sweep line over the x axis. The rects that the
+  // sweep line crosses are kept in a map from their top to their index. Rects that overlap are not
+  // added to the map, so the vertical extents in it never overlap and only the neighbours of a new
+  // rect have to be checked. The overlapping rects are still crossed by the sweep line, so they are
+  // kept in a vector that is searched in full, which stays short unless most rects overlap.
+  PageResult sweepPage(const std::span<const mpbp::Rect> rects,
+                       const std::span<const std::size_t> page_rect_indices)
+  {
+    PageResult result;
+    std::vector<SweepEvent> events;
+    events.reserve(page_rect_indices.size() * 2);
+    for (const auto rect_i : page_rect_indices)
+    {
+      const auto& rect = rects[rect_i];
+      events.push_back({rect.GetLeftX(), true, rect_i});
+      events.push_back({rect.GetLeftX() + rect.GetWidth(), false, rect_i});
+    }
+    std::sort(events.begin(), events.end(),
+              [](const SweepEvent& a, const SweepEvent& b)
+              {
+                if (a.x != b.x) return a.x < b.x;
+                return a.is_enter < b.is_enter;
+              });
+    std::map<int, std::size_t> crossed;
+    std::vector<std::size_t> crossed_overlaps;
+    for (const auto& event : events)
+    {
+      const auto& rect = rects[event.rect_i];
+      if (!event.is_enter)
+      {
+        const auto crossed_it = crossed.find(rect.GetTopY());
+        if (crossed_it != crossed.end() && crossed_it->second == event.rect_i)
+        {
+          crossed.erase(crossed_it);
+        }
+        else
+        {
+          std::erase(crossed_overlaps, event.rect_i);
+        }
+        continue;
+      }
+      const auto bottom_y = rect.GetTopY() + rect.GetHeight();
+      const auto next_it = crossed.lower_bound(rect.GetTopY());
+      auto overlapped_it = crossed.end();
+      if (next_it != crossed.end() && next_it->first < bottom_y)
+      {
+        overlapped_it = next_it;
+      }
+      else if (next_it != crossed.begin())
+      {
+        const auto previous_it = std::prev(next_it);
+        const auto& previous = rects[previous_it->second];
+        if (previous.GetTopY() + previous.GetHeight() > rect.GetTopY()) overlapped_it = previous_it;
+      }
+      auto overlapped_i = overlapped_it == crossed.end() ? rects.size() : overlapped_it->second;
+      if (overlapped_i == rects.size())
+      {
+        const auto overlap_it = std::find_if(
+            crossed_overlaps.begin(), crossed_overlaps.end(),
+            [&](std::size_t overlap_i)
+            {
+              const auto& overlap = rects[overlap_i];
+              return overlap.GetTopY() < bottom_y &&
+                     rect.GetTopY() < overlap.GetTopY() + overlap.GetHeight();
+            });
+        if (overlap_it != crossed_overlaps.end()) overlapped_i = *overlap_it;
+      }
+      if (overlapped_i == rects.size())
+      {
+        crossed.emplace(rect.GetTopY(), event.rect_i);
+      }
+      else if (samePlacement(rect, rects[overlapped_i]))
+      {
+        result.shared_count++;
+      }
+      else
+      {
+        result.overlap_count++;
+        result.invalid_indices.push_back(event.rect_i);
+        crossed_overlaps.push_back(event.rect_i);
+      }
+    }
+    return result;
+  }
+}  // namespace
+
+mpbp::Validation::Validation(std::size_t unplaced_count, std::size_t out_of_bounds_count,
+                             std::size_t overlap_count, std::size_t shared_count,
+                             std::vector<std::size_t> invalid_indices) noexcept
+    : unplaced_count(unplaced_count),
+      out_of_bounds_count(out_of_bounds_count),
+      overlap_count(overlap_count),
+      shared_count(shared_count),
+      invalid_indices(std::move(invalid_indices))
+{
+}
+
+bool mpbp::Validation::GetIsValid() const noexcept
+{
+  return this->unplaced_count == 0 && this->out_of_bounds_count == 0 && this->overlap_count == 0;
+}
+
+std::size_t mpbp::Validation::GetUnplacedCount() const noexcept { return this->unplaced_count; }
+
+std::size_t mpbp::Validation::GetOutOfBoundsCount() const noexcept
+{
+  return this->out_of_bounds_count;
+}
+
+std::size_t mpbp::Validation::GetOverlapCount() const noexcept { return this->overlap_count; }
+
+std::size_t mpbp::Validation::GetSharedCount() const noexcept { return this->shared_count; }
+
+const std::vector<std::size_t>& mpbp::Validation::GetInvalidIndices() const noexcept
+{
+  return this->invalid_indices;
+}
+
+mpbp::Validation mpbp::Validate(const std::span<const mpbp::Rect> rects,
+                                const mpbp::Packer& packer)
+{
+  mpbp::ThreadPool thread_pool;
+  return mpbp::Validate(rects, packer, thread_pool);
+}
+
+mpbp::Validation mpbp::Validate(const std::span<const mpbp::Rect> rects,
+                                const mpbp::Packer& packer, mpbp::ThreadPool& thread_pool)
+{
+  const auto page_count = packer.GetPageCount();
+  std::vector<int> page_widths(page_count);
+  std::vector<int> page_heights(page_count);
+  for (int page = 0; page < page_count; page++)
+  {
+    page_widths[page] = packer.GetPageWidth(page);
+    page_heights[page] = packer.GetPageHeight(page);
+  }
+  std::size_t unplaced_count = 0;
+  std::size_t out_of_bounds_count = 0;
+  std::vector<std::size_t> invalid_indices;
+  // Bucket the placed rects by page with a counting sort, so each page can be checked on its own.
+  std::vector<std::size_t> first_page_rects(page_count + 1, 0);
+  std::vector<bool> in_bounds(rects.size(), false);
+  for (std::size_t rect_i = 0; rect_i < rects.size(); rect_i++)
+  {
+    const auto& rect = rects[rect_i];
+    const auto page = rect.GetPage();
+    if (page < 0 || rect.GetLeftX() < 0 || rect.GetTopY() < 0)
+    {
+      unplaced_count++;
+      invalid_indices.push_back(rect_i);
+      continue;
+    }
+    if (page >= page_count || rect.GetIsDegenerate() ||
+        rect.GetLeftX() + rect.GetWidth() > page_widths[page] ||
+        rect.GetTopY() + rect.GetHeight() > page_heights[page])
+    {
+      out_of_bounds_count++;
+      invalid_indices.push_back(rect_i);
+      continue;
+    }
+    in_bounds[rect_i] = true;
+    first_page_rects[page + 1]++;
+  }
+  for (int page = 0; page < page_count; page++)
+  {
+    first_page_rects[page + 1] += first_page_rects[page];
+  }
+  std::vector<std::size_t> page_rect_indices(first_page_rects.back());
+  auto next_page_rects = first_page_rects;
+  for (std::size_t rect_i = 0; rect_i < rects.size(); rect_i++)
+  {
+    if (in_bounds[rect_i]) page_rect_indices[next_page_rects[rects[rect_i].GetPage()]++] = rect_i;
+  }
+  std::vector<PageResult> page_results(page_count);
+  mpbp::TaskGroup task_group(thread_pool);
+  for (int page = 0; page < page_count; page++)
+  {
+    task_group.Submit(
+        [&, page]()
+        {
+          page_results[page] = sweepPage(
+              rects, std::span<const std::size_t>(page_rect_indices)
+                         .subspan(first_page_rects[page],
+                                  first_page_rects[page + 1] - first_page_rects[page]));
+        });
+  }
+  task_group.Wait();
+  std::size_t overlap_count = 0;
+  std::size_t shared_count = 0;
+  for (const auto& page_result : page_results)
+  {
+    overlap_count += page_result.overlap_count;
+    shared_count += page_result.shared_count;
+    invalid_indices.insert(invalid_indices.end(), page_result.invalid_indices.begin(),
+                           page_result.invalid_indices.end());
+  }
+  std::sort(invalid_indices.begin(), invalid_indices.end());
+  return mpbp::Validation(unplaced_count, out_of_bounds_count, overlap_count, shared_count,
+                          std::move(invalid_indices));
+}
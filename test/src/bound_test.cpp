@@ -0,0 +1,119 @@
+// SPDX-FileCopyrightText: 2022 Daniel Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+#include <catch2/catch_all.hpp>
+#include <mpbp/Bound.hpp>
+#include <mpbp/Packer.hpp>
+#include <mpbp/Rect.hpp>
+#include <vector>
+
+SCENARIO("The lower bound of a span of Rect is computed")
+{
+  GIVEN("Four Rect with a width and height of 256 for pages of size (512, 512)")
+  {
+    std::vector<mpbp::Rect> rects = {mpbp::Rect(0, 256, 256), mpbp::Rect(1, 256, 256),
+                                     mpbp::Rect(2, 256, 256), mpbp::Rect(3, 256, 256)};
+    auto bound = mpbp::LowerBound(rects, 512, 512);
+
+    THEN("The lower bound is 1 page")
+    {
+      CHECK(bound.GetAreaBound() == 1);
+      CHECK(bound.GetL2Bound() == 1);
+      CHECK(bound.GetPageCount() == 1);
+    }
+  }
+
+  GIVEN("Three Rect with a width and height of 300 for pages of size (512, 512)")
+  {
+    std::vector<mpbp::Rect> rects = {mpbp::Rect(0, 300, 300), mpbp::Rect(1, 300, 300),
+                                     mpbp::Rect(2, 300, 300)};
+    auto bound = mpbp::LowerBound(rects, 512, 512);
+
+    THEN("The area bound is 2 pages") { CHECK(bound.GetAreaBound() == 2); }
+
+    THEN("The L2 bound is 3 pages")
+    {
+      CHECK(bound.GetL2Bound() == 3);
+      CHECK(bound.GetPageCount() == 3);
+    }
+  }
+
+  GIVEN("Two Rect that fill a page and four Rect with a width and height of 100")
+  {
+    std::vector<mpbp::Rect> rects = {mpbp::Rect(0, 512, 512), mpbp::Rect(1, 512, 512),
+                                     mpbp::Rect(2, 100, 100), mpbp::Rect(3, 100, 100),
+                                     mpbp::Rect(4, 100, 100), mpbp::Rect(5, 100, 100)};
+    auto bound = mpbp::LowerBound(rects, 512, 512);
+
+    THEN("The L2 bound is 3 pages") { CHECK(bound.GetPageCount() == 3); }
+  }
+
+  GIVEN("An empty span of Rect")
+  {
+    std::vector<mpbp::Rect> rects;
+
+    THEN("The lower bound is 0 pages")
+    {
+      CHECK(mpbp::LowerBound(rects, 512, 512).GetPageCount() == 0);
+    }
+  }
+
+  GIVEN("A vector of Rect where one is larger than the page")
+  {
+    std::vector<mpbp::Rect> rects = {mpbp::Rect(0, 1, 1), mpbp::Rect(1, 1, 513)};
+
+    THEN("Computing the lower bound throws an exception")
+    {
+      CHECK_THROWS(mpbp::LowerBound(rects, 512, 512));
+    }
+  }
+
+  GIVEN("A vector of Rect where one is degenerate")
+  {
+    std::vector<mpbp::Rect> rects = {mpbp::Rect(0, 1, 1), mpbp::Rect(1, 1, 0)};
+
+    THEN("Computing the lower bound throws an exception")
+    {
+      CHECK_THROWS(mpbp::LowerBound(rects, 512, 512));
+    }
+  }
+}
+
+SCENARIO("The efficiency of a pack is reported")
+{
+  GIVEN("A Packer with max dimensions (512, 512)")
+  {
+    mpbp::Packer packer(512, 512);
+
+    WHEN("Four Rect that exactly fill a page are packed")
+    {
+      std::vector<mpbp::Rect> rects = {mpbp::Rect(0, 256, 256), mpbp::Rect(1, 256, 256),
+                                       mpbp::Rect(2, 256, 256), mpbp::Rect(3, 256, 256)};
+      packer.Pack(rects);
+      mpbp::Efficiency efficiency(packer, rects);
+
+      THEN("The pack is optimal and completely filled")
+      {
+        CHECK(efficiency.GetIsOptimal());
+        CHECK(efficiency.GetPageGap() == 0);
+        CHECK(efficiency.GetFillRatio() == Catch::Approx(1.0));
+        CHECK(efficiency.GetBoundFillRatio() == Catch::Approx(1.0));
+      }
+    }
+
+    WHEN("Three Rect with a width and height of 300 are packed")
+    {
+      std::vector<mpbp::Rect> rects = {mpbp::Rect(0, 300, 300), mpbp::Rect(1, 300, 300),
+                                       mpbp::Rect(2, 300, 300)};
+      packer.Pack(rects);
+      mpbp::Efficiency efficiency(packer, rects);
+
+      THEN("The pack uses one page per Rect and is optimal")
+      {
+        CHECK(efficiency.GetPageCount() == 3);
+        CHECK(efficiency.GetIsOptimal());
+      }
+    }
+  }
+}
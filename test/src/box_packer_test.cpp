@@ -0,0 +1,122 @@
+// SPDX-FileCopyrightText: 2022 Daniel Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+#include <catch2/catch_all.hpp>
+#include <mpbp/Box.hpp>
+#include <mpbp/BoxPacker.hpp>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+  bool overlaps(const mpbp::Box& a, const mpbp::Box& b)
+  {
+    return a.GetPage() == b.GetPage() && a.GetLeftX() <= b.GetRightX() &&
+           b.GetLeftX() <= a.GetRightX() && a.GetTopY() <= b.GetBottomY() &&
+           b.GetTopY() <= a.GetBottomY() && a.GetFrontZ() <= b.GetBackZ() &&
+           b.GetFrontZ() <= a.GetBackZ();
+  }
+
+  // Check that every Box is placed within its page and that no two Box overlap.
+  bool allPlacedApart(const std::vector<mpbp::Box>& boxes, const mpbp::BoxPacker& packer)
+  {
+    for (std::size_t box_i = 0; box_i < boxes.size(); box_i++)
+    {
+      const auto& box = boxes[box_i];
+      if (box.GetPage() < 0 || box.GetPage() >= packer.GetPageCount() || box.GetLeftX() < 0 ||
+          box.GetTopY() < 0 || box.GetFrontZ() < 0 || box.GetRightX() >= packer.GetWidth() ||
+          box.GetBottomY() >= packer.GetHeight() || box.GetBackZ() >= packer.GetDepth())
+      {
+        return false;
+      }
+      for (std::size_t other_i = box_i + 1; other_i < boxes.size(); other_i++)
+      {
+        if (overlaps(box, boxes[other_i])) return false;
+      }
+    }
+    return true;
+  }
+
+  std::vector<mpbp::Box> makeBoxes(unsigned long int first_identifier, int count)
+  {
+    std::vector<mpbp::Box> boxes;
+    for (int box_i = 0; box_i < count; box_i++)
+    {
+      boxes.emplace_back(first_identifier + box_i, 1 + box_i * 7 % 13, 1 + box_i * 5 % 11,
+                         1 + box_i * 3 % 17);
+    }
+    return boxes;
+  }
+}  // namespace
+
+SCENARIO("BoxPacker packs Box into volume pages")
+{
+  GIVEN("A BoxPacker with max dimensions (32, 32, 32)")
+  {
+    mpbp::BoxPacker packer(32, 32, 32);
+
+    WHEN("64 bricks with a size of 8 are packed")
+    {
+      std::vector<mpbp::Box> boxes(64, mpbp::Box(0, 8, 8, 8));
+      packer.Pack(boxes);
+
+      THEN("The bricks fill a single page exactly")
+      {
+        REQUIRE(packer.GetPageCount() == 1);
+        REQUIRE(packer.GetWidth() == 32);
+        REQUIRE(packer.GetHeight() == 32);
+        REQUIRE(packer.GetDepth() == 32);
+        REQUIRE(packer.GetVolumes().empty());
+        REQUIRE(allPlacedApart(boxes, packer));
+      }
+    }
+    WHEN("A few Box are packed")
+    {
+      std::vector<mpbp::Box> boxes = {mpbp::Box(0, 4, 4, 4), mpbp::Box(1, 2, 2, 2)};
+      packer.Pack(boxes);
+
+      THEN("The page only takes up the bounding box of the Box")
+      {
+        REQUIRE(packer.GetPageCount() == 1);
+        REQUIRE(packer.GetWidth() <= 6);
+        REQUIRE(packer.GetHeight() <= 6);
+        REQUIRE(packer.GetDepth() <= 6);
+        REQUIRE(allPlacedApart(boxes, packer));
+      }
+    }
+    WHEN("600 Box of different sizes are packed over several packs")
+    {
+      auto boxes = makeBoxes(0, 600);
+      for (std::size_t first_i = 0; first_i < boxes.size(); first_i += 100)
+      {
+        packer.Pack(std::span<mpbp::Box>(boxes).subspan(first_i, 100));
+      }
+
+      THEN("Every Box is placed within a page without overlapping another Box")
+      {
+        REQUIRE(packer.GetPageCount() > 1);
+        REQUIRE(allPlacedApart(boxes, packer));
+        long long box_volume = 0;
+        for (const auto& box : boxes)
+        {
+          box_volume += static_cast<long long>(box.GetWidth()) * box.GetHeight() * box.GetDepth();
+        }
+        REQUIRE(box_volume <= packer.GetPageVolume());
+      }
+    }
+    WHEN("A degenerate Box is packed")
+    {
+      std::vector<mpbp::Box> boxes = {mpbp::Box(0, 4, 0, 4)};
+
+      THEN("An exception is thrown") { REQUIRE_THROWS_AS(packer.Pack(boxes), std::runtime_error); }
+    }
+    WHEN("A Box that is deeper than a page is packed")
+    {
+      std::vector<mpbp::Box> boxes = {mpbp::Box(0, 4, 4, 33)};
+
+      THEN("An exception is thrown") { REQUIRE_THROWS_AS(packer.Pack(boxes), std::runtime_error); }
+    }
+  }
+}
@@ -0,0 +1,61 @@
+// SPDX-FileCopyrightText: 2022 Daniel Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+#include <catch2/catch_all.hpp>
+#include <mpbp/Box.hpp>
+
+SCENARIO("The position of a Box is determined")
+{
+  GIVEN("A Box that is not placed with a width of 8, a height of 16 and a depth of 32")
+  {
+    mpbp::Box box(3, 8, 16, 32);
+
+    THEN("The coordinates are (-1, -1, -1, -1)")
+    {
+      CHECK(box.GetLeftX() == -1);
+      CHECK(box.GetTopY() == -1);
+      CHECK(box.GetFrontZ() == -1);
+      CHECK(box.GetPage() == -1);
+      CHECK(box.GetIdentifier() == 3);
+    }
+
+    WHEN("The Box is placed at (10, 20, 30, 2)")
+    {
+      box.Place(10, 20, 30, 2);
+
+      THEN("The coordinates and far coordinates are set")
+      {
+        CHECK(box.GetLeftX() == 10);
+        CHECK(box.GetTopY() == 20);
+        CHECK(box.GetFrontZ() == 30);
+        CHECK(box.GetPage() == 2);
+        CHECK(box.GetRightX() == 17);
+        CHECK(box.GetBottomY() == 35);
+        CHECK(box.GetBackZ() == 61);
+      }
+    }
+  }
+}
+
+SCENARIO("Box degeneracy and max dimension are determined")
+{
+  GIVEN("A Box with a depth of 0")
+  {
+    mpbp::Box box(0, 1, 1, 0);
+
+    THEN("The Box is degenerate") { REQUIRE(box.GetIsDegenerate()); }
+  }
+
+  GIVEN("A Box with a width of 4, a height of 2 and a depth of 9")
+  {
+    mpbp::Box box(0, 4, 2, 9);
+
+    THEN("The Box is not degenerate and its max dimension is its depth")
+    {
+      REQUIRE(!box.GetIsDegenerate());
+      CHECK(box.GetMaxDimension() == 9);
+      CHECK(box > mpbp::Box(0, 8, 8, 8));
+    }
+  }
+}
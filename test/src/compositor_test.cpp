@@ -0,0 +1,108 @@
+// SPDX-FileCopyrightText: 2022 Daniel Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+#include <catch2/catch_all.hpp>
+#include <mpbp/Compositor.hpp>
+#include <mpbp/Image.hpp>
+#include <mpbp/Packer.hpp>
+#include <mpbp/Rect.hpp>
+#include <mpbp/ThreadPool.hpp>
+#include <vector>
+
+SCENARIO("A Compositor builds pages from packed Rect")
+{
+  GIVEN("Rect with single channel images where every pixel is the identifier plus 1")
+  {
+    std::vector<mpbp::Rect> rects = {mpbp::Rect(0, 30, 15), mpbp::Rect(1, 9, 9),
+                                     mpbp::Rect(2, 7, 7),   mpbp::Rect(3, 5, 5),
+                                     mpbp::Rect(4, 4, 4),   mpbp::Rect(5, 1, 1)};
+    std::vector<std::vector<unsigned char>> pixels;
+    std::vector<mpbp::Image> images;
+    for (const auto& rect : rects)
+    {
+      pixels.emplace_back(rect.GetWidth() * rect.GetHeight(),
+                          static_cast<unsigned char>(rect.GetIdentifier() + 1));
+    }
+    for (std::size_t rect_i = 0; rect_i < rects.size(); rect_i++)
+    {
+      images.emplace_back(pixels[rect_i].data(), rects[rect_i].GetWidth(),
+                          rects[rect_i].GetHeight(), rects[rect_i].GetWidth(),
+                          mpbp::PixelFormat::R8);
+    }
+    mpbp::Packer packer(32, 16);
+    packer.Pack(rects);
+    mpbp::ThreadPool thread_pool(3);
+    mpbp::Compositor compositor(mpbp::PixelFormat::R8);
+    compositor.SetBandHeight(4);
+
+    WHEN("The pages are composed")
+    {
+      compositor.Compose(packer, rects, images, thread_pool);
+
+      THEN("There is one image for each page")
+      {
+        REQUIRE(compositor.GetPageCount() == packer.GetPageCount());
+        for (int page = 0; page < compositor.GetPageCount(); page++)
+        {
+          CHECK(compositor.GetPage(page).GetWidth() == packer.GetPageWidth(page));
+          CHECK(compositor.GetPage(page).GetHeight() == packer.GetPageHeight(page));
+        }
+      }
+      THEN("Every pixel matches the Rect that covers it, or 0 if none do")
+      {
+        for (int page = 0; page < compositor.GetPageCount(); page++)
+        {
+          const auto image = compositor.GetPage(page);
+          for (int y = 0; y < image.GetHeight(); y++)
+          {
+            for (int x = 0; x < image.GetWidth(); x++)
+            {
+              unsigned char expected = 0;
+              for (const auto& rect : rects)
+              {
+                if (rect.GetPage() == page && rect.GetLeftX() <= x && rect.GetRightX() >= x &&
+                    rect.GetTopY() <= y && rect.GetBottomY() >= y)
+                {
+                  expected = static_cast<unsigned char>(rect.GetIdentifier() + 1);
+                }
+              }
+              CHECK(image.GetRow(y)[x] == expected);
+            }
+          }
+        }
+      }
+    }
+
+    WHEN("An image does not match the size of its Rect")
+    {
+      images[2] = mpbp::Image(pixels[2].data(), 1, 1, 1, mpbp::PixelFormat::R8);
+
+      THEN("Composing throws an exception")
+      {
+        CHECK_THROWS(compositor.Compose(packer, rects, images, thread_pool));
+      }
+    }
+
+    WHEN("An image does not match the pixel format of the Compositor")
+    {
+      mpbp::Compositor rgba_compositor(mpbp::PixelFormat::RGBA8);
+
+      THEN("Composing throws an exception")
+      {
+        CHECK_THROWS(rgba_compositor.Compose(packer, rects, images, thread_pool));
+      }
+    }
+  }
+}
+
+SCENARIO("The size of a pixel is determined")
+{
+  THEN("The pixel sizes are the amount of channels")
+  {
+    CHECK(mpbp::GetPixelSize(mpbp::PixelFormat::R8) == 1);
+    CHECK(mpbp::GetPixelSize(mpbp::PixelFormat::RG8) == 2);
+    CHECK(mpbp::GetPixelSize(mpbp::PixelFormat::RGB8) == 3);
+    CHECK(mpbp::GetPixelSize(mpbp::PixelFormat::RGBA8) == 4);
+  }
+}
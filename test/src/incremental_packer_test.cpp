@@ -0,0 +1,172 @@
+// SPDX-FileCopyrightText: 2022 Daniel Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+#include <catch2/catch_all.hpp>
+#include <mpbp/IncrementalPacker.hpp>
+#include <mpbp/Rect.hpp>
+#include <mpbp/Validation.hpp>
+#include <cstddef>
+#include <vector>
+
+namespace
+{
+  bool samePlacement(const mpbp::Rect& a, const mpbp::Rect& b)
+  {
+    return a.GetLeftX() == b.GetLeftX() && a.GetTopY() == b.GetTopY() &&
+           a.GetPage() == b.GetPage() && a.GetWidth() == b.GetWidth() &&
+           a.GetHeight() == b.GetHeight();
+  }
+}  // namespace
+
+SCENARIO("IncrementalPacker updates a manifest from diffs")
+{
+  GIVEN("An IncrementalPacker with max dimensions (256, 256) that has packed 500 Rect")
+  {
+    mpbp::IncrementalPacker packer(256, 256);
+    std::vector<mpbp::Rect> rects;
+    for (unsigned long int rect_i = 0; rect_i < 500; rect_i++)
+    {
+      rects.emplace_back(rect_i, 2 + static_cast<int>(rect_i * 7 % 29),
+                         2 + static_cast<int>(rect_i * 11 % 23));
+    }
+    packer.Pack(rects);
+    const auto old_rects = packer.GetRects();
+    const auto page_count = packer.GetPacker().GetPageCount();
+
+    WHEN("A few Rect are removed, resized and added")
+    {
+      const std::vector<unsigned long int> removed = {3, 50, 120, 300, 499};
+      std::vector<mpbp::Rect> changed = {mpbp::Rect(10, 12, 12), mpbp::Rect(20, 5, 40),
+                                         mpbp::Rect(500, 16, 16), mpbp::Rect(501, 3, 9)};
+      const auto packed_all = packer.Update(removed, changed);
+      const auto new_rects = packer.GetRects();
+
+      THEN("The manifest is updated without a full pack")
+      {
+        CHECK_FALSE(packed_all);
+        CHECK(packer.GetFullPackCount() == 1);
+        CHECK(packer.GetRectCount() == 497);
+        CHECK_THROWS(packer.GetRect(3));
+      }
+      THEN("Unchanged Rect keep their placements")
+      {
+        std::size_t kept_count = 0;
+        for (const auto& old_rect : old_rects)
+        {
+          const auto identifier = old_rect.GetIdentifier();
+          if (identifier == 3 || identifier == 10 || identifier == 20 || identifier == 50 ||
+              identifier == 120 || identifier == 300 || identifier == 499)
+          {
+            continue;
+          }
+          kept_count += samePlacement(old_rect, packer.GetRect(identifier));
+        }
+        CHECK(kept_count == 493);
+      }
+      THEN("The changed Rect are placed")
+      {
+        for (const auto& rect : changed)
+        {
+          CHECK(samePlacement(rect, packer.GetRect(rect.GetIdentifier())));
+          CHECK(rect.GetPage() >= 0);
+        }
+      }
+      THEN("The placements are valid")
+      {
+        CHECK(mpbp::Validate(new_rects, packer.GetPacker()).GetIsValid());
+      }
+    }
+
+    WHEN("A Rect is changed without changing its size")
+    {
+      std::vector<mpbp::Rect> changed = {
+          mpbp::Rect(42, old_rects[42].GetWidth(), old_rects[42].GetHeight())};
+      packer.Update({}, changed);
+
+      THEN("It keeps its placement")
+      {
+        CHECK(samePlacement(changed[0], old_rects[42]));
+        CHECK(samePlacement(packer.GetRect(42), old_rects[42]));
+      }
+    }
+
+    WHEN("Most Rect are removed")
+    {
+      std::vector<unsigned long int> removed;
+      for (unsigned long int rect_i = 0; rect_i < 450; rect_i++)
+      {
+        removed.push_back(rect_i);
+      }
+      const auto packed_all = packer.Update(removed, {});
+
+      THEN("The whole manifest is packed again into fewer pages")
+      {
+        CHECK(packed_all);
+        CHECK(packer.GetFullPackCount() == 2);
+        CHECK(packer.GetPacker().GetPageCount() < page_count);
+        CHECK(mpbp::Validate(packer.GetRects(), packer.GetPacker()).GetIsValid());
+      }
+    }
+
+    WHEN("An unknown identifier is removed")
+    {
+      const std::vector<unsigned long int> removed = {7, 1000};
+      std::vector<mpbp::Rect> changed = {mpbp::Rect(600, 8, 8)};
+
+      THEN("An exception is thrown and the manifest is not changed")
+      {
+        CHECK_THROWS(packer.Update(removed, changed));
+        CHECK(packer.GetRectCount() == 500);
+        CHECK(samePlacement(packer.GetRect(7), old_rects[7]));
+      }
+    }
+
+    WHEN("A Rect that does not fit a page is added")
+    {
+      std::vector<mpbp::Rect> changed = {mpbp::Rect(600, 8, 8), mpbp::Rect(601, 300, 8)};
+
+      THEN("An exception is thrown and the manifest is not changed")
+      {
+        CHECK_THROWS(packer.Update({}, changed));
+        CHECK(packer.GetRectCount() == 500);
+        CHECK(packer.GetPacker().GetSpaces().size() > 0);
+      }
+    }
+  }
+}
+
+SCENARIO("IncrementalPacker packs a manifest built by updates only again once it fragments")
+{
+  GIVEN("An IncrementalPacker with max dimensions (256, 256) that has added 500 Rect by an update")
+  {
+    mpbp::IncrementalPacker packer(256, 256);
+    std::vector<mpbp::Rect> rects;
+    for (unsigned long int rect_i = 0; rect_i < 500; rect_i++)
+    {
+      rects.emplace_back(rect_i, 2 + static_cast<int>(rect_i * 7 % 29),
+                         2 + static_cast<int>(rect_i * 11 % 23));
+    }
+    const auto first_packed_all = packer.Update({}, rects);
+    const auto page_count = packer.GetPacker().GetPageCount();
+
+    WHEN("Most Rect are removed")
+    {
+      std::vector<unsigned long int> removed;
+      for (unsigned long int rect_i = 0; rect_i < 450; rect_i++)
+      {
+        removed.push_back(rect_i);
+      }
+      const auto packed_all = packer.Update(removed, {});
+
+      THEN("The whole manifest is packed again into fewer pages")
+      {
+        CHECK_FALSE(first_packed_all);
+        CHECK(packed_all);
+        CHECK(packer.GetFullPackCount() == 1);
+        CHECK(packer.GetPacker().GetPageCount() < page_count);
+        CHECK(mpbp::Validate(packer.GetRects(), packer.GetPacker()).GetIsValid());
+      }
+    }
+  }
+}
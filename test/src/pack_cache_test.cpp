@@ -0,0 +1,200 @@
+// SPDX-FileCopyrightText: 2022 Daniel Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+#include <catch2/catch_all.hpp>
+#include <mpbp/PackCache.hpp>
+#include <mpbp/Packer.hpp>
+#include <mpbp/Rect.hpp>
+#include <mpbp/Validation.hpp>
+#include <algorithm>
+#include <filesystem>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include "test_rects.hpp"
+
+namespace
+{
+  auto placements(const std::vector<mpbp::Rect>& rects)
+  {
+    std::vector<std::tuple<int, int, int, int, int>> result;
+    for (const auto& rect : rects)
+    {
+      result.emplace_back(rect.GetWidth(), rect.GetHeight(), rect.GetLeftX(), rect.GetTopY(),
+                          rect.GetPage());
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+  }
+}  // namespace
+
+SCENARIO("PackCache loads the result of a pack of the same Rect")
+{
+  GIVEN("A PackCache in an empty directory and a Packer that packed 300 Rect through it")
+  {
+    const auto directory = std::filesystem::temp_directory_path() / "mpbp_pack_cache_test";
+    std::filesystem::remove_all(directory);
+    mpbp::PackCache cache(directory, 1 << 20);
+    mpbp::Packer packer(128, 128);
+    auto rects = mpbp_test::makeRects(300);
+    const auto hit = cache.Pack(packer, rects);
+    REQUIRE_FALSE(hit);
+    REQUIRE(cache.GetMissCount() == 1);
+    REQUIRE(cache.GetHitCount() == 0);
+    REQUIRE(cache.GetSize() > 0);
+
+    WHEN("The same Rect are packed in reverse order with other identifiers by a new Packer")
+    {
+      mpbp::Packer cached_packer(128, 128);
+      auto cached_rects = mpbp_test::makeRects(300, 0, 1000);
+      std::reverse(cached_rects.begin(), cached_rects.end());
+      const auto identifiers = cached_rects;
+      const auto cached_hit = cache.Pack(cached_packer, cached_rects);
+
+      THEN("The placements and the pages are loaded from the cache")
+      {
+        REQUIRE(cached_hit);
+        REQUIRE(cache.GetHitCount() == 1);
+        REQUIRE(cache.GetMissCount() == 1);
+        for (std::size_t rect_i = 0; rect_i < cached_rects.size(); rect_i++)
+        {
+          REQUIRE(cached_rects[rect_i].GetIdentifier() == identifiers[rect_i].GetIdentifier());
+        }
+        REQUIRE(placements(cached_rects) == placements(rects));
+        REQUIRE(cached_packer.GetPageCount() == packer.GetPageCount());
+        REQUIRE(cached_packer.GetWidth() == packer.GetWidth());
+        REQUIRE(cached_packer.GetHeight() == packer.GetHeight());
+        REQUIRE(mpbp::Validate(cached_rects, cached_packer).GetIsValid());
+      }
+      THEN("Later packs continue from the loaded state")
+      {
+        auto more_rects = mpbp_test::makeRects(50, 5, 2000);
+        auto cached_more_rects = more_rects;
+        packer.Pack(more_rects);
+        cached_packer.Pack(cached_more_rects);
+        REQUIRE(placements(cached_more_rects) == placements(more_rects));
+        REQUIRE(cached_packer.GetPageCount() == packer.GetPageCount());
+      }
+    }
+    WHEN("The same Rect are packed by a Packer with different options")
+    {
+      mpbp::Packer padded_packer(128, 128);
+      padded_packer.SetPadding(1);
+      auto padded_rects = mpbp_test::makeRects(300);
+      const auto padded_hit = cache.Pack(padded_packer, padded_rects);
+
+      THEN("The cache misses")
+      {
+        REQUIRE_FALSE(padded_hit);
+        REQUIRE(cache.GetMissCount() == 2);
+      }
+    }
+    WHEN("The Packer that is used already has pages")
+    {
+      THEN("An exception is thrown")
+      {
+        REQUIRE_THROWS_AS(cache.Pack(packer, rects), std::runtime_error);
+      }
+    }
+    std::filesystem::remove_all(directory);
+  }
+}
+
+SCENARIO("PackCache evicts the least recently used results")
+{
+  GIVEN("The sizes of the cache files of three different packs")
+  {
+    const auto directory = std::filesystem::temp_directory_path() / "mpbp_pack_cache_lru_test";
+    std::filesystem::remove_all(directory);
+    auto pack = [&](mpbp::PackCache& cache, int seed)
+    {
+      mpbp::Packer packer(128, 128);
+      auto rects = mpbp_test::makeRects(100, seed);
+      return cache.Pack(packer, rects);
+    };
+    std::uintmax_t total_size = 0;
+    {
+      mpbp::PackCache sizing_cache(directory, 1 << 20);
+      for (int seed = 1; seed <= 3; seed++) pack(sizing_cache, seed);
+      total_size = sizing_cache.GetSize();
+      sizing_cache.Clear();
+      REQUIRE(sizing_cache.GetSize() == 0);
+    }
+
+    WHEN("The first pack is used again before the third pack is stored in a cache too small for "
+         "all three")
+    {
+      mpbp::PackCache cache(directory, total_size - 1);
+      pack(cache, 1);
+      pack(cache, 2);
+      const auto first_hit = pack(cache, 1);
+      pack(cache, 3);
+
+      THEN("The second pack is evicted")
+      {
+        REQUIRE(first_hit);
+        REQUIRE(cache.GetEvictionCount() == 1);
+        REQUIRE(cache.GetSize() <= cache.GetMaxSize());
+        REQUIRE(pack(cache, 1));
+        REQUIRE(pack(cache, 3));
+        REQUIRE_FALSE(pack(cache, 2));
+      }
+    }
+    std::filesystem::remove_all(directory);
+  }
+}
+
+SCENARIO("PackCache can be written by several threads at once")
+{
+  GIVEN("Eight threads that each pack the same 50 sets of Rect with a PackCache of their own in "
+        "one directory")
+  {
+    const auto directory = std::filesystem::temp_directory_path() / "mpbp_pack_cache_thread_test";
+    std::filesystem::remove_all(directory);
+    mpbp::PackCache(directory, 1 << 24);
+    std::vector<int> valid_counts(8, 0);
+    std::vector<std::thread> threads;
+    for (std::size_t thread_i = 0; thread_i < valid_counts.size(); thread_i++)
+    {
+      threads.emplace_back(
+          [&, thread_i]()
+          {
+            mpbp::PackCache cache(directory, 1 << 24);
+            for (int seed = 0; seed < 50; seed++)
+            {
+              mpbp::Packer packer(64, 64);
+              auto rects = mpbp_test::makeRects(100, seed);
+              cache.Pack(packer, rects);
+              if (mpbp::Validate(rects, packer).GetIsValid()) valid_counts[thread_i]++;
+            }
+          });
+    }
+    for (auto& thread : threads) thread.join();
+
+    WHEN("The sets are packed again with a new PackCache")
+    {
+      mpbp::PackCache cache(directory, 1 << 24);
+      auto hit_count = 0;
+      for (int seed = 0; seed < 50; seed++)
+      {
+        mpbp::Packer packer(64, 64);
+        auto rects = mpbp_test::makeRects(100, seed);
+        if (cache.Pack(packer, rects)) hit_count++;
+      }
+
+      THEN("Every pack was valid, every set is loaded and no temporary file is left")
+      {
+        REQUIRE(valid_counts == std::vector<int>(8, 50));
+        REQUIRE(hit_count == 50);
+        for (const auto& entry : std::filesystem::directory_iterator(directory))
+        {
+          REQUIRE(entry.path().extension() == ".mpbp");
+        }
+      }
+    }
+    std::filesystem::remove_all(directory);
+  }
+}
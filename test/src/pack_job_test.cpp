@@ -0,0 +1,126 @@
+// SPDX-FileCopyrightText: 2022 Daniel Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+#include <catch2/catch_all.hpp>
+#include <mpbp/PackJob.hpp>
+#include <mpbp/Packer.hpp>
+#include <mpbp/Rect.hpp>
+#include <mpbp/ThreadPool.hpp>
+#include <mpbp/Validation.hpp>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace
+{
+  std::vector<std::vector<mpbp::Rect>> makeJobRects(std::size_t job_count)
+  {
+    std::vector<std::vector<mpbp::Rect>> job_rects(job_count);
+    for (std::size_t job_i = 0; job_i < job_count; job_i++)
+    {
+      for (unsigned long int rect_i = 0; rect_i < 20 + job_i % 50; rect_i++)
+      {
+        job_rects[job_i].emplace_back(rect_i, 1 + static_cast<int>((rect_i + job_i) * 7 % 23),
+                                      1 + static_cast<int>((rect_i * 3 + job_i) % 19));
+      }
+    }
+    return job_rects;
+  }
+
+  std::vector<mpbp::PackJob> makeJobs(std::vector<std::vector<mpbp::Rect>>& job_rects)
+  {
+    std::vector<mpbp::PackJob> jobs;
+    for (std::size_t job_i = 0; job_i < job_rects.size(); job_i++)
+    {
+      const auto max_size = 32 + static_cast<int>(job_i % 4) * 16;
+      jobs.emplace_back(job_rects[job_i], max_size, max_size);
+    }
+    return jobs;
+  }
+
+  bool sameAsPacker(std::vector<std::vector<mpbp::Rect>>& job_rects,
+                    const std::vector<mpbp::PackJob>& jobs)
+  {
+    auto expected_rects = makeJobRects(job_rects.size());
+    for (std::size_t job_i = 0; job_i < jobs.size(); job_i++)
+    {
+      mpbp::Packer packer(jobs[job_i].GetMaxWidth(), jobs[job_i].GetMaxHeight());
+      packer.Pack(expected_rects[job_i]);
+      if (packer.GetPageCount() != jobs[job_i].GetPageCount() ||
+          packer.GetWidth() != jobs[job_i].GetWidth() ||
+          packer.GetHeight() != jobs[job_i].GetHeight() ||
+          !mpbp::Validate(job_rects[job_i], packer).GetIsValid())
+      {
+        return false;
+      }
+      for (std::size_t rect_i = 0; rect_i < expected_rects[job_i].size(); rect_i++)
+      {
+        const auto& expected = expected_rects[job_i][rect_i];
+        const auto& rect = job_rects[job_i][rect_i];
+        if (expected.GetIdentifier() != rect.GetIdentifier() ||
+            expected.GetLeftX() != rect.GetLeftX() || expected.GetTopY() != rect.GetTopY() ||
+            expected.GetPage() != rect.GetPage())
+        {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+}  // namespace
+
+SCENARIO("PackMany packs independent jobs")
+{
+  GIVEN("200 jobs of Rect with different maximum page sizes")
+  {
+    auto job_rects = makeJobRects(200);
+    auto jobs = makeJobs(job_rects);
+
+    WHEN("The jobs are packed on a ThreadPool")
+    {
+      mpbp::ThreadPool thread_pool(4);
+      mpbp::PackMany(jobs, thread_pool);
+
+      THEN("Each job is packed like it would be by its own Packer")
+      {
+        CHECK(sameAsPacker(job_rects, jobs));
+      }
+    }
+
+    WHEN("The jobs are packed with an executor of the caller")
+    {
+      mpbp::ThreadPool thread_pool(3);
+      mpbp::PackMany(jobs, [&](std::function<void()> task)
+                     { thread_pool.Submit(std::move(task)); });
+
+      THEN("Each job is packed like it would be by its own Packer")
+      {
+        CHECK(sameAsPacker(job_rects, jobs));
+      }
+    }
+
+    WHEN("The jobs are packed with an executor that runs each task right away")
+    {
+      mpbp::PackMany(jobs, [](std::function<void()> task) { task(); });
+
+      THEN("Each job is packed like it would be by its own Packer")
+      {
+        CHECK(sameAsPacker(job_rects, jobs));
+      }
+    }
+  }
+
+  GIVEN("A job with a Rect that does not fit its pages")
+  {
+    auto job_rects = makeJobRects(8);
+    job_rects[3].emplace_back(100, 500, 500);
+    auto jobs = makeJobs(job_rects);
+
+    THEN("Packing the jobs throws an exception")
+    {
+      CHECK_THROWS(mpbp::PackMany(jobs));
+      CHECK_THROWS(mpbp::PackMany(jobs, [](std::function<void()> task) { task(); }));
+    }
+  }
+}
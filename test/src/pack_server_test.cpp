@@ -0,0 +1,227 @@
+// SPDX-FileCopyrightText: 2022 Daniel Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+#include <catch2/catch_all.hpp>
+#include <mpbp/PackChannel.hpp>
+#include <mpbp/PackClient.hpp>
+#include <mpbp/PackServer.hpp>
+#include <mpbp/Packer.hpp>
+#include <mpbp/Rect.hpp>
+#include <mpbp/Validation.hpp>
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "test_rects.hpp"
+
+namespace
+{
+  // Runs a PackServer on a thread for the lifetime of a test.
+  class ServerThread
+  {
+   private:
+    mpbp::PackServer& server;
+    std::thread thread;
+
+   public:
+    explicit ServerThread(mpbp::PackServer& server)
+        : server(server), thread([&server]() { server.Run(); })
+    {
+    }
+    ~ServerThread()
+    {
+      this->server.Stop();
+      this->thread.join();
+    }
+  };
+}  // namespace
+
+SCENARIO("PackClient packs Rect in a PackServer like a Packer")
+{
+  GIVEN("A PackServer on a socket and a PackClient with 4 slots of 4000 Rect")
+  {
+    const auto socket_path = std::filesystem::temp_directory_path() / "mpbp_pack_server_test.sock";
+    mpbp::PackServer server(socket_path, 2);
+    ServerThread server_thread(server);
+    mpbp::PackClient client(socket_path, 4, 4000);
+
+    WHEN("2000 Rect are packed through the client")
+    {
+      auto rects = mpbp_test::makeRects(2000);
+      const auto response = client.Pack(rects, 128, 128);
+
+      THEN("The placements are the same as by a Packer in this process")
+      {
+        mpbp::Packer packer(128, 128);
+        auto local_rects = mpbp_test::makeRects(2000);
+        packer.Pack(local_rects);
+        REQUIRE(response.GetPageCount() == packer.GetPageCount());
+        REQUIRE(response.GetWidth() == packer.GetWidth());
+        REQUIRE(response.GetHeight() == packer.GetHeight());
+        REQUIRE_FALSE(response.GetCacheHit());
+        for (std::size_t rect_i = 0; rect_i < rects.size(); rect_i++)
+        {
+          REQUIRE(rects[rect_i].GetIdentifier() == local_rects[rect_i].GetIdentifier());
+          REQUIRE(rects[rect_i].GetLeftX() == local_rects[rect_i].GetLeftX());
+          REQUIRE(rects[rect_i].GetTopY() == local_rects[rect_i].GetTopY());
+          REQUIRE(rects[rect_i].GetPage() == local_rects[rect_i].GetPage());
+        }
+      }
+    }
+    WHEN("Six requests are written straight into the slots with up to four in flight")
+    {
+      std::deque<int> tickets;
+      std::vector<int> page_counts;
+      for (int request_i = 0; request_i < 6; request_i++)
+      {
+        if (tickets.size() == 4)
+        {
+          page_counts.push_back(client.Wait(tickets.front()).GetPageCount());
+          tickets.pop_front();
+        }
+        const auto source_rects = mpbp_test::makeRects(500 + request_i * 100, request_i);
+        auto slot_rects = client.Reserve(source_rects.size());
+        std::copy(source_rects.begin(), source_rects.end(), slot_rects.begin());
+        tickets.push_back(client.Submit(64, 64));
+      }
+      for (const auto ticket : tickets) page_counts.push_back(client.Wait(ticket).GetPageCount());
+
+      THEN("Every request is packed like by a Packer in this process")
+      {
+        REQUIRE(page_counts.size() == 6);
+        for (int request_i = 0; request_i < 6; request_i++)
+        {
+          mpbp::Packer packer(64, 64);
+          auto local_rects = mpbp_test::makeRects(500 + request_i * 100, request_i);
+          packer.Pack(local_rects);
+          REQUIRE(page_counts[request_i] == packer.GetPageCount());
+        }
+        REQUIRE(server.GetRequestCount() == 6);
+        REQUIRE(server.GetBatchCount() <= 6);
+      }
+    }
+    WHEN("A degenerate Rect is packed through the client")
+    {
+      auto rects = mpbp_test::makeRects(100);
+      rects.emplace_back(100, 0, 5);
+
+      THEN("The exception of the server is thrown by the client, and the client can still be used")
+      {
+        REQUIRE_THROWS_AS(client.Pack(rects, 128, 128), std::runtime_error);
+        auto valid_rects = mpbp_test::makeRects(100);
+        mpbp::Packer packer(128, 128);
+        auto local_rects = mpbp_test::makeRects(100);
+        packer.Pack(local_rects);
+        REQUIRE(client.Pack(valid_rects, 128, 128).GetPageCount() == packer.GetPageCount());
+      }
+    }
+    WHEN("Another client connects and sends only part of the name of its channel")
+    {
+      mpbp::PackChannel channel(1, 10);
+      char name[64] = {};
+      std::strncpy(name, channel.GetName().c_str(), sizeof(name) - 1);
+      sockaddr_un address = {};
+      address.sun_family = AF_UNIX;
+      std::strncpy(address.sun_path, socket_path.c_str(), sizeof(address.sun_path) - 1);
+      const auto socket = ::socket(AF_UNIX, SOCK_STREAM, 0);
+      REQUIRE(::connect(socket, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0);
+      REQUIRE(::send(socket, name, 10, MSG_NOSIGNAL) == 10);
+      auto rects = mpbp_test::makeRects(100);
+      const auto response = client.Pack(rects, 128, 128);
+      const auto rest_sent_size = ::send(socket, name + 10, sizeof(name) - 10, MSG_NOSIGNAL);
+      unsigned char accepted = 0;
+      const auto received_size = ::recv(socket, &accepted, 1, 0);
+      ::close(socket);
+
+      THEN("The PackClient is still served, and the other client is accepted once it sends the "
+           "rest")
+      {
+        mpbp::Packer packer(128, 128);
+        auto local_rects = mpbp_test::makeRects(100);
+        packer.Pack(local_rects);
+        REQUIRE(response.GetPageCount() == packer.GetPageCount());
+        REQUIRE(rest_sent_size == static_cast<ssize_t>(sizeof(name) - 10));
+        REQUIRE(received_size == 1);
+        REQUIRE(accepted == 1);
+      }
+    }
+    WHEN("A request is reserved while every slot has a ticket that was not waited for")
+    {
+      std::vector<int> tickets;
+      for (int request_i = 0; request_i < 4; request_i++)
+      {
+        auto rects = mpbp_test::makeRects(50, request_i);
+        auto slot_rects = client.Reserve(rects.size());
+        std::copy(rects.begin(), rects.end(), slot_rects.begin());
+        tickets.push_back(client.Submit(64, 64));
+      }
+
+      THEN("An exception is thrown, and every ticket can still be waited for")
+      {
+        REQUIRE_THROWS_AS(client.Reserve(50), std::runtime_error);
+        for (int request_i = 0; request_i < 4; request_i++)
+        {
+          mpbp::Packer packer(64, 64);
+          auto local_rects = mpbp_test::makeRects(50, request_i);
+          packer.Pack(local_rects);
+          REQUIRE(client.Wait(tickets[request_i]).GetPageCount() == packer.GetPageCount());
+        }
+        REQUIRE(client.Reserve(50).size() == 50);
+      }
+    }
+    WHEN("More Rect than the slot capacity are reserved")
+    {
+      THEN("An exception is thrown")
+      {
+        REQUIRE_THROWS_AS(client.Reserve(4001), std::runtime_error);
+      }
+    }
+  }
+}
+
+SCENARIO("PackServer loads repeated requests from its PackCache")
+{
+  GIVEN("A PackServer with a PackCache and two PackClient")
+  {
+    const auto socket_path = std::filesystem::temp_directory_path() / "mpbp_pack_server_test.sock";
+    const auto cache_directory =
+        std::filesystem::temp_directory_path() / "mpbp_pack_server_test_cache";
+    std::filesystem::remove_all(cache_directory);
+    mpbp::PackServer server(socket_path, 2);
+    server.SetCache(cache_directory, 1 << 20);
+    ServerThread server_thread(server);
+    mpbp::PackClient first_client(socket_path, 1, 1000);
+    mpbp::PackClient second_client(socket_path, 1, 1000);
+
+    WHEN("The same Rect are packed by both clients")
+    {
+      auto first_rects = mpbp_test::makeRects(800, 3);
+      auto second_rects = mpbp_test::makeRects(800, 3);
+      const auto first_response = first_client.Pack(first_rects, 96, 96);
+      const auto second_response = second_client.Pack(second_rects, 96, 96);
+
+      THEN("The second pack is loaded from the cache with valid placements")
+      {
+        REQUIRE_FALSE(first_response.GetCacheHit());
+        REQUIRE(second_response.GetCacheHit());
+        REQUIRE(server.GetCacheHitCount() == 1);
+        REQUIRE(second_response.GetPageCount() == first_response.GetPageCount());
+        mpbp::Packer packer(96, 96);
+        auto local_rects = mpbp_test::makeRects(800, 3);
+        packer.Pack(local_rects);
+        REQUIRE(mpbp::Validate(second_rects, packer).GetIsValid());
+      }
+    }
+  }
+  std::filesystem::remove_all(std::filesystem::temp_directory_path() /
+                              "mpbp_pack_server_test_cache");
+}
@@ -2,12 +2,18 @@
 //
 // SPDX-License-Identifier: MIT
 
+#include <algorithm>
 #include <catch2/catch_all.hpp>
+#include <mpbp/Fit.hpp>
+#include <mpbp/Move.hpp>
 #include <mpbp/Packer.hpp>
+#include <mpbp/PageSize.hpp>
 #include <mpbp/Rect.hpp>
 #include <mpbp/Space.hpp>
+#include <mpbp/ThreadPool.hpp>
 #include <vector>
 #include <cstddef>
+#include <cstdint>
 
 bool noRectIntersect(std::vector<mpbp::Rect>& rects)
 {
@@ -42,6 +48,41 @@ bool noUnplacedRect(std::vector<mpbp::Rect>& rects)
   return true;
 }
 
+bool allRectsInPages(std::vector<mpbp::Rect>& rects, const mpbp::Packer& packer)
+{
+  for (const auto& rect : rects)
+  {
+    if (rect.GetPage() < 0 || rect.GetPage() >= packer.GetPageCount() || rect.GetLeftX() < 0 ||
+        rect.GetTopY() < 0 || rect.GetRightX() >= packer.GetPageWidth(rect.GetPage()) ||
+        rect.GetBottomY() >= packer.GetPageHeight(rect.GetPage()))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool allGuttersClear(std::vector<mpbp::Rect>& rects, int gutter)
+{
+  for (std::size_t a_i = 0; a_i < rects.size(); a_i++)
+  {
+    const auto& recta = rects[a_i];
+    for (std::size_t b_i = a_i + 1; b_i < rects.size(); b_i++)
+    {
+      const auto& rectb = rects[b_i];
+      if (recta.GetPage() == rectb.GetPage() &&
+          recta.GetLeftX() < rectb.GetLeftX() + rectb.GetWidth() + gutter &&
+          rectb.GetLeftX() < recta.GetLeftX() + recta.GetWidth() + gutter &&
+          recta.GetTopY() < rectb.GetTopY() + rectb.GetHeight() + gutter &&
+          rectb.GetTopY() < recta.GetTopY() + recta.GetHeight() + gutter)
+      {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
 bool noInvalidSpace(std::vector<mpbp::Space> spaces)
 {
   for (const auto& space : spaces)
@@ -122,3 +163,977 @@ SCENARIO("Packer is used to bin pack")
     }
   }
 }
+
+SCENARIO("Packer grows the top bin around Rect that are taller or wider than it")
+{
+  GIVEN("A Packer with max dimensions (32, 32)")
+  {
+    mpbp::Packer packer(32, 32);
+
+    GIVEN("Rect where one must be placed right of a bin that is shorter than it")
+    {
+      std::vector<mpbp::Rect> rects = {mpbp::Rect(0, 18, 11), mpbp::Rect(1, 18, 4),
+                                       mpbp::Rect(2, 13, 18), mpbp::Rect(3, 14, 10),
+                                       mpbp::Rect(4, 10, 10)};
+
+      WHEN("The vector of Rect is packed")
+      {
+        packer.Pack(rects);
+
+        THEN("No Rect intersect") { CHECK(noRectIntersect(rects)); }
+        THEN("All rects are placed") { CHECK(noUnplacedRect(rects)); }
+        THEN("The bin contains every Rect of the top page")
+        {
+          CHECK(packer.GetTopBinHeight() >= 18);
+        }
+      }
+    }
+  }
+}
+
+SCENARIO("Packer prunes Space that no remaining Rect can fit in")
+{
+  GIVEN("A Packer with max dimensions (512, 512)")
+  {
+    mpbp::Packer packer(512, 512);
+
+    GIVEN("A vector of Rect where one leaves narrow Space that the rest can not fit in")
+    {
+      std::vector<mpbp::Rect> rects = {mpbp::Rect(0, 500, 500), mpbp::Rect(1, 20, 20),
+                                       mpbp::Rect(2, 20, 20), mpbp::Rect(3, 20, 20)};
+      auto has_narrow_space = [&]()
+      {
+        for (const auto& space : packer.GetSpaces())
+        {
+          if (space.GetWidth() < 20 || space.GetHeight() < 20) return true;
+        }
+        return false;
+      };
+
+      WHEN("The vector of Rect is packed while keeping unreachable Space")
+      {
+        packer.Pack(rects);
+
+        THEN("No Space is pruned") { CHECK(packer.GetPrunedSpaceCount() == 0); }
+        THEN("The narrow Space is kept") { CHECK(has_narrow_space()); }
+      }
+
+      WHEN("The vector of Rect is packed while setting aside unreachable Space")
+      {
+        packer.SetPruneMode(mpbp::PruneMode::SetAside);
+        packer.Pack(rects);
+
+        THEN("No Rect intersect") { CHECK(noRectIntersect(rects)); }
+        THEN("All rects are placed") { CHECK(noUnplacedRect(rects)); }
+        THEN("No spaces are invalid") { CHECK(noInvalidSpace(packer.GetSpaces())); }
+        THEN("Space is pruned") { CHECK(packer.GetPrunedSpaceCount() > 0); }
+        THEN("The narrow Space is restored after the pack") { CHECK(has_narrow_space()); }
+      }
+
+      WHEN("The vector of Rect is packed while dropping unreachable Space")
+      {
+        packer.SetPruneMode(mpbp::PruneMode::Drop);
+        packer.Pack(rects);
+
+        THEN("No Rect intersect") { CHECK(noRectIntersect(rects)); }
+        THEN("All rects are placed") { CHECK(noUnplacedRect(rects)); }
+        THEN("Space is pruned") { CHECK(packer.GetPrunedSpaceCount() > 0); }
+        THEN("The narrow Space is discarded") { CHECK(!has_narrow_space()); }
+      }
+    }
+  }
+}
+
+SCENARIO("Packer packs into a catalogue of page sizes")
+{
+  GIVEN("A Packer with page sizes (16, 16), (32, 32) and (64, 64)")
+  {
+    std::vector<mpbp::PageSize> page_sizes = {mpbp::PageSize(64, 64), mpbp::PageSize(16, 16),
+                                              mpbp::PageSize(32, 32)};
+    mpbp::Packer packer(page_sizes);
+
+    THEN("The page sizes are ordered by area")
+    {
+      REQUIRE(packer.GetPageSizes().size() == 3);
+      CHECK(packer.GetPageSizes().front().GetWidth() == 16);
+      CHECK(packer.GetPageSizes().back().GetWidth() == 64);
+    }
+
+    WHEN("A Rect that fills the largest page and four small Rect are packed")
+    {
+      std::vector<mpbp::Rect> rects = {mpbp::Rect(0, 64, 64), mpbp::Rect(1, 8, 8),
+                                       mpbp::Rect(2, 8, 8), mpbp::Rect(3, 8, 8),
+                                       mpbp::Rect(4, 8, 8)};
+      packer.Pack(rects);
+
+      THEN("No Rect intersect") { CHECK(noRectIntersect(rects)); }
+      THEN("All rects are placed") { CHECK(noUnplacedRect(rects)); }
+      THEN("The small Rect are packed into the smallest page")
+      {
+        REQUIRE(packer.GetPageCount() == 2);
+        CHECK(packer.GetPageWidth(0) == 64);
+        CHECK(packer.GetPageHeight(0) == 64);
+        CHECK(packer.GetPageWidth(1) == 16);
+        CHECK(packer.GetPageHeight(1) == 16);
+        CHECK(packer.GetPageArea() == 64 * 64 + 16 * 16);
+      }
+      THEN("Every Rect is within its page")
+      {
+        for (const auto& rect : rects)
+        {
+          CHECK(rect.GetRightX() < packer.GetPageWidth(rect.GetPage()));
+          CHECK(rect.GetBottomY() < packer.GetPageHeight(rect.GetPage()));
+        }
+      }
+    }
+
+    WHEN("A Rect larger than every page size is packed")
+    {
+      std::vector<mpbp::Rect> rects = {mpbp::Rect(0, 65, 1)};
+
+      THEN("The Packer throws an exception") { CHECK_THROWS(packer.Pack(rects)); }
+    }
+  }
+
+  GIVEN("A Packer with page sizes (16, 16) and (32, 32) where only one page may be (32, 32)")
+  {
+    std::vector<mpbp::PageSize> page_sizes = {mpbp::PageSize(16, 16), mpbp::PageSize(32, 32, 1)};
+    mpbp::Packer packer(page_sizes);
+
+    WHEN("Two Rect that need the larger page are packed")
+    {
+      std::vector<mpbp::Rect> rects = {mpbp::Rect(0, 32, 32), mpbp::Rect(1, 20, 20)};
+
+      THEN("The Packer throws an exception") { CHECK_THROWS(packer.Pack(rects)); }
+    }
+
+    WHEN("A Rect that needs the larger page and small Rect are packed")
+    {
+      std::vector<mpbp::Rect> rects = {mpbp::Rect(0, 32, 32), mpbp::Rect(1, 16, 16),
+                                       mpbp::Rect(2, 16, 16)};
+      packer.Pack(rects);
+
+      THEN("The later pages use the smaller size")
+      {
+        REQUIRE(packer.GetPageCount() == 3);
+        CHECK(packer.GetPageWidth(0) == 32);
+        CHECK(packer.GetPageWidth(1) == 16);
+        CHECK(packer.GetPageWidth(2) == 16);
+      }
+    }
+  }
+}
+
+SCENARIO("Packer closes bin pages")
+{
+  GIVEN("A Packer with max dimensions (64, 64) that has packed two pages")
+  {
+    mpbp::Packer packer(64, 64);
+    std::vector<mpbp::Rect> rects = {mpbp::Rect(0, 60, 60), mpbp::Rect(1, 60, 60)};
+    packer.Pack(rects);
+    REQUIRE(packer.GetPageCount() == 2);
+    auto page_space_count = [&](int page)
+    {
+      int count = 0;
+      for (const auto& space : packer.GetSpaces())
+      {
+        if (space.GetPage() == page) count++;
+      }
+      return count;
+    };
+    REQUIRE(page_space_count(0) > 0);
+
+    WHEN("The first page is closed")
+    {
+      packer.ClosePage(0);
+
+      THEN("The page is closed and its Space is released")
+      {
+        CHECK(packer.GetIsPageClosed(0));
+        CHECK(!packer.GetIsPageClosed(1));
+        CHECK(packer.GetClosedPageCount() == 1);
+        CHECK(page_space_count(0) == 0);
+      }
+
+      WHEN("More Rect are packed")
+      {
+        std::vector<mpbp::Rect> more_rects = {mpbp::Rect(2, 4, 4), mpbp::Rect(3, 4, 4)};
+        packer.Pack(more_rects);
+
+        THEN("No Rect is packed into the closed page")
+        {
+          for (const auto& rect : more_rects)
+          {
+            CHECK(rect.GetPage() != 0);
+          }
+        }
+      }
+    }
+
+    WHEN("The top page is closed and more Rect are packed")
+    {
+      packer.ClosePage(1);
+      std::vector<mpbp::Rect> more_rects = {mpbp::Rect(2, 10, 10)};
+      packer.Pack(more_rects);
+
+      THEN("The Rect is not packed into the closed page")
+      {
+        CHECK(more_rects.front().GetPage() != 1);
+      }
+    }
+
+    THEN("Closing a page that does not exist throws an exception")
+    {
+      CHECK_THROWS(packer.ClosePage(2));
+    }
+  }
+
+  GIVEN("A Packer with max dimensions (64, 64) that closes pages which can not fit (8, 8)")
+  {
+    mpbp::Packer packer(64, 64);
+    packer.SetCloseThreshold(8, 8);
+
+    WHEN("Rect that leave only narrow Space on the first page are packed")
+    {
+      std::vector<mpbp::Rect> rects = {mpbp::Rect(0, 60, 60), mpbp::Rect(1, 60, 60)};
+      packer.Pack(rects);
+
+      THEN("The first page is closed and the top page is open")
+      {
+        CHECK(packer.GetIsPageClosed(0));
+        CHECK(!packer.GetIsPageClosed(1));
+      }
+      THEN("No Space remains on the closed page")
+      {
+        for (const auto& space : packer.GetSpaces())
+        {
+          CHECK(space.GetPage() != 0);
+        }
+      }
+    }
+  }
+}
+
+SCENARIO("Packer keeps groups of Rect together")
+{
+  GIVEN("A Packer with max dimensions (64, 64)")
+  {
+    mpbp::Packer packer(64, 64);
+
+    GIVEN("Two interleaved groups of Rect that each fill most of a page")
+    {
+      std::vector<mpbp::Rect> rects;
+      for (unsigned long int rect_i = 0; rect_i < 8; rect_i++)
+      {
+        rects.emplace_back(rect_i, 30, 30, static_cast<int>(rect_i % 2));
+      }
+
+      WHEN("The vector of Rect is packed")
+      {
+        packer.Pack(rects);
+
+        THEN("No Rect intersect") { CHECK(noRectIntersect(rects)); }
+        THEN("All rects are placed") { CHECK(noUnplacedRect(rects)); }
+        THEN("Each group touches a single different page")
+        {
+          REQUIRE(packer.GetGroupPages(0).size() == 1);
+          REQUIRE(packer.GetGroupPages(1).size() == 1);
+          CHECK(packer.GetGroupPages(0).front() != packer.GetGroupPages(1).front());
+        }
+        THEN("Every Rect is on a page of its group")
+        {
+          for (const auto& rect : rects)
+          {
+            CHECK(rect.GetPage() == packer.GetGroupPages(rect.GetGroup()).front());
+          }
+        }
+        THEN("A group that was not packed touches no pages")
+        {
+          CHECK(packer.GetGroupPages(2).empty());
+        }
+      }
+    }
+  }
+}
+
+SCENARIO("Packer packs duplicate Rect only once")
+{
+  GIVEN("A Packer with max dimensions (64, 64)")
+  {
+    mpbp::Packer packer(64, 64);
+
+    GIVEN("A vector of Rect where several share content hashes")
+    {
+      std::vector<mpbp::Rect> rects = {mpbp::Rect(0, 8, 8),   mpbp::Rect(1, 8, 8),
+                                       mpbp::Rect(2, 16, 16), mpbp::Rect(3, 16, 16),
+                                       mpbp::Rect(4, 16, 16), mpbp::Rect(5, 4, 4)};
+      std::vector<std::uint64_t> hashes = {10, 10, 20, 20, 20, 30};
+
+      WHEN("The vector of Rect is packed with the content hashes")
+      {
+        packer.Pack(rects, hashes);
+
+        THEN("All rects are placed") { CHECK(noUnplacedRect(rects)); }
+        THEN("The order of the Rect is unchanged")
+        {
+          for (std::size_t rect_i = 0; rect_i < rects.size(); rect_i++)
+          {
+            CHECK(rects[rect_i].GetIdentifier() == rect_i);
+          }
+        }
+        THEN("Duplicates share a placement")
+        {
+          CHECK(rects[0].GetLeftX() == rects[1].GetLeftX());
+          CHECK(rects[0].GetTopY() == rects[1].GetTopY());
+          CHECK(rects[0].GetPage() == rects[1].GetPage());
+          CHECK(rects[2].GetLeftX() == rects[4].GetLeftX());
+          CHECK(rects[2].GetTopY() == rects[4].GetTopY());
+          CHECK(rects[2].GetPage() == rects[4].GetPage());
+        }
+        THEN("Only unique Rect intersect nothing")
+        {
+          std::vector<mpbp::Rect> unique_rects = {rects[0], rects[2], rects[5]};
+          CHECK(noRectIntersect(unique_rects));
+        }
+        THEN("The duplicates are counted") { CHECK(packer.GetDuplicateCount() == 3); }
+      }
+    }
+
+    GIVEN("A vector of Rect where Rect of two sizes share one content hash")
+    {
+      std::vector<mpbp::Rect> rects = {mpbp::Rect(0, 8, 8), mpbp::Rect(1, 4, 4),
+                                       mpbp::Rect(2, 4, 4)};
+      std::vector<std::uint64_t> hashes = {10, 10, 10};
+
+      WHEN("The vector of Rect is packed with the content hashes")
+      {
+        packer.Pack(rects, hashes);
+
+        THEN("The Rect of the same size share a placement")
+        {
+          CHECK(rects[1].GetLeftX() == rects[2].GetLeftX());
+          CHECK(rects[1].GetTopY() == rects[2].GetTopY());
+          CHECK(packer.GetDuplicateCount() == 1);
+        }
+      }
+    }
+
+    GIVEN("A vector of Rect where a duplicate is in a different group than the first Rect")
+    {
+      std::vector<mpbp::Rect> rects = {mpbp::Rect(0, 8, 8, 1), mpbp::Rect(1, 8, 8, 2)};
+      std::vector<std::uint64_t> hashes = {10, 10};
+
+      WHEN("The vector of Rect is packed with the content hashes")
+      {
+        packer.Pack(rects, hashes);
+
+        THEN("The group of the duplicate is recorded on the shared page")
+        {
+          REQUIRE(packer.GetDuplicateCount() == 1);
+          REQUIRE(packer.GetGroupPages(2).size() == 1);
+          CHECK(packer.GetGroupPages(2)[0] == rects[1].GetPage());
+        }
+      }
+    }
+
+    GIVEN("A vector of Rect and a different amount of content hashes")
+    {
+      std::vector<mpbp::Rect> rects = {mpbp::Rect(0, 8, 8), mpbp::Rect(1, 8, 8)};
+      std::vector<std::uint64_t> hashes = {10};
+
+      THEN("The Packer throws an exception") { CHECK_THROWS(packer.Pack(rects, hashes)); }
+    }
+  }
+}
+
+SCENARIO("Packer places runs of identically sized Rect as grids")
+{
+  GIVEN("A Packer with max dimensions (256, 256)")
+  {
+    mpbp::Packer packer(256, 256);
+
+    GIVEN("1000 Rect with a width and height of 8")
+    {
+      std::vector<mpbp::Rect> rects;
+      for (unsigned long int rect_i = 0; rect_i < 1000; rect_i++)
+      {
+        rects.emplace_back(rect_i, 8, 8);
+      }
+
+      WHEN("The vector of Rect is packed")
+      {
+        packer.Pack(rects);
+
+        THEN("No Rect intersect") { CHECK(noRectIntersect(rects)); }
+        THEN("All rects are placed") { CHECK(noUnplacedRect(rects)); }
+        THEN("All rects are within their pages") { CHECK(allRectsInPages(rects, packer)); }
+        THEN("No spaces are invalid") { CHECK(noInvalidSpace(packer.GetSpaces())); }
+        THEN("The Rect fit in one page") { CHECK(packer.GetPageCount() == 1); }
+      }
+    }
+
+    GIVEN("A large Rect and runs of small identically sized Rect that need several pages")
+    {
+      std::vector<mpbp::Rect> rects = {mpbp::Rect(0, 200, 120)};
+      for (unsigned long int rect_i = 1; rect_i < 1500; rect_i++)
+      {
+        rects.emplace_back(rect_i, rect_i % 2 == 0 ? 12 : 7, rect_i % 2 == 0 ? 5 : 9);
+      }
+
+      WHEN("The vector of Rect is packed")
+      {
+        packer.Pack(rects);
+
+        THEN("No Rect intersect") { CHECK(noRectIntersect(rects)); }
+        THEN("All rects are placed") { CHECK(noUnplacedRect(rects)); }
+        THEN("All rects are within their pages") { CHECK(allRectsInPages(rects, packer)); }
+        THEN("No spaces are invalid") { CHECK(noInvalidSpace(packer.GetSpaces())); }
+      }
+
+      WHEN("The vector of Rect is cut in half and packed online")
+      {
+        auto half_way = rects.size() / 2;
+        std::span<mpbp::Rect> spana(&rects.front(), half_way);
+        std::span<mpbp::Rect> spanb(&rects.front() + half_way, rects.size() - half_way);
+        packer.Pack(spana);
+        packer.Pack(spanb);
+
+        THEN("No Rect intersect") { CHECK(noRectIntersect(rects)); }
+        THEN("All rects are placed") { CHECK(noUnplacedRect(rects)); }
+        THEN("All rects are within their pages") { CHECK(allRectsInPages(rects, packer)); }
+      }
+    }
+  }
+}
+
+SCENARIO("Packer packs objects of any type with projections")
+{
+  struct Sprite
+  {
+    int width;
+    int height;
+    int left_x = -1;
+    int top_y = -1;
+    int page = -1;
+  };
+
+  GIVEN("A Packer with max dimensions (64, 64)")
+  {
+    mpbp::Packer packer(64, 64);
+
+    GIVEN("A vector of sprites with various sizes")
+    {
+      std::vector<Sprite> sprites;
+      for (int sprite_i = 0; sprite_i < 100; sprite_i++)
+      {
+        sprites.push_back(Sprite{.width = 1 + sprite_i % 13, .height = 1 + sprite_i % 7});
+      }
+
+      WHEN("The sprites are packed with projections")
+      {
+        packer.Pack(sprites, &Sprite::width, [](const Sprite& sprite) { return sprite.height; },
+                    [](Sprite& sprite, int left_x, int top_y, int page)
+                    {
+                      sprite.left_x = left_x;
+                      sprite.top_y = top_y;
+                      sprite.page = page;
+                    });
+
+        THEN("The placements match packing the same Rect")
+        {
+          std::vector<mpbp::Rect> rects;
+          for (std::size_t sprite_i = 0; sprite_i < sprites.size(); sprite_i++)
+          {
+            rects.emplace_back(sprite_i, sprites[sprite_i].width, sprites[sprite_i].height);
+          }
+          mpbp::Packer rect_packer(64, 64);
+          rect_packer.Pack(rects);
+          for (const auto& rect : rects)
+          {
+            const auto& sprite = sprites[rect.GetIdentifier()];
+            CHECK(sprite.left_x == rect.GetLeftX());
+            CHECK(sprite.top_y == rect.GetTopY());
+            CHECK(sprite.page == rect.GetPage());
+          }
+          CHECK(packer.GetPageCount() == rect_packer.GetPageCount());
+        }
+        THEN("The order of the sprites is not changed")
+        {
+          for (int sprite_i = 0; sprite_i < 100; sprite_i++)
+          {
+            CHECK(sprites[sprite_i].width == 1 + sprite_i % 13);
+          }
+        }
+      }
+    }
+  }
+}
+
+bool sameSpaces(const std::vector<mpbp::Space>& a, const std::vector<mpbp::Space>& b)
+{
+  if (a.size() != b.size()) return false;
+  for (std::size_t space_i = 0; space_i < a.size(); space_i++)
+  {
+    if (a[space_i].GetLeftX() != b[space_i].GetLeftX() ||
+        a[space_i].GetTopY() != b[space_i].GetTopY() ||
+        a[space_i].GetPage() != b[space_i].GetPage() ||
+        a[space_i].GetWidth() != b[space_i].GetWidth() ||
+        a[space_i].GetHeight() != b[space_i].GetHeight())
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+SCENARIO("Packer rolls back to a checkpoint")
+{
+  GIVEN("A Packer with max dimensions (128, 128) that has packed one batch of Rect")
+  {
+    mpbp::Packer packer(128, 128);
+    packer.SetPruneMode(mpbp::PruneMode::SetAside);
+    packer.SetCloseThreshold(4, 4);
+    std::vector<mpbp::Rect> first_batch;
+    for (unsigned long int rect_i = 0; rect_i < 60; rect_i++)
+    {
+      first_batch.emplace_back(rect_i, 3 + rect_i % 29, 2 + rect_i % 17,
+                               static_cast<int>(rect_i % 3) - 1);
+    }
+    packer.Pack(first_batch);
+    const auto spaces = packer.GetSpaces();
+    const auto page_count = packer.GetPageCount();
+    const auto width = packer.GetWidth();
+    const auto height = packer.GetHeight();
+    const auto top_bin_width = packer.GetTopBinWidth();
+    const auto top_bin_height = packer.GetTopBinHeight();
+    const auto closed_page_count = packer.GetClosedPageCount();
+    const auto group_pages = packer.GetGroupPages(1);
+    std::vector<mpbp::Rect> second_batch;
+    for (unsigned long int rect_i = 0; rect_i < 300; rect_i++)
+    {
+      second_batch.emplace_back(rect_i, 1 + rect_i % 23, 1 + rect_i % 31,
+                                static_cast<int>(rect_i % 4) - 1);
+    }
+
+    WHEN("A second batch is packed after a checkpoint and rolled back")
+    {
+      packer.Checkpoint();
+      packer.Pack(second_batch);
+      REQUIRE(packer.GetPageCount() > page_count);
+      packer.Rollback();
+
+      THEN("The Packer is in the same state as before the checkpoint")
+      {
+        CHECK(sameSpaces(packer.GetSpaces(), spaces));
+        CHECK(packer.GetPageCount() == page_count);
+        CHECK(packer.GetWidth() == width);
+        CHECK(packer.GetHeight() == height);
+        CHECK(packer.GetTopBinWidth() == top_bin_width);
+        CHECK(packer.GetTopBinHeight() == top_bin_height);
+        CHECK(packer.GetClosedPageCount() == closed_page_count);
+        CHECK(packer.GetGroupPages(1) == group_pages);
+        CHECK(packer.GetCheckpointCount() == 0);
+      }
+      THEN("Packing the second batch again gives the same result as a Packer that never rolled back")
+      {
+        mpbp::Packer other_packer(128, 128);
+        other_packer.SetPruneMode(mpbp::PruneMode::SetAside);
+        other_packer.SetCloseThreshold(4, 4);
+        auto other_first_batch = first_batch;
+        other_packer.Pack(other_first_batch);
+        auto other_second_batch = second_batch;
+        other_packer.Pack(other_second_batch);
+        packer.Pack(second_batch);
+        CHECK(sameSpaces(packer.GetSpaces(), other_packer.GetSpaces()));
+        CHECK(packer.GetPageCount() == other_packer.GetPageCount());
+        for (std::size_t rect_i = 0; rect_i < second_batch.size(); rect_i++)
+        {
+          CHECK(second_batch[rect_i].GetLeftX() == other_second_batch[rect_i].GetLeftX());
+          CHECK(second_batch[rect_i].GetTopY() == other_second_batch[rect_i].GetTopY());
+          CHECK(second_batch[rect_i].GetPage() == other_second_batch[rect_i].GetPage());
+        }
+      }
+    }
+
+    WHEN("Nested checkpoints are committed and rolled back")
+    {
+      packer.Checkpoint();
+      auto first_half = std::span<mpbp::Rect>(second_batch).first(150);
+      packer.Pack(first_half);
+      const auto half_spaces = packer.GetSpaces();
+      const auto half_page_count = packer.GetPageCount();
+      packer.Checkpoint();
+      packer.Pack(std::span<mpbp::Rect>(second_batch).subspan(150));
+      packer.Rollback();
+
+      THEN("The inner rollback only undoes the inner pack")
+      {
+        CHECK(sameSpaces(packer.GetSpaces(), half_spaces));
+        CHECK(packer.GetPageCount() == half_page_count);
+        CHECK(packer.GetCheckpointCount() == 1);
+      }
+
+      packer.Checkpoint();
+      packer.Pack(std::span<mpbp::Rect>(second_batch).subspan(150));
+      packer.Commit();
+      packer.Rollback();
+
+      THEN("The outer rollback undoes the committed inner pack too")
+      {
+        CHECK(sameSpaces(packer.GetSpaces(), spaces));
+        CHECK(packer.GetPageCount() == page_count);
+        CHECK(packer.GetCheckpointCount() == 0);
+      }
+    }
+
+    WHEN("There is no checkpoint")
+    {
+      THEN("Rolling back or committing throws an exception")
+      {
+        CHECK_THROWS(packer.Rollback());
+        CHECK_THROWS(packer.Commit());
+      }
+    }
+  }
+}
+
+SCENARIO("Packer answers if Rect would fit without packing them")
+{
+  GIVEN("A Packer with max dimensions (64, 64) that has filled most of two pages")
+  {
+    mpbp::Packer packer(64, 64);
+    std::vector<mpbp::Rect> rects = {mpbp::Rect(0, 64, 64), mpbp::Rect(1, 64, 48)};
+    packer.Pack(rects);
+    const auto spaces = packer.GetSpaces();
+    const auto page_count = packer.GetPageCount();
+
+    WHEN("A Rect that fits in the leftover Space is queried")
+    {
+      const std::vector<mpbp::Rect> query = {mpbp::Rect(2, 32, 16)};
+      const auto fit = packer.QueryFit(query);
+
+      THEN("It fits without new pages")
+      {
+        CHECK(fit.GetFits());
+        CHECK(fit.GetNewPageCount() == 0);
+      }
+      THEN("The Packer and the Rect are unchanged")
+      {
+        CHECK(sameSpaces(packer.GetSpaces(), spaces));
+        CHECK(packer.GetPageCount() == page_count);
+        CHECK(query[0].GetPage() == -1);
+      }
+    }
+
+    WHEN("Rect with more area than the leftover Space are queried")
+    {
+      const std::vector<mpbp::Rect> query = {mpbp::Rect(2, 32, 16), mpbp::Rect(3, 32, 16),
+                                             mpbp::Rect(4, 64, 64), mpbp::Rect(5, 64, 64)};
+
+      THEN("They do not fit")
+      {
+        const auto fit = packer.QueryFit(query);
+        CHECK_FALSE(fit.GetFits());
+        CHECK(fit.GetNewPageCount() == -1);
+      }
+      THEN("The new pages they need are counted")
+      {
+        const auto fit = packer.QueryFit(query, true);
+        CHECK_FALSE(fit.GetFits());
+        CHECK(fit.GetNewPageCount() == 2);
+        CHECK(packer.GetPageCount() == page_count);
+      }
+    }
+
+    WHEN("A Rect that is taller than every Space is queried")
+    {
+      const std::vector<mpbp::Rect> query = {mpbp::Rect(2, 8, 17)};
+
+      THEN("It does not fit") { CHECK_FALSE(packer.QueryFit(query).GetFits()); }
+    }
+
+    WHEN("Several threads query at once")
+    {
+      const std::vector<mpbp::Rect> query = {mpbp::Rect(2, 16, 16), mpbp::Rect(3, 16, 16)};
+      std::vector<int> fits(8, 0);
+      {
+        mpbp::ThreadPool thread_pool(4);
+        for (std::size_t query_i = 0; query_i < fits.size(); query_i++)
+        {
+          thread_pool.Submit([&, query_i]() { fits[query_i] = packer.QueryFit(query).GetFits(); });
+        }
+        thread_pool.Wait();
+      }
+
+      THEN("Every query gets the same answer")
+      {
+        CHECK(std::all_of(fits.begin(), fits.end(), [](int fit) { return fit == 1; }));
+      }
+    }
+  }
+}
+
+SCENARIO("Packer keeps gutters between Rect and aligns them")
+{
+  GIVEN("A Packer with max dimensions (256, 256), a padding of 2 and an alignment of 4")
+  {
+    mpbp::Packer packer(256, 256);
+    packer.SetPadding(2);
+    packer.SetAlignment(4, 4);
+
+    GIVEN("Rect of many sizes, a run of identically sized Rect and a Rect as wide as a page")
+    {
+      std::vector<mpbp::Rect> rects = {mpbp::Rect(0, 256, 10)};
+      for (unsigned long int rect_i = 1; rect_i < 300; rect_i++)
+      {
+        rects.emplace_back(rect_i, 1 + (rect_i * 7) % 37, 1 + (rect_i * 13) % 29);
+      }
+      for (unsigned long int rect_i = 300; rect_i < 340; rect_i++)
+      {
+        rects.emplace_back(rect_i, 6, 6);
+      }
+
+      WHEN("The vector of Rect is packed")
+      {
+        packer.Pack(rects);
+
+        THEN("All rects are placed") { CHECK(noUnplacedRect(rects)); }
+        THEN("All rects are within their pages") { CHECK(allRectsInPages(rects, packer)); }
+        THEN("No spaces are invalid") { CHECK(noInvalidSpace(packer.GetSpaces())); }
+        THEN("There is a gutter of twice the padding between all Rect")
+        {
+          CHECK(allGuttersClear(rects, 4));
+        }
+        THEN("All Rect are placed at aligned coordinates")
+        {
+          CHECK(std::all_of(rects.begin(), rects.end(), [](const mpbp::Rect& rect)
+                            { return rect.GetLeftX() % 4 == 0 && rect.GetTopY() % 4 == 0; }));
+        }
+        THEN("The padding and alignment can not change")
+        {
+          CHECK_THROWS(packer.SetPadding(1));
+          CHECK_THROWS(packer.SetAlignment(8, 8));
+        }
+      }
+
+      WHEN("The vector of Rect is cut in half and packed online")
+      {
+        auto half_way = rects.size() / 2;
+        std::span<mpbp::Rect> spana(&rects.front(), half_way);
+        std::span<mpbp::Rect> spanb(&rects.front() + half_way, rects.size() - half_way);
+        packer.Pack(spana);
+        packer.Pack(spanb);
+
+        THEN("All rects are placed") { CHECK(noUnplacedRect(rects)); }
+        THEN("All rects are within their pages") { CHECK(allRectsInPages(rects, packer)); }
+        THEN("There is a gutter of twice the padding between all Rect")
+        {
+          CHECK(allGuttersClear(rects, 4));
+        }
+      }
+    }
+
+    GIVEN("Two Rect that fit on one page")
+    {
+      std::vector<mpbp::Rect> rects = {mpbp::Rect(0, 10, 10), mpbp::Rect(1, 9, 9)};
+
+      WHEN("The vector of Rect is packed")
+      {
+        packer.Pack(rects);
+
+        THEN("The page size is aligned and does not include the outer padding")
+        {
+          CHECK(packer.GetPageCount() == 1);
+          CHECK(packer.GetWidth() % 4 == 0);
+          CHECK(packer.GetHeight() % 4 == 0);
+          CHECK(packer.GetWidth() == 12);
+          CHECK(packer.GetHeight() == 28);
+        }
+      }
+    }
+  }
+
+  GIVEN("A Packer")
+  {
+    mpbp::Packer packer(64, 64);
+
+    THEN("Invalid padding and alignment are rejected")
+    {
+      CHECK_THROWS(packer.SetPadding(-1));
+      CHECK_THROWS(packer.SetAlignment(0, 4));
+    }
+  }
+}
+
+SCENARIO("Packer removes Rect and drops its top pages")
+{
+  GIVEN("A Packer with max dimensions (128, 128) that has packed 400 Rect onto several pages")
+  {
+    mpbp::Packer packer(128, 128);
+    std::vector<mpbp::Rect> rects;
+    for (unsigned long int rect_i = 0; rect_i < 400; rect_i++)
+    {
+      rects.emplace_back(rect_i, 4 + static_cast<int>(rect_i * 7 % 19),
+                         4 + static_cast<int>(rect_i * 5 % 17));
+    }
+    packer.Pack(rects);
+    const auto page_count = packer.GetPageCount();
+
+    WHEN("Every other Rect is removed and the top pages are dropped")
+    {
+      std::vector<mpbp::Rect> live_rects;
+      for (std::size_t rect_i = 0; rect_i < rects.size(); rect_i++)
+      {
+        if (rect_i % 2 == 0)
+        {
+          packer.Remove(rects[rect_i]);
+        }
+        else
+        {
+          live_rects.push_back(rects[rect_i]);
+        }
+      }
+      const auto old_rects = live_rects;
+      const auto moves = packer.DropTopPages(live_rects);
+
+      THEN("Fewer pages are used")
+      {
+        CHECK(packer.GetPageCount() < page_count);
+      }
+      THEN("No Rect intersect") { CHECK(noRectIntersect(live_rects)); }
+      THEN("All rects are within their pages") { CHECK(allRectsInPages(live_rects, packer)); }
+      THEN("Each move matches the old and new placement of its Rect")
+      {
+        std::size_t moved_count = 0;
+        for (std::size_t rect_i = 0; rect_i < live_rects.size(); rect_i++)
+        {
+          const auto& old_rect = old_rects[rect_i];
+          const auto& rect = live_rects[rect_i];
+          if (old_rect.GetLeftX() == rect.GetLeftX() && old_rect.GetTopY() == rect.GetTopY() &&
+              old_rect.GetPage() == rect.GetPage())
+          {
+            continue;
+          }
+          moved_count++;
+          const auto move_it = std::find_if(moves.begin(), moves.end(),
+                                            [&](const mpbp::Move& move)
+                                            { return move.GetIdentifier() == rect.GetIdentifier(); });
+          REQUIRE(move_it != moves.end());
+          CHECK(move_it->GetFromLeftX() == old_rect.GetLeftX());
+          CHECK(move_it->GetFromTopY() == old_rect.GetTopY());
+          CHECK(move_it->GetFromPage() == old_rect.GetPage());
+          CHECK(move_it->GetToLeftX() == rect.GetLeftX());
+          CHECK(move_it->GetToTopY() == rect.GetTopY());
+          CHECK(move_it->GetToPage() == rect.GetPage());
+        }
+        CHECK(moved_count == moves.size());
+      }
+      THEN("Only Rect of dropped pages were moved")
+      {
+        CHECK(std::all_of(moves.begin(), moves.end(), [&](const mpbp::Move& move)
+                          { return move.GetFromPage() >= packer.GetPageCount(); }));
+      }
+    }
+
+    WHEN("Every other Rect is removed and the top pages are dropped with a move budget of 0")
+    {
+      std::vector<mpbp::Rect> live_rects;
+      for (std::size_t rect_i = 0; rect_i < rects.size(); rect_i++)
+      {
+        if (rect_i % 2 == 0)
+        {
+          packer.Remove(rects[rect_i]);
+        }
+        else
+        {
+          live_rects.push_back(rects[rect_i]);
+        }
+      }
+      const auto moves = packer.DropTopPages(live_rects, 0);
+
+      THEN("Nothing is moved")
+      {
+        CHECK(moves.empty());
+        CHECK(packer.GetPageCount() == page_count);
+      }
+    }
+
+    WHEN("Rect are packed into the area of removed Rect")
+    {
+      packer.Remove(rects[0]);
+      packer.Remove(rects[1]);
+      std::vector<mpbp::Rect> new_rects = {mpbp::Rect(400, rects[0].GetWidth(), rects[0].GetHeight()),
+                                           mpbp::Rect(401, rects[1].GetWidth(), rects[1].GetHeight())};
+      rects.erase(rects.begin(), rects.begin() + 2);
+      packer.Pack(new_rects);
+      rects.insert(rects.end(), new_rects.begin(), new_rects.end());
+
+      THEN("No new pages are needed") { CHECK(packer.GetPageCount() == page_count); }
+      THEN("No Rect intersect") { CHECK(noRectIntersect(rects)); }
+    }
+
+    WHEN("Every other Rect is removed and one Rect of the top page is left out of the span")
+    {
+      std::vector<mpbp::Rect> live_rects;
+      for (std::size_t rect_i = 0; rect_i < rects.size(); rect_i++)
+      {
+        if (rect_i % 2 == 0)
+        {
+          packer.Remove(rects[rect_i]);
+        }
+        else
+        {
+          live_rects.push_back(rects[rect_i]);
+        }
+      }
+      live_rects.erase(std::find_if(live_rects.begin(), live_rects.end(),
+                                    [&](const mpbp::Rect& rect)
+                                    { return rect.GetPage() == page_count - 1; }));
+      const auto old_rects = live_rects;
+
+      THEN("Dropping the top pages throws an exception before anything is moved")
+      {
+        CHECK_THROWS(packer.DropTopPages(live_rects));
+        CHECK(packer.GetPageCount() == page_count);
+        CHECK(std::equal(live_rects.begin(), live_rects.end(), old_rects.begin(),
+                         [](const mpbp::Rect& a, const mpbp::Rect& b)
+                         { return a.GetLeftX() == b.GetLeftX() && a.GetTopY() == b.GetTopY() &&
+                                  a.GetPage() == b.GetPage(); }));
+      }
+    }
+
+    WHEN("A Rect is removed")
+    {
+      packer.Remove(rects[0]);
+
+      THEN("Removing it again throws an exception")
+      {
+        CHECK_THROWS(packer.Remove(rects[0]));
+      }
+      THEN("Dropping the top pages with it still in the span throws an exception")
+      {
+        CHECK_THROWS(packer.DropTopPages(rects));
+      }
+    }
+
+    THEN("Dropping the top pages while a checkpoint is active throws an exception")
+    {
+      packer.Checkpoint();
+      CHECK_THROWS(packer.DropTopPages(rects));
+    }
+  }
+
+  GIVEN("A Packer that has packed two Rect with the same content hash at one position")
+  {
+    mpbp::Packer packer(128, 128);
+    std::vector<mpbp::Rect> rects = {mpbp::Rect(0, 16, 16), mpbp::Rect(1, 16, 16)};
+    const std::vector<std::uint64_t> content_hashes = {7, 7};
+    packer.Pack(rects, content_hashes);
+
+    THEN("Only one of them can be removed")
+    {
+      packer.Remove(rects[0]);
+      CHECK_THROWS(packer.Remove(rects[1]));
+    }
+  }
+}
@@ -0,0 +1,63 @@
+// SPDX-FileCopyrightText: 2022 Daniel Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+#include <catch2/catch_all.hpp>
+#include <mpbp/PageSize.hpp>
+
+SCENARIO("Properties are retrieved from a PageSize")
+{
+  GIVEN("A PageSize with a width of 512 and a height of 256")
+  {
+    mpbp::PageSize page_size(512, 256);
+
+    THEN("The getters return the correct values")
+    {
+      REQUIRE(!page_size.GetIsDegenerate());
+      CHECK(page_size.GetWidth() == 512);
+      CHECK(page_size.GetHeight() == 256);
+      CHECK(page_size.GetArea() == 131072);
+      CHECK(page_size.GetCountLimit() == -1);
+    }
+  }
+
+  GIVEN("A PageSize with a width of 4096, a height of 4096 and a count limit of 2")
+  {
+    mpbp::PageSize page_size(4096, 4096, 2);
+
+    THEN("The area does not overflow") { CHECK(page_size.GetArea() == 16777216); }
+
+    THEN("The count limit is 2") { CHECK(page_size.GetCountLimit() == 2); }
+  }
+}
+
+SCENARIO("PageSize degeneracy is determined")
+{
+  GIVEN("A PageSize with a width of 0 and a height of 1")
+  {
+    mpbp::PageSize page_size(0, 1);
+
+    THEN("The PageSize is degenerate") { REQUIRE(page_size.GetIsDegenerate()); }
+  }
+
+  GIVEN("A PageSize with a width of 1 and a height of -1")
+  {
+    mpbp::PageSize page_size(1, -1);
+
+    THEN("The PageSize is degenerate") { REQUIRE(page_size.GetIsDegenerate()); }
+  }
+}
+
+SCENARIO("PageSize is checked to see if it fits an area")
+{
+  GIVEN("A PageSize with a width of 5 and a height of 10")
+  {
+    mpbp::PageSize page_size(5, 10);
+
+    THEN("An area of (5, 10) fits") { CHECK(page_size.Fits(5, 10)); }
+
+    THEN("An area of (6, 10) does not fit") { CHECK(!page_size.Fits(6, 10)); }
+
+    THEN("An area of (5, 11) does not fit") { CHECK(!page_size.Fits(5, 11)); }
+  }
+}
@@ -0,0 +1,125 @@
+// SPDX-FileCopyrightText: 2022 Daniel Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+#include <catch2/catch_all.hpp>
+#include <mpbp/PageStream.hpp>
+#include <mpbp/Packer.hpp>
+#include <mpbp/Rect.hpp>
+#include <mpbp/Validation.hpp>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+#include "test_rects.hpp"
+
+SCENARIO("Packer reports pages as soon as their placements are final")
+{
+  GIVEN("A Packer with max dimensions (128, 128) and Rect that fill pages before smaller Rect")
+  {
+    mpbp::Packer packer(128, 128);
+    std::vector<mpbp::Rect> rects;
+    for (int rect_i = 0; rect_i < 40; rect_i++) rects.emplace_back(rect_i, 64, 64);
+    for (int rect_i = 40; rect_i < 50; rect_i++) rects.emplace_back(rect_i, 30, 30);
+
+    WHEN("The Rect are packed with a page callback")
+    {
+      std::vector<int> reported_pages;
+      std::vector<std::size_t> placed_counts;
+      packer.Pack(rects, 0,
+                  [&](int page, std::span<const mpbp::Rect> placed_rects)
+                  {
+                    reported_pages.push_back(page);
+                    placed_counts.push_back(placed_rects.size());
+                  });
+
+      THEN("The full pages are reported before the smaller Rect are placed")
+      {
+        REQUIRE(reported_pages.size() == static_cast<std::size_t>(packer.GetPageCount()));
+        REQUIRE(reported_pages.front() == 0);
+        REQUIRE(placed_counts.front() == 40);
+        REQUIRE(placed_counts.back() == rects.size());
+      }
+    }
+  }
+}
+
+SCENARIO("PageStream hands out the pages of a pack on another thread")
+{
+  GIVEN("A Packer with max dimensions (128, 128) and 2000 Rect")
+  {
+    mpbp::Packer packer(128, 128);
+    auto rects = mpbp_test::makeRects(2000);
+
+    WHEN("The Rect are packed with a PageStream")
+    {
+      std::vector<mpbp::PackedPage> pages;
+      {
+        mpbp::PageStream stream(packer, rects);
+        mpbp::PackedPage page;
+        while (stream.Next(page)) pages.push_back(page);
+      }
+
+      THEN("Every page is handed out once with the Rect placed on it")
+      {
+        REQUIRE(pages.size() == static_cast<std::size_t>(packer.GetPageCount()));
+        std::vector<bool> seen_pages(packer.GetPageCount(), false);
+        std::size_t rect_count = 0;
+        for (const auto& page : pages)
+        {
+          REQUIRE_FALSE(seen_pages[page.GetPage()]);
+          seen_pages[page.GetPage()] = true;
+          REQUIRE(page.GetWidth() == packer.GetPageWidth(page.GetPage()));
+          REQUIRE(page.GetHeight() == packer.GetPageHeight(page.GetPage()));
+          for (const auto& rect : page.GetRects()) REQUIRE(rect.GetPage() == page.GetPage());
+          rect_count += page.GetRects().size();
+        }
+        REQUIRE(rect_count == rects.size());
+      }
+      THEN("The Rect are placed as by a pack without a PageStream")
+      {
+        mpbp::Packer plain_packer(128, 128);
+        auto plain_rects = mpbp_test::makeRects(2000);
+        plain_packer.Pack(plain_rects);
+        REQUIRE(plain_packer.GetPageCount() == packer.GetPageCount());
+        for (std::size_t rect_i = 0; rect_i < rects.size(); rect_i++)
+        {
+          REQUIRE(rects[rect_i].GetIdentifier() == plain_rects[rect_i].GetIdentifier());
+          REQUIRE(rects[rect_i].GetLeftX() == plain_rects[rect_i].GetLeftX());
+          REQUIRE(rects[rect_i].GetTopY() == plain_rects[rect_i].GetTopY());
+          REQUIRE(rects[rect_i].GetPage() == plain_rects[rect_i].GetPage());
+        }
+      }
+    }
+    WHEN("The Rect are packed with a PageStream that keeps one page open")
+    {
+      std::vector<mpbp::PackedPage> pages;
+      {
+        mpbp::PageStream stream(packer, rects, 1);
+        mpbp::PackedPage page;
+        while (stream.Next(page)) pages.push_back(page);
+      }
+
+      THEN("The pages are handed out in order and the placements are valid")
+      {
+        REQUIRE(pages.size() == static_cast<std::size_t>(packer.GetPageCount()));
+        for (std::size_t page_i = 0; page_i < pages.size(); page_i++)
+        {
+          REQUIRE(pages[page_i].GetPage() == static_cast<int>(page_i));
+        }
+        REQUIRE(mpbp::Validate(rects, packer).GetIsValid());
+      }
+    }
+    WHEN("A degenerate Rect is packed with a PageStream")
+    {
+      rects.emplace_back(2000, 0, 5);
+      mpbp::PageStream stream(packer, rects);
+      mpbp::PackedPage page;
+
+      THEN("The exception of the pack is thrown by PageStream::Next()")
+      {
+        REQUIRE_THROWS_AS(stream.Next(page), std::runtime_error);
+      }
+    }
+  }
+}
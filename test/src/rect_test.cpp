@@ -83,6 +83,23 @@ SCENARIO("The position of a Rect is determined")
   }
 }
 
+SCENARIO("The group of a Rect is determined")
+{
+  GIVEN("A Rect constructed without a group")
+  {
+    mpbp::Rect rect(0, 5, 5);
+
+    THEN("The group is -1") { CHECK(rect.GetGroup() == -1); }
+  }
+
+  GIVEN("A Rect constructed with a group of 3")
+  {
+    mpbp::Rect rect(0, 5, 5, 3);
+
+    THEN("The group is 3") { CHECK(rect.GetGroup() == 3); }
+  }
+}
+
 SCENARIO("Rect max dimension is determined")
 {
   GIVEN("A Rect with a width of 5 and a height of 5")
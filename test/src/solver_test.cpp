@@ -0,0 +1,145 @@
+// SPDX-FileCopyrightText: 2022 Daniel Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+#include <catch2/catch_all.hpp>
+#include <chrono>
+#include <mpbp/Rect.hpp>
+#include <mpbp/Solver.hpp>
+#include <mpbp/ThreadPool.hpp>
+#include <cstddef>
+#include <vector>
+
+namespace
+{
+  bool allRectsPlacedWithoutOverlap(const std::vector<mpbp::Rect>& rects, int max_width,
+                                    int max_height)
+  {
+    for (std::size_t a_i = 0; a_i < rects.size(); a_i++)
+    {
+      const auto& a = rects[a_i];
+      if (a.GetPage() < 0 || a.GetLeftX() < 0 || a.GetTopY() < 0 ||
+          a.GetLeftX() + a.GetWidth() > max_width || a.GetTopY() + a.GetHeight() > max_height)
+      {
+        return false;
+      }
+      for (std::size_t b_i = a_i + 1; b_i < rects.size(); b_i++)
+      {
+        const auto& b = rects[b_i];
+        if (a.GetPage() == b.GetPage() && a.GetLeftX() < b.GetLeftX() + b.GetWidth() &&
+            b.GetLeftX() < a.GetLeftX() + a.GetWidth() && a.GetTopY() < b.GetTopY() + b.GetHeight() &&
+            b.GetTopY() < a.GetTopY() + a.GetHeight())
+        {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+}  // namespace
+
+SCENARIO("Solver finds the smallest amount of pages")
+{
+  GIVEN("A Solver with pages of size (12, 12)")
+  {
+    mpbp::Solver solver(12, 12);
+
+    GIVEN("Rect that the greedy Packer needs 3 pages for but that fit in 2 pages")
+    {
+      std::vector<mpbp::Rect> rects = {mpbp::Rect(0, 5, 7), mpbp::Rect(1, 9, 8),
+                                       mpbp::Rect(2, 4, 6), mpbp::Rect(3, 7, 3),
+                                       mpbp::Rect(4, 5, 2), mpbp::Rect(5, 5, 4)};
+
+      WHEN("The Rect are solved")
+      {
+        mpbp::ThreadPool thread_pool(4);
+        solver.Solve(rects, thread_pool);
+
+        THEN("The greedy pack used 3 pages") { CHECK(solver.GetHeuristicPageCount() == 3); }
+        THEN("The Rect are packed into 2 pages, which is optimal")
+        {
+          CHECK(solver.GetPageCount() == 2);
+          CHECK(solver.GetLowerBound() == 2);
+          CHECK(solver.GetIsOptimal());
+        }
+        THEN("All Rect are placed within a page without overlapping")
+        {
+          CHECK(allRectsPlacedWithoutOverlap(rects, 12, 12));
+        }
+        THEN("The order of the Rect is not changed")
+        {
+          for (std::size_t rect_i = 0; rect_i < rects.size(); rect_i++)
+          {
+            CHECK(rects[rect_i].GetIdentifier() == rect_i);
+          }
+        }
+      }
+    }
+
+    GIVEN("Rect that need a page more than their lower bound")
+    {
+      std::vector<mpbp::Rect> rects = {mpbp::Rect(0, 8, 5), mpbp::Rect(1, 8, 5),
+                                       mpbp::Rect(2, 8, 5)};
+
+      WHEN("The Rect are solved")
+      {
+        solver.Solve(rects);
+
+        THEN("The search proves that the packing is optimal")
+        {
+          CHECK(solver.GetLowerBound() == 1);
+          CHECK(solver.GetPageCount() == 2);
+          CHECK(solver.GetIsOptimal());
+          CHECK(allRectsPlacedWithoutOverlap(rects, 12, 12));
+        }
+      }
+    }
+
+    GIVEN("A node limit of 1 and many Rect")
+    {
+      solver.SetNodeLimit(1);
+      std::vector<mpbp::Rect> rects;
+      for (unsigned long int rect_i = 0; rect_i < 60; rect_i++)
+      {
+        rects.emplace_back(rect_i, 2 + static_cast<int>(rect_i * 7 % 9),
+                           2 + static_cast<int>(rect_i * 5 % 8));
+      }
+
+      WHEN("The Rect are solved")
+      {
+        solver.Solve(rects);
+
+        THEN("The result is never worse than the greedy pack")
+        {
+          CHECK(solver.GetPageCount() <= solver.GetHeuristicPageCount());
+          CHECK(solver.GetPageCount() >= solver.GetLowerBound());
+          CHECK(allRectsPlacedWithoutOverlap(rects, 12, 12));
+        }
+      }
+    }
+
+    WHEN("The limits are set")
+    {
+      solver.SetNodeLimit(500);
+      solver.SetTimeLimit(std::chrono::milliseconds(20));
+
+      THEN("They are returned by the getters")
+      {
+        CHECK(solver.GetNodeLimit() == 500);
+        CHECK(solver.GetTimeLimit() == std::chrono::milliseconds(20));
+      }
+      THEN("Negative limits throw exceptions")
+      {
+        CHECK_THROWS(solver.SetNodeLimit(-1));
+        CHECK_THROWS(solver.SetTimeLimit(std::chrono::milliseconds(-1)));
+      }
+    }
+
+    GIVEN("A Rect that is larger than a page")
+    {
+      std::vector<mpbp::Rect> rects = {mpbp::Rect(0, 13, 2)};
+
+      THEN("Solving throws an exception") { CHECK_THROWS(solver.Solve(rects)); }
+    }
+  }
+}
@@ -0,0 +1,110 @@
+// SPDX-FileCopyrightText: 2022 Daniel Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+#include <algorithm>
+#include <catch2/catch_all.hpp>
+#include <mpbp/Rect.hpp>
+#include <mpbp/StreamPacker.hpp>
+#include <cstddef>
+#include <sstream>
+#include <vector>
+
+SCENARIO("StreamPacker packs a stream of Rect in chunks")
+{
+  GIVEN("A StreamPacker with max dimensions (128, 128), chunks of 100 Rect and 2 open pages")
+  {
+    mpbp::StreamPacker stream_packer(128, 128);
+    stream_packer.SetChunkSize(100);
+    stream_packer.SetOpenPageLimit(2);
+
+    GIVEN("A stream of 2000 Rect sorted by max dimension from largest to smallest")
+    {
+      std::vector<mpbp::Rect> rects;
+      for (unsigned long int rect_i = 0; rect_i < 2000; rect_i++)
+      {
+        rects.emplace_back(rect_i, 2 + static_cast<int>(rect_i * 7 % 23),
+                           2 + static_cast<int>(rect_i * 5 % 19));
+      }
+      std::sort(rects.begin(), rects.end(), std::greater());
+      std::stringstream input;
+      for (const auto& rect : rects)
+      {
+        mpbp::StreamPacker::WriteInputRect(input, rect);
+      }
+
+      WHEN("The stream is packed")
+      {
+        std::stringstream output;
+        stream_packer.Pack(input, output);
+        std::vector<mpbp::Rect> placed_rects;
+        mpbp::Rect placed_rect;
+        while (mpbp::StreamPacker::ReadPlacedRect(output, placed_rect))
+        {
+          placed_rects.push_back(placed_rect);
+        }
+
+        THEN("Every Rect is placed once within a page")
+        {
+          REQUIRE(placed_rects.size() == rects.size());
+          CHECK(stream_packer.GetRectCount() == rects.size());
+          std::vector<bool> seen(rects.size(), false);
+          for (const auto& rect : placed_rects)
+          {
+            CHECK_FALSE(seen[rect.GetIdentifier()]);
+            seen[rect.GetIdentifier()] = true;
+            CHECK(rect.GetPage() >= 0);
+            CHECK(rect.GetPage() < stream_packer.GetPacker().GetPageCount());
+            CHECK(rect.GetLeftX() + rect.GetWidth() <= 128);
+            CHECK(rect.GetTopY() + rect.GetHeight() <= 128);
+          }
+        }
+        THEN("No Rect intersect")
+        {
+          auto intersects = false;
+          for (std::size_t a_i = 0; a_i < placed_rects.size(); a_i++)
+          {
+            const auto& a = placed_rects[a_i];
+            for (std::size_t b_i = a_i + 1; b_i < placed_rects.size(); b_i++)
+            {
+              const auto& b = placed_rects[b_i];
+              intersects = intersects ||
+                           (a.GetPage() == b.GetPage() && a.GetLeftX() <= b.GetRightX() &&
+                            b.GetLeftX() <= a.GetRightX() && a.GetTopY() <= b.GetBottomY() &&
+                            b.GetTopY() <= a.GetBottomY());
+            }
+          }
+          CHECK_FALSE(intersects);
+        }
+        THEN("Only the open pages have Space")
+        {
+          CHECK(stream_packer.GetOpenPageCount() <= 2);
+          CHECK(stream_packer.GetPacker().GetPageCount() > 2);
+          for (const auto& space : stream_packer.GetPacker().GetSpaces())
+          {
+            CHECK_FALSE(stream_packer.GetPacker().GetIsPageClosed(space.GetPage()));
+          }
+        }
+      }
+    }
+
+    GIVEN("A stream that ends within a record")
+    {
+      std::stringstream input;
+      mpbp::StreamPacker::WriteInputRect(input, mpbp::Rect(0, 8, 8));
+      input.write("\0\0\0", 3);
+
+      THEN("Packing it throws an exception")
+      {
+        std::stringstream output;
+        CHECK_THROWS(stream_packer.Pack(input, output));
+      }
+    }
+
+    THEN("Invalid chunk sizes and open page limits throw exceptions")
+    {
+      CHECK_THROWS(stream_packer.SetChunkSize(0));
+      CHECK_THROWS(stream_packer.SetOpenPageLimit(0));
+    }
+  }
+}
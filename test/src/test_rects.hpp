@@ -0,0 +1,28 @@
+// SPDX-FileCopyrightText: 2022 Daniel Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef MPBP_TEST_RECTS_HPP
+#define MPBP_TEST_RECTS_HPP
+
+#include <mpbp/Rect.hpp>
+#include <vector>
+
+namespace mpbp_test
+{
+  // Make Rect of many different sizes from 2 to 30 wide and 2 to 24 tall. The same arguments always
+  // give the same Rect, and a different seed shifts every size.
+  inline std::vector<mpbp::Rect> makeRects(int count, int seed = 0,
+                                           unsigned long int first_identifier = 0)
+  {
+    std::vector<mpbp::Rect> rects;
+    for (int rect_i = 0; rect_i < count; rect_i++)
+    {
+      rects.emplace_back(first_identifier + rect_i, 2 + (rect_i * 7 + seed) % 29,
+                         2 + (rect_i * 11 + seed) % 23);
+    }
+    return rects;
+  }
+}  // namespace mpbp_test
+
+#endif
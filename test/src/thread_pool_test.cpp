@@ -0,0 +1,110 @@
+// SPDX-FileCopyrightText: 2022 Daniel Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+#include <atomic>
+#include <catch2/catch_all.hpp>
+#include <mpbp/ThreadPool.hpp>
+#include <stdexcept>
+
+SCENARIO("A ThreadPool runs tasks")
+{
+  GIVEN("A ThreadPool with 4 threads")
+  {
+    mpbp::ThreadPool thread_pool(4);
+
+    THEN("The pool has 4 threads") { CHECK(thread_pool.GetThreadCount() == 4); }
+
+    WHEN("1000 tasks are submitted and waited for")
+    {
+      std::atomic<int> count = 0;
+      for (int task_i = 0; task_i < 1000; task_i++)
+      {
+        thread_pool.Submit([&]() { count++; });
+      }
+      thread_pool.Wait();
+
+      THEN("Every task has run") { CHECK(count == 1000); }
+    }
+
+    WHEN("Tasks submit more tasks")
+    {
+      std::atomic<int> count = 0;
+      for (int task_i = 0; task_i < 10; task_i++)
+      {
+        thread_pool.Submit(
+            [&]()
+            {
+              for (int sub_task_i = 0; sub_task_i < 10; sub_task_i++)
+              {
+                thread_pool.Submit([&]() { count++; });
+              }
+            });
+      }
+      thread_pool.Wait();
+
+      THEN("Every nested task has run") { CHECK(count == 100); }
+    }
+
+    WHEN("A task throws an exception")
+    {
+      thread_pool.Submit([]() { throw std::runtime_error("task failed"); });
+
+      THEN("Waiting rethrows the exception") { CHECK_THROWS(thread_pool.Wait()); }
+    }
+  }
+}
+
+SCENARIO("A TaskGroup waits only for its own tasks")
+{
+  GIVEN("A ThreadPool with 2 threads")
+  {
+    mpbp::ThreadPool thread_pool(2);
+
+    WHEN("Every task of the pool waits for a TaskGroup of its own on the same pool")
+    {
+      std::atomic<int> count = 0;
+      mpbp::TaskGroup outer_group(thread_pool);
+      for (int task_i = 0; task_i < 4; task_i++)
+      {
+        outer_group.Submit(
+            [&]()
+            {
+              mpbp::TaskGroup inner_group(thread_pool);
+              for (int sub_task_i = 0; sub_task_i < 10; sub_task_i++)
+              {
+                inner_group.Submit([&]() { count++; });
+              }
+              inner_group.Wait();
+            });
+      }
+      outer_group.Wait();
+
+      THEN("Every task has run without a deadlock") { CHECK(count == 40); }
+    }
+
+    WHEN("A task of another group throws an exception")
+    {
+      mpbp::TaskGroup failing_group(thread_pool);
+      mpbp::TaskGroup other_group(thread_pool);
+      failing_group.Submit([]() { throw std::runtime_error("task failed"); });
+      std::atomic<int> count = 0;
+      other_group.Submit([&]() { count++; });
+
+      THEN("Only the group of the task rethrows it")
+      {
+        CHECK_NOTHROW(other_group.Wait());
+        CHECK(count == 1);
+        CHECK_THROWS(failing_group.Wait());
+      }
+    }
+
+    WHEN("The pool is waited for from one of its tasks")
+    {
+      mpbp::TaskGroup task_group(thread_pool);
+      task_group.Submit([&]() { thread_pool.Wait(); });
+
+      THEN("An exception is thrown") { CHECK_THROWS(task_group.Wait()); }
+    }
+  }
+}
@@ -0,0 +1,157 @@
+// SPDX-FileCopyrightText: 2022 Daniel Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+#include <algorithm>
+#include <catch2/catch_all.hpp>
+#include <mpbp/Packer.hpp>
+#include <mpbp/Rect.hpp>
+#include <mpbp/ThreadPool.hpp>
+#include <mpbp/Validation.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+SCENARIO("Validate checks the placements of packed Rect")
+{
+  GIVEN("A Packer with max dimensions (64, 64) that has packed 500 Rect")
+  {
+    mpbp::Packer packer(64, 64);
+    std::vector<mpbp::Rect> rects;
+    for (unsigned long int rect_i = 0; rect_i < 500; rect_i++)
+    {
+      rects.emplace_back(rect_i, 1 + static_cast<int>(rect_i * 7 % 13),
+                         1 + static_cast<int>(rect_i * 3 % 11));
+    }
+    packer.Pack(rects);
+    mpbp::ThreadPool thread_pool(4);
+
+    WHEN("The Rect are validated")
+    {
+      const auto validation = mpbp::Validate(rects, packer, thread_pool);
+
+      THEN("The placements are valid")
+      {
+        CHECK(validation.GetIsValid());
+        CHECK(validation.GetUnplacedCount() == 0);
+        CHECK(validation.GetOutOfBoundsCount() == 0);
+        CHECK(validation.GetOverlapCount() == 0);
+        CHECK(validation.GetSharedCount() == 0);
+        CHECK(validation.GetInvalidIndices().empty());
+      }
+    }
+
+    WHEN("One Rect is moved onto another, one is unplaced and one is moved out of its page")
+    {
+      const auto& target = rects[10];
+      rects[20].Place(target.GetLeftX(), target.GetTopY(), target.GetPage());
+      rects[30] = mpbp::Rect(30, 4, 4);
+      rects[40].Place(64 - rects[40].GetWidth() + 1, 0, rects[40].GetPage());
+      const auto validation = mpbp::Validate(rects, packer);
+
+      THEN("Each problem is reported")
+      {
+        CHECK_FALSE(validation.GetIsValid());
+        CHECK(validation.GetUnplacedCount() == 1);
+        CHECK(validation.GetOutOfBoundsCount() == 1);
+        CHECK(validation.GetOverlapCount() >= 1);
+        CHECK(std::find(validation.GetInvalidIndices().begin(),
+                        validation.GetInvalidIndices().end(),
+                        30) != validation.GetInvalidIndices().end());
+        CHECK(std::find(validation.GetInvalidIndices().begin(),
+                        validation.GetInvalidIndices().end(),
+                        40) != validation.GetInvalidIndices().end());
+      }
+    }
+
+    WHEN("Two Rect only touch at their sides")
+    {
+      std::vector<mpbp::Rect> touching = {mpbp::Rect(0, 4, 4), mpbp::Rect(1, 4, 4),
+                                          mpbp::Rect(2, 4, 4)};
+      touching[0].Place(0, 0, 0);
+      touching[1].Place(4, 0, 0);
+      touching[2].Place(0, 4, 0);
+
+      THEN("They do not overlap") { CHECK(mpbp::Validate(touching, packer).GetIsValid()); }
+    }
+
+    WHEN("A Rect overlaps only a Rect that already overlaps another")
+    {
+      std::vector<mpbp::Rect> chained = {mpbp::Rect(0, 10, 10), mpbp::Rect(1, 10, 10),
+                                         mpbp::Rect(2, 3, 3)};
+      chained[0].Place(0, 0, 0);
+      chained[1].Place(5, 0, 0);
+      chained[2].Place(12, 0, 0);
+      const auto validation = mpbp::Validate(chained, packer);
+
+      THEN("Both overlapping Rect are reported")
+      {
+        CHECK(validation.GetOverlapCount() == 2);
+        CHECK(validation.GetInvalidIndices() == std::vector<std::size_t>{1, 2});
+      }
+    }
+  }
+
+  GIVEN("Rect packed with content hashes so that duplicates share a placement")
+  {
+    mpbp::Packer packer(64, 64);
+    std::vector<mpbp::Rect> rects;
+    std::vector<std::uint64_t> hashes;
+    for (unsigned long int rect_i = 0; rect_i < 100; rect_i++)
+    {
+      rects.emplace_back(rect_i, 8, 8);
+      hashes.push_back(rect_i % 10);
+    }
+    packer.Pack(rects, hashes);
+
+    WHEN("The Rect are validated")
+    {
+      const auto validation = mpbp::Validate(rects, packer);
+
+      THEN("The shared placements are valid and counted")
+      {
+        CHECK(validation.GetIsValid());
+        CHECK(validation.GetSharedCount() == 90);
+      }
+    }
+  }
+
+  GIVEN("Rect placed at arbitrary positions")
+  {
+    mpbp::Packer packer(32, 32);
+    std::vector<mpbp::Rect> sizes = {mpbp::Rect(0, 32, 32), mpbp::Rect(1, 32, 32)};
+    packer.Pack(sizes);
+    std::vector<mpbp::Rect> rects;
+    for (unsigned long int rect_i = 0; rect_i < 60; rect_i++)
+    {
+      mpbp::Rect rect(rect_i, 1 + static_cast<int>(rect_i * 5 % 7),
+                      1 + static_cast<int>(rect_i * 3 % 5));
+      rect.Place(static_cast<int>(rect_i * 11 % 25), static_cast<int>(rect_i * 13 % 27),
+                 static_cast<int>(rect_i % 2));
+      rects.push_back(rect);
+    }
+
+    WHEN("The Rect are validated")
+    {
+      const auto validation = mpbp::Validate(rects, packer);
+
+      THEN("The sweep finds an overlap exactly when a pairwise check does")
+      {
+        auto overlaps = false;
+        for (std::size_t a_i = 0; a_i < rects.size(); a_i++)
+        {
+          for (std::size_t b_i = a_i + 1; b_i < rects.size(); b_i++)
+          {
+            const auto& a = rects[a_i];
+            const auto& b = rects[b_i];
+            overlaps = overlaps || (a.GetPage() == b.GetPage() && a.GetLeftX() <= b.GetRightX() &&
+                                    b.GetLeftX() <= a.GetRightX() && a.GetTopY() <= b.GetBottomY() &&
+                                    b.GetTopY() <= a.GetBottomY());
+          }
+        }
+        REQUIRE(overlaps);
+        CHECK(validation.GetOverlapCount() > 0);
+      }
+    }
+  }
+}
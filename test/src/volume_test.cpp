@@ -0,0 +1,57 @@
+// SPDX-FileCopyrightText: 2022 Daniel Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+#include <catch2/catch_all.hpp>
+#include <mpbp/Box.hpp>
+#include <mpbp/Volume.hpp>
+
+SCENARIO("Properties are retrieved from a Volume")
+{
+  GIVEN("A Volume at (1, 2, 3) on page 4 with a width of 5, a height of 6 and a depth of 7")
+  {
+    mpbp::Volume volume(1, 2, 3, 4, 5, 6, 7);
+
+    THEN("The getters return the correct values")
+    {
+      REQUIRE(!volume.GetIsDegenerate());
+      CHECK(volume.GetLeftX() == 1);
+      CHECK(volume.GetTopY() == 2);
+      CHECK(volume.GetFrontZ() == 3);
+      CHECK(volume.GetPage() == 4);
+      CHECK(volume.GetWidth() == 5);
+      CHECK(volume.GetHeight() == 6);
+      CHECK(volume.GetDepth() == 7);
+      CHECK(volume.GetMaxDimension() == 7);
+    }
+  }
+
+  GIVEN("A Volume with a depth of -1")
+  {
+    mpbp::Volume volume(0, 0, 0, 0, 1, 1, -1);
+
+    THEN("The Volume is degenerate") { REQUIRE(volume.GetIsDegenerate()); }
+  }
+}
+
+SCENARIO("Volume is checked to see if it fits a Box")
+{
+  GIVEN("A Volume with a width of 5, a height of 10 and a depth of 15")
+  {
+    mpbp::Volume volume(0, 0, 0, 0, 5, 10, 15);
+
+    THEN("A Box of the same size fits in the Volume") { CHECK(volume.Fits(mpbp::Box(0, 5, 10, 15))); }
+
+    THEN("A smaller Box fits in the Volume") { CHECK(volume.Fits(mpbp::Box(0, 1, 2, 3))); }
+
+    THEN("A Box that is too deep does not fit in the Volume")
+    {
+      CHECK(!volume.Fits(mpbp::Box(0, 5, 10, 16)));
+    }
+
+    THEN("A Box that is too wide does not fit in the Volume")
+    {
+      CHECK(!volume.Fits(mpbp::Box(0, 6, 1, 1)));
+    }
+  }
+}